@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace nfp {
+
+    // Deleter for objects built by make_in: destroys the object and hands its bytes back to the
+    // resource they came from, which is free inside a connection arena.
+    struct ArenaDelete {
+        std::pmr::memory_resource * resource = nullptr;
+        size_t bytes = 0;
+        size_t align = 0;
+
+        template<typename T> void operator()(T * p) const {
+            p->~T();
+            this->resource->deallocate(p, this->bytes, this->align);
+        }
+    };
+
+    template<typename T> using arena_ptr = std::unique_ptr<T, ArenaDelete>;
+
+    template<typename T, typename... Args>
+    arena_ptr<T> make_in(std::pmr::memory_resource * resource, Args&&... args) {
+        void * mem = resource->allocate(sizeof(T), alignof(T));
+
+        try {
+            return arena_ptr<T>(new (mem) T(std::forward<Args>(args)...), ArenaDelete{resource, sizeof(T), alignof(T)});
+        } catch (...) {
+            resource->deallocate(mem, sizeof(T), alignof(T));
+            throw;
+        }
+    }
+
+    // Serves allocations from the heap while adding up what a monotonic arena would need for them,
+    // worst-case alignment padding included.
+    class ArenaSizer : public std::pmr::memory_resource {
+    private:
+        size_t total = 0;
+
+        void * do_allocate(size_t bytes, size_t align) override {
+            this->total += bytes + align - 1;
+            return ::operator new(bytes, std::align_val_t{align});
+        }
+
+        void do_deallocate(void * p, size_t, size_t align) override {
+            ::operator delete(p, std::align_val_t{align});
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override { return this == &other; }
+
+    public:
+        size_t bytes() const { return this->total; }
+    };
+
+}
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <array>
+#include <cstddef>
 
 namespace nfp {
 
@@ -10,7 +11,7 @@ namespace nfp {
         std::array<float, 3> a;
         std::array<float, 3> b;
         std::array<float, 5> norm_coeffs;
-        std::vector<float> vs;
+        std::array<float, 2> vs;
         float Q;
 
     public:
@@ -25,7 +26,14 @@ namespace nfp {
         float eval(float);
         void processBlock(const std::vector<float> &, std::vector<float> &);
         void reset();
+        bool quiescent(float) const;
+        static constexpr size_t state_bytes() { return sizeof(vs); }
+        void save_state(std::vector<unsigned char> &) const;
+        const unsigned char * load_state(const unsigned char *);
         constexpr float get_Q() const {return this->Q;}
+        // a1, a2, b0, b1, b2 over a0 and the delay line, as the block kernels take them.
+        const float * normalized() const { return this->norm_coeffs.data(); }
+        float * delay_line() { return this->vs.data(); }
     };
 
 }
\ No newline at end of file
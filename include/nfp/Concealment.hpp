@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace nfp {
+
+    // Model-based packet-loss concealment over 128-sample blocks. Received blocks only extend a
+    // short history and its 4:1 decimated copy; the model is fitted once when a loss starts and then
+    // continued for the whole burst, so a concealed block costs a fit plus ORDER multiply-adds per
+    // sample at most.
+    //  - LPC: order-16 predictor from the Hann-windowed history's autocorrelation (Levinson-Durbin),
+    //    run forward.
+    //  - PITCH: the last pitch period repeated, the lag found on the decimated history and refined
+    //    at full rate; falls back to LPC when the history isn't periodic.
+    // Bursts longer than one block fade out, and the first block after a loss is crossfaded in
+    // from the model's continuation.
+    class Concealer {
+    public:
+        enum class MODEL {LPC, PITCH};
+
+        static constexpr size_t BLOCK = 128;
+        static constexpr size_t HISTORY = 512;
+        static constexpr size_t ORDER = 16;
+        static constexpr size_t OVERLAP = 32;
+        static constexpr size_t MIN_PERIOD = 20;
+        static constexpr size_t MAX_PERIOD = 256;
+        static constexpr size_t DECIMATION = 4;
+        static constexpr float MIN_VOICING = 0.6f;
+        static constexpr float FADE_PER_BLOCK = 0.25f;
+
+    private:
+        MODEL model;
+        // HISTORY samples, room for one synthesized block plus its overlap, ORDER coefficients, then
+        // the decimated history.
+        std::pmr::vector<float> buffer;
+        unsigned period = 0;
+        unsigned lost = 0;
+
+        float * history() { return this->buffer.data(); }
+        float * coeffs() { return this->buffer.data() + HISTORY + BLOCK + OVERLAP; }
+        float * decimated() { return this->coeffs() + ORDER; }
+
+        unsigned find_period();
+        void fit();
+        void synthesize(size_t n);
+        void push(const float *);
+        float gain(size_t n) const;
+
+    public:
+        explicit Concealer(MODEL, std::pmr::memory_resource * = std::pmr::get_default_resource());
+
+        // A received block. Returns true when it was crossfaded in place after a loss.
+        bool receive(float * block);
+        // Writes a stand-in for one missing block.
+        void conceal(float * block);
+        void reset();
+        // The synthesis area is scratch and isn't part of the state.
+        size_t state_bytes() const { return (this->buffer.size() - BLOCK - OVERLAP) * sizeof(float) + 2 * sizeof(uint32_t); }
+        void save_state(std::vector<unsigned char> &) const;
+        const unsigned char * load_state(const unsigned char *);
+
+        unsigned get_period() const { return this->period; }
+        size_t footprint() const { return sizeof(*this) + this->buffer.capacity() * sizeof(float); }
+    };
+
+    // Levinson-Durbin on autocorrelation r[0..order]: a[k] predicts x[n] as sum a[k] * x[n-1-k].
+    // Returns the final prediction error, 0 when r[0] is 0.
+    float levinson_durbin(const float * r, float * a, size_t order);
+
+}
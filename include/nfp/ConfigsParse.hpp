@@ -3,8 +3,15 @@
 #include <nfp/SignalPipeline.hpp>
 #include <nfp/UDPInterface.hpp>
 #include <nfp/DigitalFilter.hpp>
+#include <nfp/RouteTable.hpp>
+#include <nfp/FilterAnalysis.hpp>
+#include <nfp/FilterDesign.hpp>
+#include <nfp/FixedPoint.hpp>
+#include <nfp/Kernels.hpp>
+#include <nfp/PipelineGraph.hpp>
 #include <nlohmann/json.hpp>
 #include <vector>
+#include <map>
 
 using json = nlohmann::json;
 using nfp::SignalPipeline;
@@ -20,6 +27,32 @@ namespace nfp {
         float BW;
         float gain;
         std::string type;
+        bool by_spec = false;
+        float pass_freq = 0.0f;
+        float stop_freq = 0.0f;
+        float ripple = 1.0f;
+        float attenuation = 40.0f;
+        std::string family = "auto";
+        unsigned fft_size = 256;
+        unsigned hop = 128;
+        std::string window = "hann";
+        std::string spectrum_output = "magnitude";
+        std::vector<std::pair<float, float>> bands;
+    };
+
+    struct GraphNode_info {
+        std::string name;
+        std::string input = "in";
+        std::string pipeline_ref;
+        std::vector<PElement_info> pipeline;
+        std::vector<std::string> mix;
+        std::vector<float> weights;
+    };
+
+    struct Graph_info {
+        std::vector<GraphNode_info> nodes;
+        std::vector<std::string> outputs;
+        bool parallel = false;
     };
 
     struct Conn_info {
@@ -27,6 +60,61 @@ namespace nfp {
         uint16_t server_port;
         std::string client_addrv4;
         nfp::CONCEALMENT policy;
+        unsigned jitter_depth = 32;
+        unsigned warm_up = 5;
+        uint32_t conn_timeout_ms = 10000;
+        bool fixed_point = false;
+        float silence_threshold = 1e-6f;
+        bool suppress_silence = false;
+        std::vector<nfp::Sink> sinks;
+        nfp::ShmOutput shm;
+    };
+
+    struct Route_info {
+        uint32_t src_net = 0;
+        uint8_t src_prefix = 0;
+        uint16_t src_port_min = 0;
+        uint16_t src_port_max = UINT16_MAX;
+        uint16_t out_port_min = 0;
+        uint16_t out_port_max = UINT16_MAX;
+        std::string pipeline;
+        bool has_policy = false;
+        nfp::CONCEALMENT policy;
+        bool has_sinks = false;
+        std::vector<nfp::Sink> sinks;
+        bool has_shm = false;
+        nfp::ShmOutput shm;
+    };
+
+    struct Thread_info {
+        bool run_to_completion = false;
+        bool coroutines = false;
+        unsigned receivers = 1;
+        unsigned workers = 2;
+        unsigned senders = 1;
+        std::vector<int> receiver_cpus;
+        std::vector<int> worker_cpus;
+        std::vector<int> sender_cpus;
+        int fifo_priority = 0;
+        bool lock_memory = false;
+        unsigned queue_capacity = 512;
+        nfp::OVERLOAD overload_policy = nfp::OVERLOAD::DROP_NEWEST;
+        bool pause_reads = true;
+        unsigned backends = 0;
+        unsigned ring_capacity = 4096;
+        float tier_high = 0.9f;
+        float tier_low = 0.6f;
+        // Block kernels forced by the config; without it the best the host runs.
+        bool has_isa = false;
+        nfp::ISA isa = nfp::ISA::SCALAR;
+    };
+
+    struct Analysis_info {
+        bool enabled = true;
+        float max_gain_db = 40.0f;
+        float min_stability_margin = 0.0f;
+        unsigned points = 4096;
+        float min_snr_db = 60.0f;
     };
 
     json load_config_file(const std::string&);
@@ -35,5 +123,20 @@ namespace nfp {
     void from_json(const json&, Conn_info&);
     Conn_info parse_conn_from(const json&);
     SignalPipeline build_pipeline(const std::vector<PElement_info>&, float);
+    std::map<std::string, std::vector<PElement_info>> parse_named_pipelines_from(const json&);
+    constexpr size_t MAX_TIERS = 4;
+    std::map<std::string, std::vector<std::vector<PElement_info>>> parse_tiers_from(const json&, const std::map<std::string, std::vector<PElement_info>>&);
+    void from_json(const json&, GraphNode_info&);
+    void from_json(const json&, Graph_info&);
+    std::map<std::string, Graph_info> parse_graphs_from(const json&);
+    PipelineGraph build_graph(const Graph_info&, const std::map<std::string, std::vector<PElement_info>>&, float);
+    void from_json(const json&, Route_info&);
+    std::vector<Route_info> parse_routes_from(const json&);
+    RouteTable build_route_table(const json&, const Conn_info&);
+    void from_json(const json&, Thread_info&);
+    Thread_info parse_threads_from(const json&);
+    void from_json(const json&, Analysis_info&);
+    Analysis_info parse_analysis_from(const json&);
+    void validate_route_table(const RouteTable&, const Analysis_info&, float);
 }
 
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <nfp/SignalPipeline.hpp>
+#include <nfp/RouteTable.hpp>
+#include <nfp/FixedPoint.hpp>
+#include <nfp/PipelineGraph.hpp>
+#include <nfp/Concealment.hpp>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+namespace nfp {
+    #pragma pack(push, 1)
+    struct Datagram{
+        std::uint64_t seq;
+        std::uint16_t out_port;
+        union {
+            float data[128];
+            std::int16_t data16[128];
+        };
+    };
+
+    // Q15 wire format; same header, half the payload. Received into a Datagram and told apart by size.
+    struct Datagram16{
+        std::uint64_t seq;
+        std::uint16_t out_port;
+        std::int16_t data[128];
+    };
+    #pragma pack(pop)
+
+    class SlabAllocator {
+    private:
+        size_t slot_size;
+        size_t slots_per_chunk;
+        std::vector<unsigned char *> chunks;
+        void * free_list = nullptr;
+
+        void grow();
+
+    public:
+        SlabAllocator(size_t slot_size, size_t slots_per_chunk = 64);
+        SlabAllocator(const SlabAllocator&) = delete;
+        SlabAllocator& operator=(const SlabAllocator&) = delete;
+        ~SlabAllocator();
+
+        void * allocate();
+        void deallocate(void *);
+        void set_slot_size(size_t);
+        size_t get_slot_size() const { return this->slot_size; }
+        size_t reserved_bytes() const { return this->chunks.size() * this->slots_per_chunk * this->slot_size; }
+    };
+
+    // Cold per-connection data, followed in the same slab slot by jitter_depth Datagrams and by the
+    // arena the connection's filter state is allocated from. Reaping destroys it and returns the
+    // whole slot in one step; only state outgrowing the arena ever reaches the heap.
+    struct ConnCold {
+        union {
+            float last_good[128];
+            std::int16_t last_good16[128];
+        };
+
+        std::pmr::monotonic_buffer_resource arena;
+        std::optional<nfp::SignalPipeline> pipeline;
+        // The route's fallback tiers, if it has any; ConnState::tier picks the one running.
+        std::pmr::vector<nfp::SignalPipeline> tiers;
+        std::optional<nfp::FixedPointFilter> fixed;
+        std::optional<nfp::PipelineGraph> graph;
+        std::optional<nfp::Concealer> concealer;
+
+        ConnCold(void * buffer, size_t bytes) : last_good{}, arena(buffer, bytes), tiers(&arena) {}
+    };
+
+    struct alignas(64) ConnState {
+        static constexpr uint8_t OCCUPIED = 1;
+        static constexpr uint8_t INITIALIZED = 2;
+        static constexpr uint8_t INT16 = 4;
+
+        uint64_t key = 0;
+        uint64_t expected_seq = 0;
+        uint64_t deadline = UINT64_MAX;
+        ConnCold * cold = nullptr;
+        uint32_t present = 0;
+        uint16_t last_port = 55555;
+        uint16_t route = 0;
+        uint8_t flags = 0;
+        uint8_t tier = 0;
+        CONCEALMENT policy {CONCEALMENT::REPEAT_LAST_GOOD};
+
+        Datagram * slots() { return reinterpret_cast<Datagram *>(this->cold + 1); }
+        const Datagram * slots() const { return reinterpret_cast<const Datagram *>(this->cold + 1); }
+    };
+
+    class ConnTable {
+    private:
+        std::vector<ConnState> entries;
+        size_t count = 0;
+        unsigned shift = 58;
+        unsigned jitter_depth;
+        SlabAllocator cold_slab;
+        // Live keys per hash, changed under the owner's lock and read without it.
+        std::vector<std::atomic<uint16_t>> presence;
+
+        static constexpr float max_load = 0.7f;
+        static constexpr unsigned PRESENCE_BITS = 14;
+
+        size_t ideal_slot(uint64_t key) const { return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> this->shift); }
+        static size_t presence_slot(uint64_t key) { return static_cast<size_t>((key * 0xC2B2AE3D27D4EB4Full) >> (64 - PRESENCE_BITS)); }
+        size_t arena_offset() const;
+        void rehash();
+
+    public:
+        explicit ConnTable(unsigned jitter_depth);
+        ConnTable(const ConnTable&) = delete;
+        ConnTable& operator=(const ConnTable&) = delete;
+        ~ConnTable();
+
+        ConnState * find(uint64_t);
+        ConnState & find_or_insert(uint64_t, bool &);
+        bool erase(uint64_t);
+        // Safe without the owner's lock. Never false for a key in the table; may be true for a key
+        // that shares a hash with one, or for one inserted or erased concurrently.
+        bool may_contain(uint64_t key) const { return this->presence[presence_slot(key)].load(std::memory_order_relaxed) != 0; }
+
+        template<typename F> void for_each(F f) {
+            for (auto & e : this->entries)
+                if (e.flags & ConnState::OCCUPIED)
+                    f(e);
+        }
+
+        size_t size() const { return this->count; }
+        unsigned get_jitter_depth() const { return this->jitter_depth; }
+        void set_arena_bytes(size_t);
+        size_t hot_bytes_per_connection() const { return static_cast<size_t>(sizeof(ConnState) / max_load); }
+        size_t cold_bytes_per_connection() const { return this->cold_slab.get_slot_size(); }
+        size_t arena_bytes_per_connection() const { return this->cold_slab.get_slot_size() - this->arena_offset(); }
+    };
+}
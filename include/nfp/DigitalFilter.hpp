@@ -1,6 +1,8 @@
 #pragma once
 
 #include <vector>
+#include <memory_resource>
+#include <cstddef>
 #include <nfp/BiquadFilter.hpp>
 
 namespace nfp {
@@ -9,20 +11,31 @@ namespace nfp {
     private:
         float w0;
         float Q;
-        std::vector<nfp::BiquadFilter> biquad_cascate;
+        std::pmr::vector<nfp::BiquadFilter> biquad_cascate;
         enum class Normalization {DC, FC, FS};
         void normalize_ggain(Normalization = Normalization::DC);
     public:
         DigitalFilter(float w0, float Q): w0(w0), Q(Q){}
+        DigitalFilter(const DigitalFilter& other, std::pmr::memory_resource * arena)
+            : w0(other.w0), Q(other.Q), biquad_cascate(other.biquad_cascate, arena) {}
         float eval(float);
         void reset();
+        bool quiescent(float) const;
+        // Delay-line state only; loading it needs a filter of the same structure.
+        size_t state_bytes() const { return this->biquad_cascate.size() * nfp::BiquadFilter::state_bytes(); }
+        void save_state(std::vector<unsigned char> &) const;
+        const unsigned char * load_state(const unsigned char *);
         void processBlock(const std::vector<float> &, std::vector<float> &);
-        std::vector<float> coeffs();
+        // Same output as eval per sample; in and out may be the same buffer.
+        void processBlock(const float *, float *, size_t);
+        std::vector<float> coeffs() const;
+        size_t footprint() const;
 
         static DigitalFilter low_pass_filter(float, int=2, float Q=0.707);
         static DigitalFilter high_pass_filter(float, int=2, float Q=0.707); 
         static DigitalFilter band_pass_filter(float, float);
         static DigitalFilter notch_filter(float, float);
+        static DigitalFilter from_sections(float, std::vector<nfp::BiquadFilter>);
 
         constexpr float get_Q() const {return this->Q;};
         constexpr float get_w0() const {return this->w0;}
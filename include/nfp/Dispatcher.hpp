@@ -0,0 +1,74 @@
+#pragma once
+
+#include <nfp/UDPInterface.hpp>
+#include <nfp/ShmRing.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace nfp {
+
+    // Front of a multi-process instance: receives on the public port and pushes each datagram into
+    // the ring of the backend owning its source endpoint. It never filters, so one receiver keeps
+    // up with many backends.
+    class Dispatcher : public std::enable_shared_from_this<Dispatcher> {
+    private:
+        static constexpr unsigned RECV_BATCH = 32;
+
+        udp::socket socket;
+        udp::endpoint remote_endpoint;
+        Datagram rcv_package;
+        std::vector<nfp::ShmRing> rings;
+
+        void forward(size_t bytes);
+        void start_receive();
+
+    public:
+        // rings[i] feeds backend i.
+        Dispatcher(boost::asio::io_context&, int port, bool reuse_port, std::vector<nfp::ShmRing> rings);
+
+        // Backend of a connection key among n. Uses other key bits than the worker's buckets, so
+        // each backend still spreads its connections over all of its shards.
+        static size_t backend_of(uint64_t key, size_t n) { return static_cast<size_t>(((key * 0x9E3779B97F4A7C15ull) >> 40) % n); }
+        // Shared-memory name of the ring from one receiver of the dispatcher on port to a backend.
+        static std::string ring_name(uint16_t port, unsigned backend, unsigned receiver);
+
+        void start();
+        void close();
+        uint16_t port() const { return this->socket.local_endpoint().port(); }
+        uint64_t dropped(size_t backend) const { return this->rings.at(backend).dropped(); }
+    };
+
+    // Backend side of the rings: one thread polls them and feeds the worker, as a UDPServer would.
+    // While the worker pauses reads, datagrams wait in the rings.
+    class RingServer {
+    private:
+        static constexpr unsigned POLL_BATCH = 32;
+
+        std::vector<nfp::ShmRing> rings;
+        std::shared_ptr<UDPWorker> worker;
+        bool inline_dispatch = false;
+        std::atomic<bool> running {true};
+        std::mutex run_mtx;
+        std::shared_ptr<std::atomic<bool>> paused = std::make_shared<std::atomic<bool>>(false);
+        std::function<void()> resume_reads;
+
+        size_t poll(nfp::ShmRing&);
+
+    public:
+        // Claims every ring; fails if another live backend still consumes one of them.
+        RingServer(std::vector<nfp::ShmRing> rings);
+        ~RingServer() { this->close(); }
+
+        void set_worker(std::shared_ptr<UDPWorker> w) { this->worker = std::move(w); }
+        void set_inline_dispatch(bool v) { this->inline_dispatch = v; }
+        // Polls until close(), backing off while the rings are empty.
+        void run();
+        // Waits for run() to return and releases the rings; what is left in them goes to the next
+        // backend.
+        void close();
+    };
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace nfp {
+
+    struct FrequencyResponse {
+        std::vector<float> freqs;
+        std::vector<float> magnitude_db;
+        std::vector<float> phase;
+        std::vector<float> group_delay;
+    };
+
+    struct SectionReport {
+        std::array<std::complex<float>, 2> poles;
+        std::array<std::complex<float>, 2> zeros;
+        float pole_radius;
+        float peak_gain_db;
+        float state_peak_gain_db;
+    };
+
+    struct StabilityReport {
+        bool stable;
+        float max_pole_radius;
+        float stability_margin;
+        float peak_gain_db;
+        float peak_freq;
+        std::vector<SectionReport> sections;
+    };
+
+    // Evaluates a cascade in the SignalPipeline::coeffs() layout (a0, a1, a2, b0, b1, b2 per section).
+    class FilterAnalysis {
+    private:
+        std::vector<float> cs;
+        float fs;
+
+        size_t n_sections() const { return this->cs.size() / 6; }
+
+    public:
+        FilterAnalysis(std::vector<float> coeffs, float fs);
+
+        FrequencyResponse response(size_t n_points = 1024) const;
+        StabilityReport stability(size_t n_points = 4096) const;
+    };
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <nfp/DigitalFilter.hpp>
+#include <string>
+
+namespace nfp {
+
+    enum class FilterFamily {AUTO, BUTTERWORTH, CHEBYSHEV1, CHEBYSHEV2, ELLIPTIC};
+
+    // Edges in rad/sample; a pass edge above the stop edge describes a high-pass filter.
+    struct FilterSpec {
+        float pass_w;
+        float stop_w;
+        float ripple_db;
+        float attenuation_db;
+    };
+
+    int minimum_order(FilterFamily, const FilterSpec&);
+    FilterFamily cheapest_family(const FilterSpec&);
+    DigitalFilter design_filter(const FilterSpec&, FilterFamily = FilterFamily::AUTO);
+    std::string family_name(FilterFamily);
+
+}
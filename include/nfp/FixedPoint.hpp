@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace nfp {
+
+    // Q15 sample helpers, run by the active block kernels (nfp/Kernels.hpp).
+    int16_t to_q15(float);
+    void q15_from_float(const float *, int16_t *, size_t);
+    void float_from_q15(const int16_t *, float *, size_t);
+    void scale_q15(int16_t *, size_t, int16_t gain);
+
+    // Q31 cascade quantized from the SignalPipeline::coeffs() layout. Samples enter and leave as Q15,
+    // sections run in direct form I with 64-bit accumulators, first-order error feedback and saturation.
+    class FixedPointFilter {
+    private:
+        struct Section {
+            int32_t b0, b1, b2, a1, a2;
+            int frac_bits;
+        };
+
+        std::shared_ptr<const std::vector<Section>> sections;
+        std::pmr::vector<int32_t> state;
+
+        explicit FixedPointFilter(std::pmr::memory_resource * arena) : state(arena) {}
+
+    public:
+        FixedPointFilter() = default;
+        explicit FixedPointFilter(const std::vector<float> & coeffs);
+
+        void processBlock(const int16_t *, int16_t *, size_t);
+        void reset();
+        bool quiescent(int32_t threshold_q31) const;
+        size_t state_bytes() const { return this->state.size() * sizeof(int32_t); }
+        void save_state(std::vector<unsigned char> &) const;
+        const unsigned char * load_state(const unsigned char *);
+        FixedPointFilter clone(std::pmr::memory_resource * = std::pmr::get_default_resource()) const;
+
+        bool empty() const { return !this->sections; }
+        size_t n_sections() const { return this->sections ? this->sections->size() : 0; }
+        size_t footprint() const { return sizeof(*this) + this->state.capacity() * sizeof(int32_t); }
+    };
+
+    // Output SNR of the quantized cascade against a double precision reference, for a -12 dBFS noise input.
+    float quantization_snr(const std::vector<float> & coeffs, const FixedPointFilter &, size_t n_samples = 8192);
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace nfp {
+
+    enum class OVERLOAD {DROP_NEWEST, DROP_OLDEST, ESTABLISHED_FIRST};
+
+    // Fixed-capacity FIFO of packets keyed by connection. When full, the overload policy decides
+    // whether the incoming packet is dropped or takes the slot of a queued one:
+    //  - DROP_NEWEST: the incoming packet is dropped.
+    //  - DROP_OLDEST: the oldest queued packet of the same connection is dropped.
+    //  - ESTABLISHED_FIRST: packets of new connections are dropped, newest first, to admit
+    //    packets of established ones. Whether a packet's connection was established is taken once,
+    //    when the packet arrives.
+    // Packets of one connection always leave in arrival order.
+    template<typename T>
+    class IngressQueue {
+    public:
+        enum class Admit {QUEUED, REPLACED, DROPPED};
+
+    private:
+        struct Entry {
+            uint64_t key;
+            T item;
+            bool established;
+        };
+
+        std::vector<Entry> entries;
+        size_t head = 0;
+        size_t count = 0;
+
+        Entry & at(size_t i) { return this->entries[(this->head + i) % this->entries.size()]; }
+
+        // Overwrites position i, then carries the new packet past the later packets of its own
+        // connection so that connection's order is kept.
+        void place(size_t i, uint64_t key, T&& item, bool established) {
+            this->at(i) = Entry{key, std::move(item), established};
+
+            for (size_t k = i + 1; k < this->count; ++k)
+                if (this->at(k).key == key) {
+                    std::swap(this->at(i), this->at(k));
+                    i = k;
+                }
+        }
+
+    public:
+        explicit IngressQueue(size_t capacity = 512) : entries(capacity ? capacity : 1) {}
+
+        // established is only read by ESTABLISHED_FIRST.
+        Admit push(uint64_t key, T item, OVERLOAD policy, bool established = false) {
+            if (this->count < this->entries.size()) {
+                this->at(this->count++) = Entry{key, std::move(item), established};
+                return Admit::QUEUED;
+            }
+
+            if (policy == OVERLOAD::DROP_OLDEST) {
+                for (size_t i = 0; i < this->count; ++i)
+                    if (this->at(i).key == key) {
+                        this->place(i, key, std::move(item), established);
+                        return Admit::REPLACED;
+                    }
+            } else if (policy == OVERLOAD::ESTABLISHED_FIRST && established) {
+                for (size_t i = this->count; i-- > 0; )
+                    if (this->at(i).key != key && !this->at(i).established) {
+                        this->place(i, key, std::move(item), established);
+                        return Admit::REPLACED;
+                    }
+            }
+
+            return Admit::DROPPED;
+        }
+
+        bool pop(T & out) {
+            if (this->count == 0)
+                return false;
+
+            out = std::move(this->at(0).item);
+            this->head = (this->head + 1) % this->entries.size();
+            --this->count;
+            return true;
+        }
+
+        size_t size() const { return this->count; }
+        size_t capacity() const { return this->entries.size(); }
+        bool full() const { return this->count == this->entries.size(); }
+        bool empty() const { return this->count == 0; }
+    };
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace nfp {
+
+    // Instruction sets the block kernels are built for. The best one the host runs is picked on first
+    // use, unless NFP_ISA names another; every set gives bit-identical results.
+    enum class ISA : uint8_t { SCALAR, SSE2, AVX2, AVX512, NEON };
+
+    struct Kernels {
+        ISA isa;
+
+        // Biquad cascade over a block. Sections as BiquadFilter keeps them: a1, a2, b0, b1, b2
+        // normalized by a0, and the delay line v[n - 1], v[n - 2]. out may alias in.
+        void (*cascade)(const float * coeffs, float * state, size_t sections, const float * in, float * out, size_t n);
+        void (*scale)(const float * in, float * out, size_t n, float gain);
+        // out[i] = max(0, start - step * i) * in[i]
+        void (*fade)(const float * in, float * out, size_t n, float start, float step);
+        // to[i] = w * to[i] + (1 - w) * gain * from[i], with w = (i + 1) / steps
+        void (*crossfade)(const float * from, float * to, size_t n, size_t steps, float gain);
+        void (*q15_from_float)(const float *, int16_t *, size_t);
+        void (*float_from_q15)(const int16_t *, float *, size_t);
+        void (*scale_q15)(int16_t *, size_t, int16_t);
+    };
+
+    // One set per instruction set; only those this build has are defined.
+    extern const Kernels scalar_kernels, sse2_kernels, avx2_kernels, avx512_kernels, neon_kernels;
+
+    const Kernels & kernels();
+
+    // Built into this binary and runnable on this host.
+    bool isa_supported(ISA);
+    ISA best_isa();
+    // Meant for startup, before the workers run.
+    void select_isa(ISA);
+
+    const char * isa_name(ISA);
+    ISA isa_from_name(const std::string &);
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace nfp {
+
+    // Unbounded multi-producer, single-consumer mailbox. Producers push onto an intrusive list with
+    // one CAS; the consumer takes the whole list with one exchange and reverses it, so messages come
+    // out in push order and neither side ever waits on the other.
+    template<typename T>
+    class Mailbox {
+    private:
+        struct Node {
+            T item;
+            Node * next;
+        };
+
+        std::atomic<Node *> head {nullptr};
+
+    public:
+        Mailbox() = default;
+        Mailbox(const Mailbox&) = delete;
+        Mailbox& operator=(const Mailbox&) = delete;
+
+        ~Mailbox() {
+            for (Node * n = this->head.load(); n; ) {
+                Node * next = n->next;
+                delete n;
+                n = next;
+            }
+        }
+
+        void push(T item) {
+            Node * node = new Node{std::move(item), this->head.load(std::memory_order_relaxed)};
+
+            while (!this->head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+                ;
+        }
+
+        // Consumer side only.
+        template<typename F> size_t drain(F f) {
+            Node * reversed = nullptr;
+
+            for (Node * n = this->head.exchange(nullptr, std::memory_order_acquire); n; ) {
+                Node * next = n->next;
+                n->next = reversed;
+                reversed = n;
+                n = next;
+            }
+
+            size_t count = 0;
+
+            for (Node * n = reversed; n; ++count) {
+                Node * next = n->next;
+                T item = std::move(n->item);
+                delete n;
+                n = next;
+                f(std::move(item));
+            }
+
+            return count;
+        }
+
+        bool empty() const { return this->head.load(std::memory_order_relaxed) == nullptr; }
+    };
+
+}
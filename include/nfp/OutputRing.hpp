@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace nfp {
+
+    // Layout of an output ring in /dev/shm/nfp-out-<name>, shared with nfp_shm.h and
+    // tools/nfp_shm.py. Fields are in host byte order; offsets are fixed by the static_asserts in
+    // OutputRing.cpp.
+    //
+    //   0   char magic[8] "NFPOUT01"      64  u64 write_seq: next sequence to reserve
+    //   8   u32 version                  128  u32 wake: bumped after every block (futex word)
+    //  12   u32 slot_bytes               132  u32 waiters: readers sleeping on wake
+    //  16   u64 capacity (slots, 2^k)
+    //  24   u32 slot_stride              slot i at 192 + i * slot_stride:
+    //  28   u32 closed                     0  u64 seq: s + 1 once block s is complete
+    //  32   i64 writer pid                 8  u16 port, u16 format, u32 bytes
+    //                                     16  payload
+    // While block s is being written its slot's seq is (s + 1) | WRITING.
+    namespace shm_layout {
+        constexpr char MAGIC[8] = {'N', 'F', 'P', 'O', 'U', 'T', '0', '1'};
+        constexpr uint32_t VERSION = 1;
+        constexpr size_t HEADER_BYTES = 192;
+        constexpr size_t SLOT_HEADER_BYTES = 16;
+        constexpr uint64_t WRITING = uint64_t(1) << 63;
+
+        enum FORMAT : uint16_t {FLOAT32 = 0, INT16 = 1, FRAMES = 2};
+
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t slot_bytes;
+            uint64_t capacity;
+            uint32_t slot_stride;
+            std::atomic<uint32_t> closed;
+            int64_t writer;
+            alignas(64) std::atomic<uint64_t> write_seq;
+            alignas(64) std::atomic<uint32_t> wake;
+            std::atomic<uint32_t> waiters;
+        };
+
+        struct Slot {
+            std::atomic<uint64_t> seq;
+            uint16_t port;
+            uint16_t format;
+            uint32_t bytes;
+        };
+    }
+
+    // Writer side: any number of threads of one process append blocks. Readers never hold the
+    // writer back; one that falls a whole ring behind loses the blocks it missed.
+    class OutputRing {
+    private:
+        std::string name;
+        shm_layout::Header * header = nullptr;
+        unsigned char * slots = nullptr;
+        size_t mapped = 0;
+        uint64_t inode = 0;
+
+    public:
+        // Replaces any ring of that name; readers of the old one see it closed.
+        OutputRing(const std::string& name, size_t capacity, size_t slot_bytes);
+        OutputRing(const OutputRing&) = delete;
+        OutputRing& operator=(const OutputRing&) = delete;
+        ~OutputRing();
+
+        static std::string path_of(const std::string& name) { return "/nfp-out-" + name; }
+
+        // Blocks larger than slot_bytes are not written; returns false for them.
+        bool write(const void * data, size_t bytes, uint16_t port, shm_layout::FORMAT);
+
+        const std::string& get_name() const { return this->name; }
+        size_t slot_bytes() const { return this->header->slot_bytes; }
+        uint64_t written() const { return this->header->write_seq.load(std::memory_order_relaxed); }
+    };
+
+    // Reader side; blocks are read in place and stay valid until the writer comes round again.
+    class OutputRingReader {
+    private:
+        shm_layout::Header * header = nullptr;
+        unsigned char * slots = nullptr;
+        size_t mapped = 0;
+        uint64_t next = 0;
+        uint64_t lost_blocks = 0;
+
+        const shm_layout::Slot * slot(uint64_t seq) const;
+
+    public:
+        struct Block {
+            uint64_t seq;
+            uint16_t port;
+            shm_layout::FORMAT format;
+            uint32_t bytes;
+            const void * data;
+        };
+
+        // Starts at the next block written.
+        explicit OutputRingReader(const std::string& name);
+        OutputRingReader(const OutputRingReader&) = delete;
+        OutputRingReader& operator=(const OutputRingReader&) = delete;
+        ~OutputRingReader();
+
+        // Waits up to timeout_ms (-1 for ever) for the next block. Returns 1 with a block, 0 on
+        // timeout and -1 once the writer has closed the ring or died.
+        int next_block(Block&, int timeout_ms);
+        // Whether b's data was not overwritten while it was being read.
+        bool valid(const Block& b) const;
+        uint64_t lost() const { return this->lost_blocks; }
+    };
+
+}
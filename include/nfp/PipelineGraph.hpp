@@ -0,0 +1,91 @@
+#pragma once
+
+#include <nfp/SignalPipeline.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nfp {
+
+    struct PlanCodec;
+
+    // DAG of linear chains and weighted mixes over one input block. compile() orders the nodes in
+    // dependency levels and assigns every intermediate block a slot of a per-connection block store
+    // by liveness, so processing never allocates; nodes of the same level are independent and may run
+    // on separate threads.
+    class PipelineGraph {
+    public:
+        static constexpr size_t BLOCK = 128;
+        using ParallelFor = std::function<void(size_t, const std::function<void(size_t)>&)>;
+
+    private:
+        struct NodeDef {
+            std::string name;
+            std::vector<std::string> inputs;
+            std::vector<float> weights;
+            bool mix;
+            nfp::SignalPipeline chain;
+        };
+
+        struct Step {
+            bool mix;
+            uint16_t chain;
+            uint16_t out;
+            std::vector<uint16_t> in;
+            std::vector<float> weights;
+        };
+
+        struct Schedule {
+            std::vector<Step> steps;
+            std::vector<size_t> level_ends;
+            std::vector<uint16_t> outputs;
+            std::vector<std::string> chain_names;
+            std::vector<nfp::SignalPipeline> chains;
+            uint16_t n_buffers = 0;
+            bool parallel = false;
+        };
+
+        std::vector<NodeDef> defs;
+        std::vector<std::string> output_names;
+
+        std::shared_ptr<const Schedule> schedule;
+        std::pmr::vector<nfp::SignalPipeline> chains;
+        std::pmr::vector<float> blocks;
+
+        float * buffer(uint16_t b) { return this->blocks.data() + b * BLOCK; }
+        void run_step(const Step&, size_t);
+
+        friend struct nfp::PlanCodec;
+
+    public:
+        PipelineGraph() = default;
+        explicit PipelineGraph(std::pmr::memory_resource * arena) : chains(arena), blocks(arena) {}
+
+        void add_chain(const std::string& name, const std::string& input, nfp::SignalPipeline);
+        void add_mix(const std::string& name, std::vector<std::string> inputs, std::vector<float> weights);
+        void add_output(const std::string& name) { this->output_names.push_back(name); }
+        void compile(bool parallel = false);
+
+        void processBlock(const float *, size_t, const ParallelFor * = nullptr);
+        const float * output(size_t i) const { return this->blocks.data() + this->schedule->outputs[i] * BLOCK; }
+        size_t n_outputs() const { return this->schedule->outputs.size(); }
+
+        void reset();
+        bool quiescent(float) const;
+        // Chain state only: the block store is rewritten by every processBlock.
+        size_t state_bytes() const;
+        void save_state(std::vector<unsigned char> &) const;
+        const unsigned char * load_state(const unsigned char *);
+        PipelineGraph clone(std::pmr::memory_resource * = std::pmr::get_default_resource()) const;
+
+        size_t n_buffers() const { return this->schedule->n_buffers; }
+        size_t n_chains() const { return this->schedule->chains.size(); }
+        const std::string& chain_name(size_t i) const { return this->schedule->chain_names[i]; }
+        const nfp::SignalPipeline& chain(size_t i) const { return this->schedule->chains[i]; }
+        size_t footprint() const;
+    };
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <nfp/ConfigsParse.hpp>
+#include <nfp/RouteTable.hpp>
+#include <cstdint>
+#include <string>
+
+namespace nfp {
+
+    // Everything app needs to start, already designed: final filter coefficients, routes and thread
+    // settings. nfp-compile writes it once, every instance on the host maps the same file.
+    struct Plan {
+        Conn_info conn;
+        Thread_info threads;
+        Analysis_info analysis;
+        RouteTable routes;
+    };
+
+    // File layout: PlanHeader, then payload_bytes of payload checksummed with FNV-1a. The payload is
+    // in host byte order; the endian marker rejects files written on a host of the other order.
+    struct PlanHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t endian;
+        uint64_t payload_bytes;
+        uint64_t checksum;
+    };
+
+    constexpr uint32_t PLAN_VERSION = 9;
+
+    Plan plan_from_config(const json&);
+    void save_plan(const Plan&, const std::string&);
+    Plan load_plan(const std::string&);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <nfp/SignalPipeline.hpp>
+#include <nfp/FixedPoint.hpp>
+#include <nfp/PipelineGraph.hpp>
+#include <nfp/Concealment.hpp>
+#include <memory>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nfp {
+
+    enum class CONCEALMENT {REPEAT_LAST_GOOD, FADE_LAST_GOOD, ALL_ZERO, LPC_EXTRAPOLATION, PITCH_REPETITION};
+
+    // Policies that keep a Concealer in the connection arena.
+    inline bool model_based(CONCEALMENT policy) {
+        return policy == CONCEALMENT::LPC_EXTRAPOLATION || policy == CONCEALMENT::PITCH_REPETITION;
+    }
+
+    inline nfp::Concealer::MODEL concealment_model(CONCEALMENT policy) {
+        return policy == CONCEALMENT::PITCH_REPETITION ? nfp::Concealer::MODEL::PITCH : nfp::Concealer::MODEL::LPC;
+    }
+
+    // Output destination of a route. Port 0 keeps the datagram's out-port; multicast groups are sent
+    // with ttl through the interface address iface, 0 for the system's choice.
+    struct Sink {
+        uint32_t addr = 0;
+        uint16_t port = 0;
+        uint8_t ttl = 1;
+        uint32_t iface = 0;
+
+        bool operator==(const Sink& o) const { return addr == o.addr && port == o.port && ttl == o.ttl && iface == o.iface; }
+    };
+
+    // Shared-memory output of a route, see OutputRing.hpp; an empty name means none. Without udp the
+    // route's blocks only go to the ring.
+    struct ShmOutput {
+        std::string name;
+        uint32_t slots = 256;
+        bool udp = true;
+
+        bool operator==(const ShmOutput& o) const { return name == o.name && slots == o.slots && udp == o.udp; }
+    };
+
+    struct Route {
+        std::string name;
+        nfp::SignalPipeline pipeline;
+        CONCEALMENT policy {CONCEALMENT::REPEAT_LAST_GOOD};
+        nfp::FixedPointFilter fixed;
+        std::shared_ptr<const nfp::PipelineGraph> graph;
+        std::vector<Sink> sinks;
+        ShmOutput shm;
+        // Cheaper fallbacks for the pipeline, cheapest last; tier k runs tiers[k - 1].
+        std::vector<nfp::SignalPipeline> tiers;
+
+        size_t arena_bytes() const;
+    };
+
+    struct PlanCodec;
+
+    class RouteTable {
+    private:
+        // Compact rule layout: one rule per 16 bytes, scanned in config order.
+        struct Rule {
+            uint32_t net;
+            uint32_t mask;
+            uint16_t src_port_min;
+            uint16_t src_port_max;
+            uint16_t out_port_min;
+            uint16_t out_port_max;
+        };
+
+        std::vector<Rule> rules;
+        std::vector<uint16_t> rule_targets;
+        std::vector<Route> routes;
+        uint16_t default_route = 0;
+
+        friend struct nfp::PlanCodec;
+
+    public:
+        uint16_t add_route(const std::string&, nfp::SignalPipeline, CONCEALMENT, nfp::FixedPointFilter = {});
+        uint16_t add_route(const std::string&, nfp::PipelineGraph, CONCEALMENT);
+        void add_rule(uint32_t, uint8_t, uint16_t, uint16_t, uint16_t, uint16_t, uint16_t);
+        void set_default_route(uint16_t route) { this->default_route = route; }
+        void set_sinks(uint16_t route, std::vector<Sink> sinks) { this->routes.at(route).sinks = std::move(sinks); }
+        void set_shm_output(uint16_t route, ShmOutput shm) { this->routes.at(route).shm = std::move(shm); }
+        void set_tiers(uint16_t route, std::vector<nfp::SignalPipeline> tiers) { this->routes.at(route).tiers = std::move(tiers); }
+
+        uint16_t lookup(uint32_t, uint16_t, uint16_t) const;
+        const Route& at(uint16_t route) const { return this->routes.at(route); }
+
+        size_t size() const { return this->routes.size(); }
+        bool empty() const { return this->routes.empty(); }
+    };
+
+}
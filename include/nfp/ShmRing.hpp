@@ -0,0 +1,127 @@
+#pragma once
+
+#include <nfp/ConnTable.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace nfp {
+
+    // A datagram crossing a ring, with its source endpoint and size on the wire.
+    struct RingSlot {
+        uint32_t addr;
+        uint16_t port;
+        uint16_t bytes;
+        Datagram pkg;
+    };
+
+    // Single-producer, single-consumer ring of datagrams in POSIX shared memory, between the
+    // dispatcher and one backend process. Indices are free-running counters on separate cache lines
+    // and each side caches the other's, so a transfer touches a shared line only when the cached
+    // view runs out. A full ring drops at the producer: a stalled or dead backend never blocks the
+    // dispatcher. The consumer claims the ring with its pid; once that process is gone a
+    // replacement can claim it and goes on from the first unread datagram.
+    class ShmRing {
+    public:
+        static constexpr uint64_t MAGIC = 0x4E4650524E473031ull;
+
+        struct Header {
+            uint64_t magic;
+            uint64_t capacity;
+            alignas(64) std::atomic<uint64_t> tail;
+            alignas(64) std::atomic<uint64_t> head;
+            alignas(64) std::atomic<uint64_t> dropped;
+            std::atomic<int64_t> consumer;
+        };
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "Rings need lock-free 64-bit atomics!");
+
+    private:
+        std::string name;
+        Header * header = nullptr;
+        RingSlot * slots = nullptr;
+        size_t mapped = 0;
+        uint64_t mask = 0;
+        uint64_t cached_head = 0;
+        uint64_t cached_tail = 0;
+        bool owner = false;
+
+        ShmRing(const std::string& name, bool create, size_t capacity);
+        void unmap();
+
+    public:
+        // Producer side: a new ring of capacity (a power of two) slots, replacing any old one.
+        static ShmRing create(const std::string& name, size_t capacity);
+        // Consumer side: a ring the producer created.
+        static ShmRing attach(const std::string& name);
+
+        ShmRing(ShmRing&&) noexcept;
+        ShmRing& operator=(ShmRing&&) noexcept;
+        ShmRing(const ShmRing&) = delete;
+        ShmRing& operator=(const ShmRing&) = delete;
+        ~ShmRing();
+
+        // Returns false, and counts the drop, when the ring is full.
+        bool push(const Datagram& pkg, size_t bytes, uint32_t addr, uint16_t port) {
+            const uint64_t t = this->header->tail.load(std::memory_order_relaxed);
+
+            if (t - this->cached_head > this->mask) {
+                this->cached_head = this->header->head.load(std::memory_order_acquire);
+
+                if (t - this->cached_head > this->mask) {
+                    this->header->dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+            }
+
+            RingSlot & slot = this->slots[t & this->mask];
+            slot.addr = addr;
+            slot.port = port;
+            slot.bytes = static_cast<uint16_t>(bytes);
+            std::memcpy(&slot.pkg, &pkg, std::min(bytes, sizeof(Datagram)));
+
+            this->header->tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Hands up to max datagrams to f in place, then frees their slots; f returns false to stop
+        // after the datagram it was given.
+        template<typename F> size_t consume(size_t max, F f) {
+            const uint64_t h = this->header->head.load(std::memory_order_relaxed);
+
+            if (h == this->cached_tail) {
+                this->cached_tail = this->header->tail.load(std::memory_order_acquire);
+
+                if (h == this->cached_tail)
+                    return 0;
+            }
+
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(max, this->cached_tail - h));
+            size_t taken = 0;
+
+            while (taken < n) {
+                const RingSlot & slot = this->slots[(h + taken) & this->mask];
+                ++taken;
+
+                if (!f(slot))
+                    break;
+            }
+
+            this->header->head.store(h + taken, std::memory_order_release);
+            return taken;
+        }
+
+        // Fails while another live process consumes the ring.
+        void claim();
+        void release();
+
+        const std::string& get_name() const { return this->name; }
+        size_t capacity() const { return static_cast<size_t>(this->mask + 1); }
+        size_t size() const { return static_cast<size_t>(this->header->tail.load() - this->header->head.load()); }
+        uint64_t dropped() const { return this->header->dropped.load(std::memory_order_relaxed); }
+    };
+
+}
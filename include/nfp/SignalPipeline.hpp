@@ -1,5 +1,8 @@
 #pragma once
 #include <nfp/DigitalFilter.hpp>
+#include <nfp/Spectrum.hpp>
+#include <nfp/Arena.hpp>
+#include <nfp/Kernels.hpp>
 #include <vector>
 #include <array>
 #include <memory>
@@ -11,7 +14,16 @@ namespace nfp {
         public:
             virtual float eval(float x) = 0;
             virtual void processBlock(const std::vector<float> &, std::vector<float>&);
+            // Whole block through this element; output may alias input.
+            virtual void processBlock(const float *, float *, size_t);
             virtual std::vector<float> coeffs() const = 0;
+            virtual nfp::arena_ptr<PipelineElement> clone(std::pmr::memory_resource *) const = 0;
+            virtual size_t footprint() const = 0;
+            virtual void reset() {}
+            virtual bool quiescent(float) const { return true; }
+            virtual size_t state_bytes() const { return 0; }
+            virtual void save_state(std::vector<unsigned char> &) const {}
+            virtual const unsigned char * load_state(const unsigned char * in) { return in; }
             virtual ~PipelineElement() = default;
         };
 
@@ -21,28 +33,60 @@ namespace nfp {
         public:
             GainElement(float gain) : gain(gain) {}
             float eval(float x) override { return this->gain * x; }
+            using PipelineElement::processBlock;
+            void processBlock(const float * in, float * out, size_t n) override { nfp::kernels().scale(in, out, n, this->gain); }
             constexpr float get_gain() const { return this->gain; }
             std::vector<float> coeffs() const override { return std::vector<float> {1, 0, 0, this->gain, 0, 0}; }
+            nfp::arena_ptr<PipelineElement> clone(std::pmr::memory_resource * arena) const override { return nfp::make_in<GainElement>(arena, this->gain); }
+            size_t footprint() const override { return sizeof(*this); }
         };
 
         class DigitalFilterElement : public PipelineElement {
             private:
-                std::unique_ptr<nfp::DigitalFilter> filter;
+                nfp::DigitalFilter filter;
             public:
-                DigitalFilterElement(nfp::DigitalFilter f) : filter(std::make_unique<nfp::DigitalFilter>(std::move(f))) {}
-                float eval(float x) override {return this->filter->eval(x); }
-                std::vector<float> coeffs() const override { return this->filter->coeffs(); }
+                DigitalFilterElement(nfp::DigitalFilter f) : filter(std::move(f)) {}
+                DigitalFilterElement(const nfp::DigitalFilter& f, std::pmr::memory_resource * arena) : filter(f, arena) {}
+                float eval(float x) override {return this->filter.eval(x); }
+                using PipelineElement::processBlock;
+                void processBlock(const float * in, float * out, size_t n) override { this->filter.processBlock(in, out, n); }
+                std::vector<float> coeffs() const override { return this->filter.coeffs(); }
+                nfp::arena_ptr<PipelineElement> clone(std::pmr::memory_resource * arena) const override { return nfp::make_in<DigitalFilterElement>(arena, this->filter, arena); }
+                size_t footprint() const override { return sizeof(*this) - sizeof(this->filter) + this->filter.footprint(); }
+                void reset() override { this->filter.reset(); }
+                bool quiescent(float threshold) const override { return this->filter.quiescent(threshold); }
+                size_t state_bytes() const override { return this->filter.state_bytes(); }
+                void save_state(std::vector<unsigned char> & out) const override { this->filter.save_state(out); }
+                const unsigned char * load_state(const unsigned char * in) override { return this->filter.load_state(in); }
         };
 
-        std::vector<std::unique_ptr<PipelineElement>> elements;
+        std::pmr::vector<nfp::arena_ptr<PipelineElement>> elements;
+        nfp::arena_ptr<nfp::SpectrumAnalyzer> spectrum;
+
+        std::pmr::memory_resource * arena() const { return this->elements.get_allocator().resource(); }
         
     public:
-        void add_gain(float gain) { elements.push_back(std::make_unique<GainElement>(gain)); }
-        void add_digital_filter(nfp::DigitalFilter f) { elements.push_back(std::make_unique<DigitalFilterElement>(std::move(f))); }
+        SignalPipeline() = default;
+        explicit SignalPipeline(std::pmr::memory_resource * arena) : elements(arena) {}
+
+        void add_gain(float gain) { elements.push_back(nfp::make_in<GainElement>(this->arena(), gain)); }
+        void add_digital_filter(nfp::DigitalFilter f) { elements.push_back(nfp::make_in<DigitalFilterElement>(this->arena(), std::move(f))); }
+        void set_spectrum(nfp::SpectrumAnalyzer s) { spectrum = nfp::make_in<nfp::SpectrumAnalyzer>(this->arena(), std::move(s)); }
+        nfp::SpectrumAnalyzer * get_spectrum() const { return this->spectrum.get(); }
 
         float process(float x);
         void processBlock(const std::vector<float> &, std::vector<float> &);
+        void processBlock(const float *, float *, size_t);
         std::vector<float> coeffs() const;
-        
+        SignalPipeline clone(std::pmr::memory_resource * = std::pmr::get_default_resource()) const;
+        size_t footprint() const;
+        void reset();
+        bool quiescent(float) const;
+
+        // Filter and analyzer state, for moving a connection without resetting it. Loading expects
+        // exactly state_bytes() from a pipeline of the same structure.
+        size_t state_bytes() const;
+        void save_state(std::vector<unsigned char> &) const;
+        const unsigned char * load_state(const unsigned char *);
     };
 }
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <nfp/UDPInterface.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace nfp {
+
+    // Single-threaded discrete-event run of a UDPWorker with no sockets: datagrams are delivered
+    // at virtual times, connection expiry follows the virtual clock, and output blocks are handed
+    // to an observer instead of being sent. Runs are repeatable and go as fast as the CPU allows.
+    class Simulator : private Outbox {
+    public:
+        using Duration = steady_clock::duration;
+
+        struct Output {
+            Duration at;
+            uint16_t port;
+            uint16_t offset;
+            const std::vector<nfp::Sink> * sinks;
+            boost::asio::const_buffer data;
+        };
+
+        struct Stats {
+            uint64_t delivered = 0;
+            uint64_t outputs = 0;
+            uint64_t output_bytes = 0;
+            uint64_t ticks = 0;
+            std::chrono::nanoseconds busy {0};
+        };
+
+        // Fills a datagram's samples; seq, out_port and the source are set by the simulator.
+        using Payload = std::function<void(const udp::endpoint&, uint64_t seq, Datagram&)>;
+
+    private:
+        struct Stream {
+            udp::endpoint src;
+            uint16_t out_port;
+            std::vector<uint64_t> seqs;
+            Duration start;
+            Duration interval;
+            bool q15;
+        };
+
+        struct Event {
+            Duration at;
+            uint64_t order;
+            size_t stream;
+            size_t next;
+
+            bool operator>(const Event& other) const {
+                return this->at != other.at ? this->at > other.at : this->order > other.order;
+            }
+        };
+
+        UDPWorker & worker;
+        const steady_clock::time_point epoch {};
+        Duration clock {0};
+        Duration next_tick;
+
+        std::vector<Stream> streams;
+        std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+        uint64_t order = 0;
+
+        Payload payload;
+        std::function<void(const Output&)> observer;
+        Stats counters;
+
+        void emit(boost::asio::const_buffer, uint16_t port, uint16_t offset, const std::vector<nfp::Sink>&) override;
+        void advance(Duration to);
+
+    public:
+        // Takes over the worker's clock; the worker must not be used elsewhere during the run.
+        explicit Simulator(UDPWorker&);
+
+        // Sends seqs, in that order, from src: the k-th at start + k * interval.
+        void stream(const udp::endpoint& src, uint16_t out_port, std::vector<uint64_t> seqs, Duration start, Duration interval, bool q15 = false);
+
+        void set_payload(Payload p) { this->payload = std::move(p); }
+        void on_output(std::function<void(const Output&)> f) { this->observer = std::move(f); }
+
+        // Processes every delivery and expiry tick due up to t, then leaves the clock at t.
+        void run_until(Duration t);
+        // Until no deliveries are left.
+        void run();
+
+        Duration now() const { return this->clock; }
+        const Stats& stats() const { return this->counters; }
+    };
+
+    // Scenario helpers working on a stream's send order.
+    namespace sim {
+        std::vector<uint64_t> sequence(uint64_t first, size_t n);
+
+        // Burst loss: removes seqs [from, from + n).
+        void drop(std::vector<uint64_t>&, uint64_t from, size_t n);
+
+        // Independent loss with probability p, from a seeded generator.
+        void drop_random(std::vector<uint64_t>&, double p, uint64_t seed);
+
+        // The packet at index i arrives distance positions later.
+        void delay(std::vector<uint64_t>&, size_t i, size_t distance);
+
+        // Every seq from index i on is shifted by n.
+        void jump(std::vector<uint64_t>&, size_t i, uint64_t n);
+    }
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+namespace nfp {
+
+    // Connection table snapshot: SnapshotHeader, then payload_bytes of connection records
+    // checksummed with FNV-1a, in host byte order like plans. Each record holds
+    //  - key, expected seq, ticks left before expiry, present mask, last port, route, flags and tier;
+    //  - the last good block and every buffered datagram, at the connection's sample width;
+    //  - the length of the filter state, then pipeline, tier, fixed-point, graph and concealer state.
+    // Records carry no coefficients: they are restored onto filters built from the same routes.
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t endian;
+        uint32_t jitter_depth;
+        uint32_t n_conns;
+        uint64_t payload_bytes;
+        uint64_t checksum;
+    };
+
+    constexpr uint32_t SNAPSHOT_VERSION = 2;
+
+}
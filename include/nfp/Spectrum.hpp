@@ -0,0 +1,94 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+namespace nfp {
+
+    enum class WindowType {RECTANGULAR, HANN, HAMMING};
+    enum class SpectrumOutput {MAGNITUDE, BANDS};
+
+    // Header of each feature datagram, followed by n_features floats.
+    #pragma pack(push, 1)
+    struct FeatureFrameHeader {
+        uint64_t frame;
+        uint16_t n_features;
+        uint8_t kind;
+        uint8_t reserved;
+    };
+    #pragma pack(pop)
+
+    // Real FFT of a power-of-two length through a half-length complex FFT; twiddles and the
+    // bit-reversal table are computed once per size.
+    class RealFFT {
+    private:
+        size_t n;
+        std::vector<std::complex<float>> twiddles;
+        std::vector<std::complex<float>> split;
+        std::vector<uint32_t> bitrev;
+
+    public:
+        explicit RealFFT(size_t n);
+
+        // Writes n/2 + 1 bins; work must hold n/2 values.
+        void forward(const float *, std::complex<float> * bins, std::complex<float> * work) const;
+        size_t size() const { return this->n; }
+    };
+
+    struct SpectrumConfig {
+        size_t fft_size = 256;
+        size_t hop = 128;
+        WindowType window = WindowType::HANN;
+        SpectrumOutput output = SpectrumOutput::MAGNITUDE;
+        std::vector<std::pair<float, float>> bands;
+        float fs = 0.0f;
+    };
+
+    // Sliding-window analyzer: every hop samples it emits a frame with the single-sided magnitude
+    // spectrum, or the mean-square power of each configured band, taken from one FFT.
+    class SpectrumAnalyzer {
+    private:
+        struct Plan {
+            SpectrumConfig config;
+            RealFFT fft;
+            std::vector<float> window;
+            std::vector<std::pair<uint32_t, uint32_t>> band_bins;
+            SpectrumOutput output;
+            size_t hop;
+            float magnitude_scale;
+            float power_scale;
+
+            Plan(const SpectrumConfig&);
+        };
+
+        std::shared_ptr<const Plan> plan;
+        std::pmr::vector<float> history;
+        size_t pos = 0;
+        size_t until_frame = 0;
+        uint64_t frame = 0;
+
+        SpectrumAnalyzer(std::shared_ptr<const Plan>, std::pmr::memory_resource *);
+        void emit(std::vector<uint8_t> &);
+
+    public:
+        explicit SpectrumAnalyzer(const SpectrumConfig&);
+
+        void push(const float *, size_t, std::vector<uint8_t> & frames);
+        void reset();
+        size_t state_bytes() const { return this->history.size() * sizeof(float) + 3 * sizeof(uint64_t); }
+        void save_state(std::vector<unsigned char> &) const;
+        const unsigned char * load_state(const unsigned char *);
+        SpectrumAnalyzer clone(std::pmr::memory_resource * = std::pmr::get_default_resource()) const;
+
+        const SpectrumConfig& config() const { return this->plan->config; }
+        size_t n_features() const;
+        size_t frame_bytes() const { return sizeof(FeatureFrameHeader) + this->n_features() * sizeof(float); }
+        size_t footprint() const { return sizeof(*this) + this->history.capacity() * sizeof(float); }
+    };
+
+}
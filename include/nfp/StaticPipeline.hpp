@@ -0,0 +1,269 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Pipelines fixed at build time: coefficients are designed by constexpr code that mirrors
+// DigitalFilter, so coeffs() matches the dynamic SignalPipeline layout, and processBlock
+// is a fold over concrete stage types with no virtual dispatch.
+//
+//     nfp::static_pipeline<nfp::lpf<1000, 10000, 4>, nfp::gain<2>, nfp::notch<50, 10000, 1>> p;
+//
+// Template parameters are integers (C++17 has no float non-type parameters): frequencies in Hz,
+// Q in thousandths and bandwidths / gains as a numerator over an optional denominator.
+
+namespace nfp {
+
+    namespace ct {
+        constexpr double PI = 3.14159265358979323846;
+        constexpr double LN2 = 0.69314718055994530942;
+
+        constexpr double floor(double x) {
+            auto i = static_cast<long long>(x);
+            return (static_cast<double>(i) > x) ? static_cast<double>(i - 1) : static_cast<double>(i);
+        }
+
+        constexpr double sin(double x) {
+            x -= 2 * PI * floor(x / (2 * PI) + 0.5);
+
+            double term = x, sum = x;
+            for (int k = 1; k < 20; ++k) {
+                term *= -x * x / ((2 * k) * (2 * k + 1));
+                sum += term;
+            }
+            return sum;
+        }
+
+        constexpr double cos(double x) { return ct::sin(x + PI / 2); }
+
+        constexpr double exp(double x) {
+            double k = floor(x / LN2 + 0.5);
+            double r = x - k * LN2;
+
+            double term = 1.0, sum = 1.0;
+            for (int i = 1; i < 20; ++i) {
+                term *= r / i;
+                sum += term;
+            }
+
+            for (; k > 0; --k) sum *= 2;
+            for (; k < 0; ++k) sum /= 2;
+            return sum;
+        }
+
+        constexpr double sinh(double x) { return (ct::exp(x) - ct::exp(-x)) / 2; }
+
+        // Same rounding as ConfigsParse's to_rad, so designs agree with the runtime path.
+        constexpr float to_rad(int fs, int f) {
+            return 2 * 3.14159265f * (static_cast<float>(f) / static_cast<float>(fs));
+        }
+
+        template<size_t N>
+        using Sections = std::array<float, 6 * N>;
+
+        constexpr std::array<float, 6> biquad_lpf(float w0, float Q) {
+            double alpha = ct::sin(w0) / (2 * Q), c = ct::cos(w0);
+            return {float(1 + alpha), float(-2 * c), float(1 - alpha), float((1 - c) / 2), float(1 - c), float((1 - c) / 2)};
+        }
+
+        constexpr std::array<float, 6> biquad_hpf(float w0, float Q) {
+            double alpha = ct::sin(w0) / (2 * Q), c = ct::cos(w0);
+            return {float(1 + alpha), float(-2 * c), float(1 - alpha), float((1 + c) / 2), float(-(1 + c)), float((1 + c) / 2)};
+        }
+
+        constexpr double bw_alpha(float w0, float BW) {
+            return ct::sin(w0) * ct::sinh(LN2 * BW * w0 / (2 * ct::sin(w0)));
+        }
+
+        // Folds the inverse of the cascade gain at DC (z = 1) or Nyquist (z = -1) into the first section.
+        template<size_t N>
+        constexpr void normalize(Sections<N> & cs, double z) {
+            double g = 1.0;
+            for (size_t s = 0; s < N; ++s) {
+                const float * c = &cs[6 * s];
+                g *= (c[3] + z * c[4] + c[5]) / (c[0] + z * c[1] + c[2] + 1e-8);
+            }
+            for (size_t i = 3; i < 6; ++i)
+                cs[i] = static_cast<float>(cs[i] / g);
+        }
+
+        // Butterworth Qs for Order > 2, highest Q first, as DigitalFilter::low_pass_filter sorts them.
+        template<int Order, bool HighPass>
+        constexpr Sections<Order / 2> butterworth(float w0, float Q) {
+            Sections<Order / 2> cs {};
+
+            for (int k = 0; k < Order / 2; ++k) {
+                float q = (Order == 2) ? Q : 1.0f / static_cast<float>(2 * ct::cos((2 * k + 1) * PI / (2 * Order)));
+                auto c = HighPass ? biquad_hpf(w0, q) : biquad_lpf(w0, q);
+                for (size_t i = 0; i < 6; ++i)
+                    cs[6 * (Order / 2 - 1 - k) + i] = c[i];
+            }
+
+            normalize<Order / 2>(cs, HighPass ? -1.0 : 1.0);
+            return cs;
+        }
+
+        template<size_t N>
+        constexpr std::array<float, 5 * N> direct_form(const Sections<N> & cs) {
+            std::array<float, 5 * N> ret {};
+            for (size_t s = 0; s < N; ++s) {
+                const float * c = &cs[6 * s];
+                ret[5*s] = c[1] / c[0];
+                ret[5*s+1] = c[2] / c[0];
+                ret[5*s+2] = c[3] / c[0];
+                ret[5*s+3] = c[4] / c[0];
+                ret[5*s+4] = c[5] / c[0];
+            }
+            return ret;
+        }
+    }
+
+    template<int Fc, int Fs, int Order = 2, int QMilli = 707>
+    struct lpf {
+        static_assert(Fs > 0 && Fc > 0 && 2 * Fc < Fs, "cutoff must lie in (0, Fs/2)");
+        static_assert(Order >= 2 && Order % 2 == 0 && Order < 255, "order must be a non-zero even integer < 255");
+
+        static constexpr size_t sections = Order / 2;
+        static constexpr ct::Sections<sections> coeffs = ct::butterworth<Order, false>(ct::to_rad(Fs, Fc), QMilli / 1000.0f);
+    };
+
+    template<int Fc, int Fs, int Order = 2, int QMilli = 707>
+    struct hpf {
+        static_assert(Fs > 0 && Fc > 0 && 2 * Fc < Fs, "cutoff must lie in (0, Fs/2)");
+        static_assert(Order >= 2 && Order % 2 == 0 && Order < 255, "order must be a non-zero even integer < 255");
+
+        static constexpr size_t sections = Order / 2;
+        static constexpr ct::Sections<sections> coeffs = ct::butterworth<Order, true>(ct::to_rad(Fs, Fc), QMilli / 1000.0f);
+    };
+
+    template<int F0, int Fs, int BWNum, int BWDen = 1>
+    struct notch {
+        static_assert(Fs > 0 && F0 > 0 && 2 * F0 < Fs, "center frequency must lie in (0, Fs/2)");
+        static_assert(BWNum > 0 && BWDen > 0, "bandwidth must be positive");
+
+        static constexpr size_t sections = 1;
+        static constexpr ct::Sections<1> coeffs = [] {
+            float w0 = ct::to_rad(Fs, F0);
+            double alpha = ct::bw_alpha(w0, static_cast<float>(BWNum) / BWDen), c = ct::cos(w0);
+            ct::Sections<1> cs {float(1 + alpha), float(-2 * c), float(1 - alpha), 1.0f, float(-2 * c), 1.0f};
+            ct::normalize<1>(cs, 1.0);
+            return cs;
+        }();
+    };
+
+    template<int F0, int Fs, int BWNum, int BWDen = 1>
+    struct bpf {
+        static_assert(Fs > 0 && F0 > 0 && 2 * F0 < Fs, "center frequency must lie in (0, Fs/2)");
+        static_assert(BWNum > 0 && BWDen > 0, "bandwidth must be positive");
+
+        static constexpr size_t sections = 1;
+        static constexpr ct::Sections<1> coeffs = [] {
+            float w0 = ct::to_rad(Fs, F0);
+            double alpha = ct::bw_alpha(w0, static_cast<float>(BWNum) / BWDen), c = ct::cos(w0);
+            ct::Sections<1> cs {float(1 + alpha), float(-2 * c), float(1 - alpha), float(alpha), 0.0f, float(-alpha)};
+
+            // Unity gain at the center frequency, as DigitalFilter normalizes band-pass filters.
+            double c1 = ct::cos(w0), s1 = ct::sin(w0), c2 = ct::cos(2 * w0), s2 = ct::sin(2 * w0);
+            double nr = cs[3] + cs[4] * c1 + cs[5] * c2, ni = cs[4] * s1 + cs[5] * s2;
+            double dr = cs[0] + cs[1] * c1 + cs[2] * c2 + 1e-8, di = cs[1] * s1 + cs[2] * s2;
+            double g2 = (nr * nr + ni * ni) / (dr * dr + di * di);
+
+            double g = 1.0;
+            for (int i = 0; i < 30; ++i)
+                g = (g + g2 / g) / 2;
+
+            for (size_t i = 3; i < 6; ++i)
+                cs[i] = static_cast<float>(cs[i] / g);
+            return cs;
+        }();
+    };
+
+    template<int Num, int Den = 1>
+    struct gain {
+        static_assert(Den != 0, "gain denominator must be non-zero");
+
+        static constexpr size_t sections = 1;
+        static constexpr float value = static_cast<float>(Num) / static_cast<float>(Den);
+        static constexpr ct::Sections<1> coeffs {1, 0, 0, value, 0, 0};
+    };
+
+    namespace ct {
+        template<typename Stage>
+        struct StageState {
+            static constexpr auto df = direct_form<Stage::sections>(Stage::coeffs);
+            std::array<float, 2 * Stage::sections> vs {};
+
+            template<size_t S>
+            float eval_section(float x) {
+                constexpr float a1 = df[5*S], a2 = df[5*S+1], b0 = df[5*S+2], b1 = df[5*S+3], b2 = df[5*S+4];
+
+                float v = x - a1 * this->vs[2*S] - a2 * this->vs[2*S+1];
+                float y = b0 * v + b1 * this->vs[2*S] + b2 * this->vs[2*S+1];
+
+                this->vs[2*S+1] = this->vs[2*S];
+                this->vs[2*S] = v;
+                return y;
+            }
+
+            template<size_t... S>
+            float eval(float x, std::index_sequence<S...>) { ((x = this->eval_section<S>(x)), ...); return x; }
+
+            float eval(float x) { return this->eval(x, std::make_index_sequence<Stage::sections>{}); }
+        };
+
+        template<int Num, int Den>
+        struct StageState<gain<Num, Den>> {
+            float eval(float x) { return gain<Num, Den>::value * x; }
+        };
+    }
+
+    template<typename... Stages>
+    class static_pipeline {
+    private:
+        std::tuple<ct::StageState<Stages>...> stages;
+
+    public:
+        static constexpr size_t n_sections = (Stages::sections + ... + 0);
+
+        static constexpr std::array<float, 6 * n_sections> coefficients() {
+            std::array<float, 6 * n_sections> ret {};
+            size_t i = 0;
+            ((void) [&] {
+                for (auto c : Stages::coeffs)
+                    ret[i++] = c;
+            }(), ...);
+            return ret;
+        }
+
+        std::vector<float> coeffs() const {
+            constexpr auto cs = coefficients();
+            return std::vector<float>(cs.begin(), cs.end());
+        }
+
+        void processBlock(const float * input, float * output, size_t n) {
+            // Work on a local copy so the state cannot alias the output and stays in registers.
+            auto st = this->stages;
+
+            for (size_t i = 0; i < n; ++i)
+                output[i] = std::apply([x = input[i]](auto &... s) mutable { ((x = s.eval(x)), ...); return x; }, st);
+
+            this->stages = st;
+        }
+
+        void processBlock(const std::vector<float> & input, std::vector<float> & output) {
+            output.resize(input.size());
+            this->processBlock(input.data(), output.data(), input.size());
+        }
+
+        float process(float x) {
+            return std::apply([x](auto &... s) mutable { ((x = s.eval(x)), ...); return x; }, this->stages);
+        }
+
+        void reset() { this->stages = {}; }
+        constexpr size_t footprint() const { return sizeof(*this); }
+    };
+
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+namespace nfp {
+
+    bool pin_current_thread(int cpu);
+    bool set_current_thread_fifo(int priority);
+    bool lock_process_memory();
+    bool flush_denormals_on_current_thread();
+
+}
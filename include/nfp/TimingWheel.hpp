@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace nfp {
+
+    // Hierarchical timing wheel over an abstract tick counter. Timers are identified by
+    // a 64-bit id; schedule and per-tick expiry are O(1) amortized.
+    class TimingWheel {
+    private:
+        static constexpr unsigned BITS = 6;
+        static constexpr unsigned SLOTS = 1u << BITS;
+        static constexpr unsigned LEVELS = 4;
+
+        struct Timer {
+            uint64_t id;
+            uint64_t expiry;
+        };
+
+        uint64_t now_tick = 0;
+        size_t count = 0;
+        std::array<std::array<std::vector<Timer>, SLOTS>, LEVELS> wheel;
+        std::vector<Timer> due;
+
+        void place(Timer t) {
+            if (t.expiry <= this->now_tick)
+                t.expiry = this->now_tick + 1;
+
+            uint64_t delta = t.expiry - this->now_tick;
+            unsigned level = 0;
+
+            while (level + 1 < LEVELS && delta >= (uint64_t{1} << (BITS * (level + 1))))
+                ++level;
+
+            if (level + 1 == LEVELS && delta >= (uint64_t{1} << (BITS * LEVELS)))
+                t.expiry = this->now_tick + (uint64_t{1} << (BITS * LEVELS)) - 1;
+
+            this->wheel[level][(t.expiry >> (BITS * level)) & (SLOTS - 1)].push_back(t);
+        }
+
+        void cascade(unsigned level) {
+            auto & slot = this->wheel[level][(this->now_tick >> (BITS * level)) & (SLOTS - 1)];
+            this->due.swap(slot);
+            slot.clear();
+
+            for (const auto & t : this->due) {
+                if (t.expiry <= this->now_tick)
+                    this->wheel[0][this->now_tick & (SLOTS - 1)].push_back(t);
+                else
+                    this->place(t);
+            }
+
+            this->due.clear();
+        }
+
+    public:
+        explicit TimingWheel(uint64_t start_tick = 0) : now_tick(start_tick) {}
+
+        void schedule(uint64_t id, uint64_t expiry_tick) {
+            this->place(Timer{id, expiry_tick});
+            ++this->count;
+        }
+
+        // Advances one tick at a time up to to_tick; on_expire(id) returns the next expiry
+        // tick for the timer, or 0 to drop it.
+        template<typename F> void advance(uint64_t to_tick, F on_expire) {
+            while (this->now_tick < to_tick) {
+                ++this->now_tick;
+
+                for (unsigned level = 1; level < LEVELS; ++level) {
+                    if ((this->now_tick & ((uint64_t{1} << (BITS * level)) - 1)) != 0)
+                        break;
+                    this->cascade(level);
+                }
+
+                auto & slot = this->wheel[0][this->now_tick & (SLOTS - 1)];
+                this->due.swap(slot);
+                slot.clear();
+
+                for (const auto & t : this->due) {
+                    uint64_t next = on_expire(t.id);
+
+                    if (next == 0)
+                        --this->count;
+                    else
+                        this->place(Timer{t.id, next});
+                }
+
+                this->due.clear();
+            }
+        }
+
+        uint64_t current_tick() const { return this->now_tick; }
+        size_t size() const { return this->count; }
+    };
+
+}
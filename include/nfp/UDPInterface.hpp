@@ -6,8 +6,14 @@
 #include <array>
 #include <bitset>
 #include <chrono>
-#include <unordered_map>
+#include <atomic>
 #include <nfp/SignalPipeline.hpp>
+#include <nfp/RouteTable.hpp>
+#include <nfp/ConnTable.hpp>
+#include <nfp/TimingWheel.hpp>
+#include <nfp/IngressQueue.hpp>
+#include <nfp/Mailbox.hpp>
+#include <nfp/OutputRing.hpp>
 #include <thread>
 #include <vector>
 #include <functional>
@@ -16,94 +22,255 @@ using boost::asio::ip::udp;
 using std::chrono::steady_clock;
 
 namespace nfp {
-    #pragma pack(push, 1)
-    struct Datagram{
-        std::uint64_t seq;
-        std::uint16_t out_port;
-        float data[128];
-    };
-    #pragma pack(pop)
-
-    enum class CONCEALMENT {REPEAT_LAST_GOOD, FADE_LAST_GOOD, ALL_ZERO};
-
     class UDPServer;
 
+    // Sends each block to the default destination (dest_ip, out-port) or to a route's sinks. Every
+    // multicast TTL/interface pair gets its own socket; sinks sharing a socket go out in one sendmmsg
+    // on Linux, all pointing at the same buffer.
     class UDPClient {
     private:
-        boost::asio::ip::udp::socket socket;
+        struct Channel {
+            uint8_t ttl;
+            uint32_t iface;
+            boost::asio::ip::udp::socket socket;
+        };
+
+        boost::asio::io_context & io_context;
+        std::vector<Channel> channels;
         boost::asio::ip::address_v4 dest_ip;
+        boost::asio::strand<boost::asio::io_context::executor_type> strand;
+
+        size_t channel_for(const nfp::Sink&) const;
+        size_t send_now(udp::socket&, const std::vector<udp::endpoint>&, boost::asio::const_buffer);
+        template<typename Fn> void each_channel(uint16_t, uint16_t, const std::vector<nfp::Sink>&, Fn&&);
+        void send_all(const std::shared_ptr<const void>&, boost::asio::const_buffer, uint16_t, uint16_t, const std::vector<nfp::Sink>&, bool wait);
 
     public:
-        UDPClient(boost::asio::io_context & io_context, const boost::asio::ip::address_v4 out_addr) 
-            : socket(io_context, udp::v4()), dest_ip(out_addr) {}
+        UDPClient(boost::asio::io_context &, const boost::asio::ip::address_v4 out_addr);
+
+        // Opens the sockets these sinks need; call before sending starts.
+        void add_sinks(const std::vector<nfp::Sink>&);
+
+        // Sink ports (or port, for sinks without one) are shifted by offset. The async form keeps
+        // owner alive until every send that couldn't complete at once has finished.
+        void async_send(std::shared_ptr<const void> owner, boost::asio::const_buffer, uint16_t port, uint16_t offset = 0, const std::vector<nfp::Sink>& = {});
+        void send(boost::asio::const_buffer, uint16_t port, uint16_t offset = 0, const std::vector<nfp::Sink>& = {});
 
-        void async_send(const std::vector<float>&, uint16_t);
+        #ifdef NFP_COROUTINES
+            boost::asio::awaitable<void> co_send(boost::asio::const_buffer, uint16_t port, uint16_t offset, const std::vector<nfp::Sink>&);
+        #endif
+
+        boost::asio::strand<boost::asio::io_context::executor_type>& get_executor() { return this->strand; }
         void close();
     };
 
+    // Collects a packet's output blocks instead of sending them; buffers are only valid during emit.
+    struct Outbox {
+        virtual void emit(boost::asio::const_buffer, uint16_t port, uint16_t offset, const std::vector<nfp::Sink>&) = 0;
+        virtual ~Outbox() = default;
+    };
+
+    struct IngressStats {
+        uint64_t dropped = 0;
+        uint64_t replaced = 0;
+        uint64_t read_pauses = 0;
+    };
+
+    // Connections running each quality tier, and how often connections changed tier.
+    struct TierStats {
+        std::vector<size_t> connections;
+        uint64_t downgrades = 0;
+        uint64_t upgrades = 0;
+    };
+
     class UDPWorker { 
+    public:
+        // Shards own the key space bucket by bucket; see move_bucket().
+        static constexpr size_t BUCKETS = 256;
+
     private:
         static constexpr int W = 32;
-        static constexpr auto default_timeout = std::chrono::seconds(10);
+        static constexpr unsigned DRAIN_BATCH = 32;
+        static constexpr unsigned TIER_HOLD = 10;
+        static constexpr float FADE_FACTOR = 0.8f;
+        static constexpr int16_t FADE_FACTOR_Q15 = static_cast<int16_t>(FADE_FACTOR * 32768);
         static inline const std::vector<float> ZERO_OUTPUT = std::vector<float>(128, 0);
+        static inline const std::vector<int16_t> ZERO_OUTPUT16 = std::vector<int16_t>(128, 0);
+        static inline const std::vector<nfp::Sink> NO_SINKS = {};
 
         CONCEALMENT loss_policy {CONCEALMENT::REPEAT_LAST_GOOD};
+        unsigned warm_up = 5;
+
+        struct Ingress {
+            Datagram pkg;
+            udp::endpoint src;
+            bool q15 = false;
+        };
+
+        // Packets wait in the ingress queue, guarded by ingress_mtx, until one drain task per shard
+        // takes them; the task holds mtx only while a packet is being filtered.
+        struct Shard {
+            std::mutex mtx;
+            nfp::ConnTable conns;
+            nfp::TimingWheel expiry_wheel;
 
-        struct ConnState {
-            bool is_ready = false;
-            std::array<Datagram, W> buffer {};
-            std::bitset<W> present {};
-            uint64_t expected_seq = 0;
-            bool initialized = false;
-            std::vector<float> last_good = std::vector<float>(128, 0);
-            uint16_t last_port = 55555;
-            std::vector<float> faded_last_good = std::vector<float>(128, 0);
-            nfp::SignalPipeline pipeline;
-            steady_clock::time_point last_arrive = steady_clock::now();
-            steady_clock::time_point deadline = steady_clock::time_point::max();
+            std::mutex ingress_mtx;
+            nfp::IngressQueue<Ingress> ingress;
+            bool draining = false;
+            std::vector<std::function<void()>> paused_readers;
+            IngressStats stats;
 
+            // Connection records handed over by other shards, restored under mtx before the
+            // shard filters anything.
+            nfp::Mailbox<std::vector<unsigned char>> inbox;
+
+            // Quality tier the shard's connections run, adapted to its load once per reap period.
+            std::atomic<uint64_t> busy_ns {0};
+            steady_clock::time_point window_start = steady_clock::now();
+            uint8_t tier = 0;
+            unsigned calm_windows = 0;
+            uint64_t downgrades = 0;
+            uint64_t upgrades = 0;
+
+            Shard(unsigned jitter_depth) : conns(jitter_depth) {}
         };
 
         std::function<nfp::SignalPipeline()> pipeline_factory;
-        std::unordered_map<uint64_t, ConnState> conns;
-        std::mutex conns_mtx;
+        std::shared_ptr<const nfp::RouteTable> routes;
+        std::vector<std::unique_ptr<Shard>> shards;
+        std::array<std::atomic<uint16_t>, BUCKETS> owners;
         boost::asio::thread_pool& thread_pool;
-        std::unique_ptr<UDPClient> client;
+        std::vector<std::unique_ptr<UDPClient>> clients;
+        // Per route; null for routes without a shared-memory output.
+        std::vector<std::shared_ptr<nfp::OutputRing>> shm_outputs;
+
+        nfp::PipelineGraph::ParallelFor graph_runner;
+        bool inline_send = false;
+        float silence_threshold = 0.0f;
+        bool suppress_silence = false;
+        nfp::OVERLOAD overload_policy = nfp::OVERLOAD::DROP_NEWEST;
+        bool pause_reads = true;
+        uint8_t max_tier = 0;
+        float tier_high = 0.9f;
+        float tier_low = 0.6f;
 
         boost::asio::steady_timer reap_timer;
-        std::chrono::milliseconds reap_period {15000};
+        std::chrono::milliseconds reap_period {100};
+        std::chrono::milliseconds conn_timeout {10000};
+        steady_clock::time_point epoch = steady_clock::now();
+        std::atomic<uint64_t> now_tick {0};
+        std::atomic<bool> manual_clock {false};
+
+        uint64_t timeout_ticks() const { return std::max<uint64_t>(1, this->conn_timeout / this->reap_period); }
 
+        // Bits the connection tables don't index with, so a shard's keys still spread over its table.
+        static size_t bucket_of(uint64_t key) { return ((key * 0x9E3779B97F4A7C15ull) >> 32) & (BUCKETS - 1); }
+        Shard& shard_of(uint64_t key) { return *this->shards[this->owners[bucket_of(key)].load(std::memory_order_acquire)]; }
+        Shard& lock_bucket(size_t bucket, std::unique_lock<std::mutex>&);
+        void accept_handoffs(Shard&);
+        void setup_conn(ConnState&, uint16_t route);
+        void save_conn(const ConnState&, std::vector<unsigned char>&) const;
+        const unsigned char * restore_conn(Shard&, const unsigned char *, const unsigned char *);
+        void drain(Shard&);
         void schedule_reap();
-        void reap_dead_conns();
+        void reap_dead_conns(steady_clock::time_point);
+        void adapt_tier(Shard&, steady_clock::time_point);
+        template<typename T> void dispatch_send(const std::vector<T>&, size_t block, uint16_t, const std::vector<nfp::Sink>&, uint16_t);
+        template<typename T> void emit(const std::vector<T>&, size_t block, uint16_t port, uint16_t route, uint16_t offset, Outbox *);
+        void process_pkg(Datagram&, const udp::endpoint&, bool, Outbox *);
 
         
     public:
-        UDPWorker(boost::asio::thread_pool& pool) : thread_pool(pool), reap_timer(pool.get_executor()) { this->schedule_reap(); }
-        void handle_pkg(Datagram, udp::endpoint);
-        void send_to_client(const std::vector<float>&, uint16_t);
-        void set_client(std::unique_ptr<UDPClient> client) {this->client = std::move(client); }
+        UDPWorker(boost::asio::thread_pool&, unsigned n_shards = 1, unsigned jitter_depth = W);
+        // Connection key of a source endpoint: its IPv4 address and port.
+        static uint64_t conn_key(const udp::endpoint&);
+        void handle_pkg(Datagram, udp::endpoint, bool q15 = false);
+        void handle_pkg(Datagram, udp::endpoint, bool q15, Outbox&);
+        bool enqueue(const Datagram&, const udp::endpoint&, bool q15, const std::function<void()>& resume);
+        void set_ingress(size_t capacity, nfp::OVERLOAD, bool pause_reads);
+        IngressStats ingress_stats();
+        // A shard busier than high of the time steps its connections down one tier; one below low
+        // for TIER_HOLD reap periods steps them back up.
+        void set_tier_load(float high, float low) { this->tier_high = high; this->tier_low = low; }
+        TierStats tier_stats();
+        void send_to_client(const std::vector<float>&, uint16_t, const std::vector<nfp::Sink>& = NO_SINKS, uint16_t offset = 0);
+        void send_to_client(const std::vector<int16_t>&, uint16_t, const std::vector<nfp::Sink>& = NO_SINKS, uint16_t offset = 0);
+        void send_to_client(const std::vector<uint8_t>&, uint16_t, const std::vector<nfp::Sink>& = NO_SINKS, uint16_t offset = 0);
+        void set_client(std::unique_ptr<UDPClient> client) { this->clients.clear(); this->add_client(std::move(client)); }
+        void add_client(std::unique_ptr<UDPClient> client) { this->clients.push_back(std::move(client)); }
         void set_concealment_policy(CONCEALMENT policy) { this-> loss_policy = policy; }
+        // Packets buffered before a new connection's first output; capped at the jitter depth.
+        void set_warm_up(unsigned packets) { this->warm_up = std::max(packets, 1u); }
         void set_pipeline_factory(std::function<nfp::SignalPipeline()> f) { this->pipeline_factory = f; }
+        void set_routes(std::shared_ptr<const nfp::RouteTable>);
+        void set_inline_send(bool v) { this->inline_send = v; }
+        void set_silence(float threshold, bool suppress) { this->silence_threshold = threshold; this->suppress_silence = suppress; }
+        void set_timeout(std::chrono::milliseconds timeout) { this->conn_timeout = timeout; }
+        std::chrono::milliseconds get_reap_period() const { return this->reap_period; }
+
+        // Hands time to the caller: the reap timer stops, the clock starts at epoch and moves only
+        // on tick(), and graph branches run on the calling thread. Call before any traffic.
+        void set_manual_clock(steady_clock::time_point epoch);
+        void tick(steady_clock::time_point now) { this->reap_dead_conns(now); }
         boost::asio::thread_pool& get_executor() { return this->thread_pool; }
+        size_t connection_bytes(const nfp::Route&) const;
+        size_t size();
+
+        // Connections keep their filter, concealment and jitter state across a move. Moving a bucket
+        // sends its connections to the new owner's mailbox, and rebalance() moves buckets from the
+        // busiest shard to the idlest while that evens out connection counts. A moved connection's
+        // packets still queued on the old shard may reach the filters out of order, which the
+        // jitter buffer absorbs.
+        size_t move_bucket(size_t bucket, unsigned to_shard);
+        size_t rebalance();
+        std::vector<size_t> shard_sizes();
+
+        // Whole table in the Snapshot.hpp format, restored by a worker with the same routes and
+        // jitter depth; set routes before restoring. Packets still queued aren't in the snapshot:
+        // stop receiving and wait_idle() first.
+        std::vector<unsigned char> save_connections();
+        size_t restore_connections(const unsigned char *, size_t);
+        void wait_idle();
         void stop();
         ~UDPWorker(){ this->stop(); }
     };
 
     class UDPServer : public std::enable_shared_from_this<UDPServer> {
     private:
+        static constexpr unsigned RECV_BATCH = 32;
+
         udp::socket socket;
         udp::endpoint remote_endpoint;
         Datagram rcv_package;
-        std::unique_ptr<UDPWorker> worker;
+        std::shared_ptr<UDPWorker> worker;
+        bool inline_dispatch = false;
+        std::function<void()> resume_reads;
 
         void start_receive();
 
+        #ifdef NFP_COROUTINES
+            boost::asio::awaitable<void> serve(std::shared_ptr<UDPClient>);
+        #endif
+
     public:
         UDPServer(boost::asio::io_context& io_context, int port) 
             : socket(io_context, udp::endpoint(udp::v4(), port)) {}
+        UDPServer(boost::asio::io_context&, int, bool reuse_port);
+
+        // Bound to port on every interface; reuse_port lets other sockets share it.
+        static udp::socket open_socket(boost::asio::io_context&, int port, bool reuse_port);
 
-        void set_worker(std::unique_ptr<UDPWorker> w) {worker = std::move(w); }
-        void start() { this->start_receive(); }
+        void set_worker(std::shared_ptr<UDPWorker> w) {worker = std::move(w); }
+        void set_inline_dispatch(bool v) { this->inline_dispatch = v; }
+        void start();
+        // Stops receiving; finish() also stops the worker.
+        void close();
         void finish();
+
+        #ifdef NFP_COROUTINES
+            // Alternative to start(): one coroutine awaits a datagram, takes whatever else is already
+            // queued, filters the batch in place and awaits its sends. No per-packet closures or copies.
+            void start_coroutine(std::shared_ptr<UDPClient>);
+        #endif
     }; 
 }
\ No newline at end of file
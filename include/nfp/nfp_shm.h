@@ -0,0 +1,42 @@
+#ifndef NFP_SHM_H
+#define NFP_SHM_H
+
+/* C API for reading a route's shared-memory output ("shm-output" in the config) on the same
+ * host. Link with -lnfpshm. Blocks are read in place: data points into the ring and stays valid
+ * until the writer comes round again, which nfp_shm_valid tells after the block was used. */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct nfp_shm_reader nfp_shm_reader;
+
+enum nfp_shm_format { NFP_SHM_FLOAT32 = 0, NFP_SHM_INT16 = 1, NFP_SHM_FRAMES = 2 };
+
+typedef struct {
+    uint64_t seq;
+    uint16_t port;
+    uint16_t format;
+    uint32_t bytes;
+    const void * data;
+} nfp_shm_block;
+
+/* Opens the ring of that name, as in the config; NULL if there is none. */
+nfp_shm_reader * nfp_shm_open(const char * name);
+void nfp_shm_close(nfp_shm_reader * reader);
+
+/* Waits up to timeout_ms (-1 for ever) for the next block: 1 with a block, 0 on timeout, -1 once
+ * the writer has gone. */
+int nfp_shm_next(nfp_shm_reader * reader, nfp_shm_block * block, int timeout_ms);
+int nfp_shm_valid(const nfp_shm_reader * reader, const nfp_shm_block * block);
+
+/* Blocks overwritten before this reader got to them. */
+uint64_t nfp_shm_lost(const nfp_shm_reader * reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,5 +1,6 @@
 #include <nfp/BiquadFilter.hpp>
 #include <math.h>
+#include <cstring>
 
 using nfp::BiquadFilter;
 using std::vector;
@@ -109,3 +110,17 @@ void BiquadFilter::processBlock(const vector<float> & input, vector<float> & out
 void BiquadFilter::reset() {
     this->vs = {0.0f, 0.0f};
 }
+
+bool BiquadFilter::quiescent(float threshold) const {
+    return fabsf(this->vs[0]) < threshold && fabsf(this->vs[1]) < threshold;
+}
+
+void BiquadFilter::save_state(vector<unsigned char> & out) const {
+    const auto * p = reinterpret_cast<const unsigned char *>(this->vs.data());
+    out.insert(out.end(), p, p + sizeof(this->vs));
+}
+
+const unsigned char * BiquadFilter::load_state(const unsigned char * in) {
+    std::memcpy(this->vs.data(), in, sizeof(this->vs));
+    return in + sizeof(this->vs);
+}
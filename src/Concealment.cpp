@@ -0,0 +1,271 @@
+#include <nfp/Concealment.hpp>
+#include <nfp/Kernels.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+using nfp::Concealer;
+
+// Eight partial sums so the reduction vectorizes without reassociation flags.
+static float dot(const float * a, const float * b, size_t n) {
+    float acc[8] = {};
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        for (size_t k = 0; k < 8; ++k)
+            acc[k] += a[i + k] * b[i + k];
+
+    for (; i < n; ++i)
+        acc[0] += a[i] * b[i];
+
+    return ((acc[0] + acc[4]) + (acc[1] + acc[5])) + ((acc[2] + acc[6]) + (acc[3] + acc[7]));
+}
+
+float nfp::levinson_durbin(const float * r, float * a, size_t order) {
+    constexpr size_t MAX_ORDER = 64;
+
+    if (order > MAX_ORDER)
+        throw std::runtime_error("LPC order must be <= 64!");
+
+    std::fill(a, a + order, 0.0f);
+    float err = r[0];
+
+    if (err <= 0.0f)
+        return 0.0f;
+
+    float prev[MAX_ORDER];
+
+    for (size_t i = 0; i < order; ++i) {
+        float acc = r[i + 1];
+        for (size_t j = 0; j < i; ++j)
+            acc -= a[j] * r[i - j];
+
+        const float k = acc / err;
+        std::copy(a, a + i, prev);
+
+        a[i] = k;
+        for (size_t j = 0; j < i; ++j)
+            a[j] = prev[j] - k * prev[i - 1 - j];
+
+        err *= 1.0f - k * k;
+        if (err <= 0.0f)
+            break;
+    }
+
+    return std::max(err, 0.0f);
+}
+
+Concealer::Concealer(MODEL m, std::pmr::memory_resource * resource)
+    : model(m), buffer(HISTORY + BLOCK + OVERLAP + ORDER + HISTORY / DECIMATION, 0.0f, resource) {}
+
+void Concealer::reset() {
+    std::fill(this->buffer.begin(), this->buffer.end(), 0.0f);
+    this->period = 0;
+    this->lost = 0;
+}
+
+void Concealer::save_state(std::vector<unsigned char> & out) const {
+    const uint32_t counters[2] = {this->period, this->lost};
+    const auto * h = reinterpret_cast<const unsigned char *>(this->buffer.data());
+    const auto * rest = reinterpret_cast<const unsigned char *>(this->buffer.data() + HISTORY + BLOCK + OVERLAP);
+    const auto * c = reinterpret_cast<const unsigned char *>(counters);
+
+    out.insert(out.end(), h, h + HISTORY * sizeof(float));
+    out.insert(out.end(), rest, rest + (ORDER + HISTORY / DECIMATION) * sizeof(float));
+    out.insert(out.end(), c, c + sizeof(counters));
+}
+
+const unsigned char * Concealer::load_state(const unsigned char * in) {
+    uint32_t counters[2];
+    std::memcpy(this->history(), in, HISTORY * sizeof(float));
+    in += HISTORY * sizeof(float);
+    std::memcpy(this->coeffs(), in, (ORDER + HISTORY / DECIMATION) * sizeof(float));
+    in += (ORDER + HISTORY / DECIMATION) * sizeof(float);
+    std::memcpy(counters, in, sizeof(counters));
+
+    this->period = counters[0];
+    this->lost = counters[1];
+    return in + sizeof(counters);
+}
+
+// Best lag in [lo, hi] by normalized cross-correlation of the last n samples of x against the
+// same window lagged, sliding the lagged window's energy instead of recomputing it.
+static size_t best_lag(const float * x, size_t len, size_t n, size_t lo, size_t hi, float & score) {
+    const float * target = x + len - n;
+    const float e_target = dot(target, target, n);
+
+    const float * lagged = target - lo;
+    float e_lagged = dot(lagged, lagged, n);
+    size_t best = 0;
+
+    for (size_t t = lo; t <= hi; ++t) {
+        lagged = target - t;
+
+        if (t > lo)
+            e_lagged = std::max(0.0f, e_lagged + lagged[0] * lagged[0] - lagged[n] * lagged[n]);
+
+        const float c = dot(target, lagged, n);
+        const float norm = std::sqrt(e_target * e_lagged);
+
+        if (c > 0.0f && norm > 0.0f && c > score * norm) {
+            score = c / norm;
+            best = t;
+        }
+    }
+
+    return best;
+}
+
+// Coarse search on the decimated history, then a few full-rate lags around it.
+unsigned Concealer::find_period() {
+    constexpr size_t D = DECIMATION;
+    float coarse_score = 0.0f;
+    const size_t coarse = best_lag(this->decimated(), HISTORY / D, BLOCK / D, MIN_PERIOD / D, MAX_PERIOD / D, coarse_score);
+
+    if (!coarse)
+        return 0;
+
+    const size_t lo = std::max(MIN_PERIOD, coarse * D - (D - 1));
+    const size_t hi = std::min(MAX_PERIOD, coarse * D + (D - 1));
+    float score = MIN_VOICING;
+
+    return static_cast<unsigned>(best_lag(this->history(), HISTORY, BLOCK, lo, hi, score));
+}
+
+static const float * hann_window() {
+    static const std::vector<float> w = [] {
+        std::vector<float> v(Concealer::HISTORY);
+        for (size_t i = 0; i < v.size(); ++i)
+            v[i] = 0.5f - 0.5f * std::cos(2.0f * 3.14159265f * (static_cast<float>(i) + 0.5f) / v.size());
+        return v;
+    }();
+
+    return w.data();
+}
+
+void Concealer::fit() {
+    this->period = this->model == MODEL::PITCH ? this->find_period() : 0;
+
+    if (this->period)
+        return;
+
+    const float * x = this->history();
+    const float * hann = hann_window();
+    float w[HISTORY];
+
+    for (size_t i = 0; i < HISTORY; ++i)
+        w[i] = hann[i] * x[i];
+
+    float r[ORDER + 1];
+    for (size_t k = 0; k <= ORDER; ++k)
+        r[k] = dot(w, w + k, HISTORY - k);
+
+    // About 40 dB of white-noise correction keeps the recursion well conditioned on pure tones.
+    r[0] *= 1.0001f;
+
+    float a[ORDER];
+    nfp::levinson_durbin(r, a, ORDER);
+
+    // Stored oldest-first so each prediction is one forward dot product.
+    float * c = this->coeffs();
+    for (size_t k = 0; k < ORDER; ++k)
+        c[k] = a[ORDER - 1 - k];
+}
+
+// Continues the model for n samples right after the history.
+void Concealer::synthesize(size_t n) {
+    float * out = this->history() + HISTORY;
+
+    if (this->period) {
+        for (size_t i = 0; i < n; ) {
+            const size_t k = std::min<size_t>(n - i, this->period);
+            std::memcpy(out + i, out + i - this->period, k * sizeof(float));
+            i += k;
+        }
+        return;
+    }
+
+    // A decaying predictor would otherwise run into denormals.
+    const float * c = this->coeffs();
+    for (size_t i = 0; i < n; ++i) {
+        const float y = dot(c, out + i - ORDER, ORDER);
+        out[i] = std::fabs(y) < 1e-20f ? 0.0f : y;
+    }
+}
+
+// The block right after the history joins it, and its decimated copy joins the decimated history;
+// the oldest block leaves both.
+void Concealer::push(const float * block) {
+    constexpr size_t D = DECIMATION;
+    float * x = this->history();
+    float * d = this->decimated();
+
+    if (block != x + HISTORY)
+        std::memcpy(x + HISTORY, block, BLOCK * sizeof(float));
+
+    std::memmove(x, x + BLOCK, HISTORY * sizeof(float));
+    std::memmove(d, d + BLOCK / D, (HISTORY - BLOCK) / D * sizeof(float));
+
+    const float * added = x + HISTORY - BLOCK;
+    float * tail = d + (HISTORY - BLOCK) / D;
+
+    for (size_t i = 0; i < BLOCK / D; ++i) {
+        float sum = 0.0f;
+        for (size_t k = 0; k < D; ++k)
+            sum += added[D * i + k];
+        tail[i] = sum / D;
+    }
+}
+
+// Full level for the first lost block, then a linear fade of FADE_PER_BLOCK per block.
+float Concealer::gain(size_t n) const {
+    if (this->lost <= 1)
+        return 1.0f;
+
+    const float start = 1.0f - FADE_PER_BLOCK * static_cast<float>(this->lost - 2);
+    return std::max(0.0f, start - FADE_PER_BLOCK * static_cast<float>(n) / BLOCK);
+}
+
+void Concealer::conceal(float * block) {
+    if (this->lost == 0)
+        this->fit();
+
+    ++this->lost;
+
+    // Faded out: the model has nothing left to add.
+    if (this->gain(0) == 0.0f) {
+        std::fill(block, block + BLOCK, 0.0f);
+        this->push(block);
+        return;
+    }
+
+    this->synthesize(BLOCK);
+
+    // gain(i) as a ramp; the step is a power of two apart from FADE_PER_BLOCK, so it rounds the same.
+    const float * synth = this->history() + HISTORY;
+    const bool fading = this->lost > 1;
+    nfp::kernels().fade(synth, block, BLOCK, this->gain(0), fading ? FADE_PER_BLOCK / BLOCK : 0.0f);
+
+    // The unfaded continuation becomes history, so the next lost block picks up where this one ends.
+    this->push(synth);
+}
+
+bool Concealer::receive(float * block) {
+    bool faded = false;
+
+    if (this->lost) {
+        this->synthesize(OVERLAP);
+
+        const float * synth = this->history() + HISTORY;
+        const float g = this->gain(BLOCK);
+
+        nfp::kernels().crossfade(synth, block, OVERLAP, OVERLAP + 1, g);
+
+        this->lost = 0;
+        faded = true;
+    }
+
+    this->push(block);
+    return faded;
+}
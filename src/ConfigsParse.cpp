@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <cctype>
 #include <algorithm>
+#include <boost/asio/ip/address_v4.hpp>
 
 json nfp::load_config_file(const std::string& fp) {
     std::ifstream f{fp};
@@ -31,7 +32,7 @@ static std::string lower_string(const std::string& str) {
 }
 
 static std::string element_type_consistency(const std::string& type) {
-    static const std::unordered_set<std::string> valid_types = {"low-pass", "high-pass", "band-pass", "notch", "gain"};
+    static const std::unordered_set<std::string> valid_types = {"low-pass", "high-pass", "band-pass", "notch", "gain", "spectrum"};
     
     auto lowerc_type = std::move(lower_string(type));
     auto it = valid_types.find(lowerc_type);
@@ -70,6 +71,105 @@ static bool requires_gain(const std::string& type) {
     return lower_string(type) == "gain";
 }
 
+static float positive_number_from(const json& j, const std::string& key, const std::string& what) {
+    if (!j.contains(key) || !j[key].is_number())
+        throw std::runtime_error(what + " must be a number!");
+
+    float v = j[key].get<float>();
+
+    if (v <= 0.0f)
+        throw std::runtime_error(what + " must be a non-zero positive number!");
+
+    return v;
+}
+
+static nfp::WindowType window_chk(const std::string& window) {
+    static const std::unordered_map<std::string, nfp::WindowType> conv = {
+        {"rectangular", nfp::WindowType::RECTANGULAR},
+        {"hann", nfp::WindowType::HANN},
+        {"hamming", nfp::WindowType::HAMMING}
+    };
+
+    auto it = conv.find(window);
+
+    if (it == conv.end())
+        throw std::runtime_error(window + " is not a valid window!");
+
+    return it->second;
+}
+
+static void parse_spectrum(const json& j, nfp::PElement_info& f_info) {
+    if (j.contains("fft-size")) {
+        if (!j["fft-size"].is_number_unsigned())
+            throw std::runtime_error("Spectrum FFT size must be a positive integer!");
+
+        unsigned n = j["fft-size"].get<unsigned>();
+
+        if (n < 16 || n > 8192 || (n & (n - 1)) != 0)
+            throw std::runtime_error("Spectrum FFT size must be a power of two between 16 and 8192!");
+
+        f_info.fft_size = n;
+    }
+
+    f_info.hop = std::min(f_info.hop, f_info.fft_size);
+
+    if (j.contains("hop")) {
+        if (!j["hop"].is_number_unsigned() || j["hop"].get<unsigned>() == 0 || j["hop"].get<unsigned>() > f_info.fft_size)
+            throw std::runtime_error("Spectrum hop must be an integer between 1 and the FFT size!");
+
+        f_info.hop = j["hop"].get<unsigned>();
+    }
+
+    if (j.contains("window")) {
+        if (!j["window"].is_string())
+            throw std::runtime_error("Spectrum window must be a string!");
+
+        f_info.window = lower_string(j["window"].get<std::string>());
+        window_chk(f_info.window);
+    }
+
+    if (j.contains("output")) {
+        if (!j["output"].is_string() || (j["output"] != "magnitude" && j["output"] != "bands"))
+            throw std::runtime_error("Spectrum output must be magnitude or bands!");
+
+        f_info.spectrum_output = j["output"].get<std::string>();
+    }
+
+    if (f_info.spectrum_output == "bands") {
+        if (!j.contains("bands") || !j["bands"].is_array() || j["bands"].empty())
+            throw std::runtime_error("Spectrum band output must have a non-empty bands array!");
+
+        for (const auto& band : j["bands"]) {
+            if (!band.is_array() || band.size() != 2 || !band[0].is_number() || !band[1].is_number())
+                throw std::runtime_error("Each spectrum band must be a [low, high] pair in Hz!");
+
+            float lo = band[0].get<float>(), hi = band[1].get<float>();
+
+            if (lo < 0.0f || hi <= lo)
+                throw std::runtime_error("Spectrum bands must satisfy 0 <= low < high!");
+
+            f_info.bands.emplace_back(lo, hi);
+        }
+    }
+}
+
+static nfp::FilterFamily filter_family_chk(const std::string& family) {
+    static const std::unordered_map<std::string, nfp::FilterFamily> conv = {
+        {"auto", nfp::FilterFamily::AUTO},
+        {"butterworth", nfp::FilterFamily::BUTTERWORTH},
+        {"chebyshev1", nfp::FilterFamily::CHEBYSHEV1},
+        {"chebyshev2", nfp::FilterFamily::CHEBYSHEV2},
+        {"elliptic", nfp::FilterFamily::ELLIPTIC}
+    };
+
+    auto it = conv.find(family);
+
+    if (it == conv.end())
+        throw std::runtime_error(family + " is not a valid filter family!");
+
+    return it->second;
+}
+
 void nfp::from_json(const json& j, nfp::PElement_info& f_info) {
     if (!j.is_object()) 
         throw std::runtime_error("Filter must be a JSON Object!");
@@ -135,7 +235,40 @@ void nfp::from_json(const json& j, nfp::PElement_info& f_info) {
         f_info.BW = bw;
     }
 
-    if (requires_order(f_info.type) && !j.contains("order"))
+    if (j.contains("pass-freq") || j.contains("stop-freq")) {
+        if (!requires_order(f_info.type))
+            throw std::runtime_error("Only low-pass and high-pass filters can be designed from edges!");
+
+        f_info.pass_freq = positive_number_from(j, "pass-freq", "Filter's pass edge");
+        f_info.stop_freq = positive_number_from(j, "stop-freq", "Filter's stop edge");
+
+        if (f_info.type == "low-pass" ? f_info.pass_freq >= f_info.stop_freq : f_info.pass_freq <= f_info.stop_freq)
+            throw std::runtime_error("Filter " + f_info.type + " has its pass and stop edges swapped!");
+
+        if (j.contains("ripple"))
+            f_info.ripple = positive_number_from(j, "ripple", "Filter's passband ripple");
+
+        if (j.contains("attenuation"))
+            f_info.attenuation = positive_number_from(j, "attenuation", "Filter's stopband attenuation");
+
+        if (f_info.attenuation <= f_info.ripple)
+            throw std::runtime_error("Filter's attenuation must be greater than its ripple!");
+
+        if (j.contains("family")) {
+            if (!j["family"].is_string())
+                throw std::runtime_error("Filter's family must be a string!");
+
+            f_info.family = lower_string(j["family"].get<std::string>());
+            filter_family_chk(f_info.family);
+        }
+
+        f_info.by_spec = true;
+    }
+
+    if (f_info.type == "spectrum")
+        parse_spectrum(j, f_info);
+
+    if (requires_order(f_info.type) && !f_info.by_spec && !j.contains("order"))
         throw std::runtime_error("Filter " + f_info.type + " must have an order!");
 
     if (requires_bw(f_info.type) && !j.contains("BW"))
@@ -144,14 +277,12 @@ void nfp::from_json(const json& j, nfp::PElement_info& f_info) {
     if (requires_gain(f_info.type) && !j.contains("gain"))
         throw std::runtime_error("Element " + f_info.type + " must have a gain!");
 
-    if (requires_cutoff(f_info.type) && !j.contains("cut-freq"))
+    if (requires_cutoff(f_info.type) && !f_info.by_spec && !j.contains("cut-freq"))
         throw std::runtime_error("Filter " + f_info.type + " must have a cutoff frequency!");
 
 }
 
-std::vector<nfp::PElement_info> nfp::parse_pipeline_from(const json& j) {
-    const json arr = j.value("pipeline", json::array());
-
+static std::vector<nfp::PElement_info> parse_elements(const json& arr) {
     if (!arr.is_array())
         throw std::runtime_error("Pipeline must be an array!");
         
@@ -160,7 +291,7 @@ std::vector<nfp::PElement_info> nfp::parse_pipeline_from(const json& j) {
 
     for (int i = 0; i < arr.size(); i++) {
         try {
-            out.push_back(arr.at(i).get<PElement_info>());
+            out.push_back(arr.at(i).get<nfp::PElement_info>());
         } catch (const std::exception& err) {
             throw std::runtime_error("Element Error[" + std::to_string(i)+ "]: " + std::string(err.what()));
         }
@@ -169,11 +300,17 @@ std::vector<nfp::PElement_info> nfp::parse_pipeline_from(const json& j) {
     return out;
 }
 
+std::vector<nfp::PElement_info> nfp::parse_pipeline_from(const json& j) {
+    return parse_elements(j.value("pipeline", json::array()));
+}
+
 static nfp::CONCEALMENT concealment_policy_chk(std::string policy) {
     static const std::unordered_map<std::string, nfp::CONCEALMENT> conv = {
         {"REPEAT_LAST_GOOD", nfp::CONCEALMENT::REPEAT_LAST_GOOD},
         {"FADE_LAST_GOOD", nfp::CONCEALMENT::FADE_LAST_GOOD},
-        {"ALL_ZERO", nfp::CONCEALMENT::ALL_ZERO}
+        {"ALL_ZERO", nfp::CONCEALMENT::ALL_ZERO},
+        {"LPC_EXTRAPOLATION", nfp::CONCEALMENT::LPC_EXTRAPOLATION},
+        {"PITCH_REPETITION", nfp::CONCEALMENT::PITCH_REPETITION}
     };
 
     auto it = conv.find(policy);
@@ -184,6 +321,99 @@ static nfp::CONCEALMENT concealment_policy_chk(std::string policy) {
     return it->second;    
 }
 
+static std::vector<nfp::Sink> sinks_from(const json& j) {
+    if (!j.is_array() || j.empty())
+        throw std::runtime_error("Sinks must be a non-empty array!");
+
+    auto address_from = [](const json& s, const std::string& key) {
+        if (!s[key].is_string())
+            throw std::runtime_error("Sink's " + key + " must be a string!");
+
+        boost::system::error_code ec;
+        auto addr = boost::asio::ip::make_address_v4(s[key].get<std::string>(), ec);
+
+        if (ec)
+            throw std::runtime_error(s[key].get<std::string>() + " is not a valid IPV4 address!");
+
+        return addr;
+    };
+
+    std::vector<nfp::Sink> sinks;
+
+    for (const auto& s : j) {
+        if (!s.is_object() || !s.contains("addrv4"))
+            throw std::runtime_error("Sink must be a JSON Object with an addrv4!");
+
+        nfp::Sink sink;
+        auto addr = address_from(s, "addrv4");
+        sink.addr = addr.to_uint();
+
+        if (s.contains("port")) {
+            if (!s["port"].is_number_unsigned() || s["port"].get<uint64_t>() == 0 || s["port"].get<uint64_t>() > UINT16_MAX)
+                throw std::runtime_error("Sink's port must be an integer between 1 and 65535!");
+
+            sink.port = s["port"].get<uint16_t>();
+        }
+
+        if (s.contains("ttl") || s.contains("interface")) {
+            if (!addr.is_multicast())
+                throw std::runtime_error("Sink's ttl and interface only apply to multicast groups!");
+
+            if (s.contains("ttl")) {
+                if (!s["ttl"].is_number_unsigned() || s["ttl"].get<uint64_t>() > 255)
+                    throw std::runtime_error("Sink's ttl must be an integer <= 255!");
+
+                sink.ttl = s["ttl"].get<uint8_t>();
+            }
+
+            if (s.contains("interface"))
+                sink.iface = address_from(s, "interface").to_uint();
+        }
+
+        sinks.push_back(sink);
+    }
+
+    return sinks;
+}
+
+// A name alone, or {"name", "slots", "udp"}.
+static nfp::ShmOutput shm_output_from(const json& j) {
+    nfp::ShmOutput shm;
+    const json& name = j.is_object() ? j.value("name", json()) : j;
+
+    if (!name.is_string())
+        throw std::runtime_error("shm-output must be a name or a JSON Object with a name!");
+
+    shm.name = name.get<std::string>();
+
+    const bool valid_name = !shm.name.empty() && shm.name.size() <= 64 && std::all_of(shm.name.begin(), shm.name.end(),
+        [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_'; });
+
+    if (!valid_name)
+        throw std::runtime_error("shm-output name must be 1 to 64 letters, digits, - or _!");
+
+    if (!j.is_object())
+        return shm;
+
+    if (j.contains("slots")) {
+        const json& slots = j["slots"];
+
+        if (!slots.is_number_unsigned() || slots.get<uint64_t>() < 2 || slots.get<uint64_t>() > 65536 || (slots.get<uint64_t>() & (slots.get<uint64_t>() - 1)) != 0)
+            throw std::runtime_error("shm-output slots must be a power of two between 2 and 65536!");
+
+        shm.slots = slots.get<uint32_t>();
+    }
+
+    if (j.contains("udp")) {
+        if (!j["udp"].is_boolean())
+            throw std::runtime_error("shm-output udp must be a boolean!");
+
+        shm.udp = j["udp"].get<bool>();
+    }
+
+    return shm;
+}
+
 void nfp::from_json(const json& j, nfp::Conn_info& conn_info) {
 
     if (!j.contains("server-port") || !j["server-port"].is_number_unsigned())
@@ -210,7 +440,63 @@ void nfp::from_json(const json& j, nfp::Conn_info& conn_info) {
         throw std::runtime_error("Server must have a string concealment policy!");
 
     conn_info.policy = concealment_policy_chk(j["concealment-policy"]);
-    
+
+    if (j.contains("jitter-depth")) {
+        if (!j["jitter-depth"].is_number_unsigned())
+            throw std::runtime_error("Jitter depth must be a positive integer!");
+
+        unsigned depth = j["jitter-depth"].get<unsigned>();
+
+        if (depth == 0 || depth > 32 || (depth & (depth - 1)) != 0)
+            throw std::runtime_error("Jitter depth must be a power of two <= 32!");
+
+        conn_info.jitter_depth = depth;
+    }
+
+    if (j.contains("warm-up")) {
+        if (!j["warm-up"].is_number_unsigned() || j["warm-up"].get<uint64_t>() == 0)
+            throw std::runtime_error("Warm-up must be a positive integer number of packets!");
+
+        if (j["warm-up"].get<uint64_t>() > conn_info.jitter_depth)
+            throw std::runtime_error("Warm-up can't exceed the jitter depth!");
+
+        conn_info.warm_up = j["warm-up"].get<unsigned>();
+    }
+
+    if (j.contains("conn-timeout-ms")) {
+        if (!j["conn-timeout-ms"].is_number_unsigned() || j["conn-timeout-ms"].get<uint64_t>() == 0 ||
+            j["conn-timeout-ms"].get<uint64_t>() > UINT32_MAX)
+            throw std::runtime_error("Connection timeout must be a non-zero integer number of milliseconds!");
+
+        conn_info.conn_timeout_ms = j["conn-timeout-ms"].get<uint32_t>();
+    }
+
+    if (j.contains("arithmetic")) {
+        if (!j["arithmetic"].is_string() || (j["arithmetic"] != "float" && j["arithmetic"] != "fixed"))
+            throw std::runtime_error("Arithmetic must be float or fixed!");
+
+        conn_info.fixed_point = j["arithmetic"] == "fixed";
+    }
+
+    if (j.contains("silence-threshold")) {
+        if (!j["silence-threshold"].is_number() || j["silence-threshold"].get<float>() < 0.0f || j["silence-threshold"].get<float>() >= 1.0f)
+            throw std::runtime_error("Silence threshold must be a number in [0, 1)!");
+
+        conn_info.silence_threshold = j["silence-threshold"].get<float>();
+    }
+
+    if (j.contains("silence-action")) {
+        if (!j["silence-action"].is_string() || (j["silence-action"] != "zero" && j["silence-action"] != "suppress"))
+            throw std::runtime_error("Silence action must be zero or suppress!");
+
+        conn_info.suppress_silence = j["silence-action"] == "suppress";
+    }
+
+    if (j.contains("sinks"))
+        conn_info.sinks = sinks_from(j["sinks"]);
+
+    if (j.contains("shm-output"))
+        conn_info.shm = shm_output_from(j["shm-output"]);
 }
 
 nfp::Conn_info nfp::parse_conn_from(const json& j) {
@@ -229,17 +515,32 @@ nfp::Conn_info nfp::parse_conn_from(const json& j) {
 nfp::SignalPipeline nfp::build_pipeline(const std::vector<PElement_info>& pelements, float fs) {
     nfp::SignalPipeline pipeline;
 
-    enum _Elements{GAIN, LOW_PASS, HIGH_PASS, BAND_PASS, NOTCH}; 
+    enum _Elements{GAIN, LOW_PASS, HIGH_PASS, BAND_PASS, NOTCH, SPECTRUM}; 
     
     static const std::unordered_map<std::string, _Elements> strtype2enum = {
-        {"gain", GAIN}, {"low-pass", LOW_PASS}, {"high-pass", HIGH_PASS}, {"band-pass", BAND_PASS}, {"notch", NOTCH}     
+        {"gain", GAIN}, {"low-pass", LOW_PASS}, {"high-pass", HIGH_PASS}, {"band-pass", BAND_PASS}, {"notch", NOTCH},
+        {"spectrum", SPECTRUM}
     };
 
-    constexpr float PI = 3.14156f;
+    constexpr float PI = 3.14159265f;
 
     auto to_rad = [PI](const float _fs, const float _fc) {return 2 * PI * (_fc / _fs); };
 
     for (const auto& pelement: pelements) {
+        if (pipeline.get_spectrum())
+            throw std::runtime_error("Spectrum must be the last element of a pipeline!");
+
+        if (pelement.by_spec) {
+            if (pelement.pass_freq >= fs / 2 || pelement.stop_freq >= fs / 2)
+                throw std::runtime_error("Filter " + pelement.type + " edges must be below half the sampling frequency!");
+
+            pipeline.add_digital_filter(nfp::design_filter(
+                nfp::FilterSpec{to_rad(fs, pelement.pass_freq), to_rad(fs, pelement.stop_freq), pelement.ripple, pelement.attenuation},
+                filter_family_chk(pelement.family)
+            ));
+            continue;
+        }
+
         switch (strtype2enum.at(pelement.type)) {
             case GAIN:
                 pipeline.add_gain(pelement.gain);
@@ -270,6 +571,17 @@ nfp::SignalPipeline nfp::build_pipeline(const std::vector<PElement_info>& peleme
                     pelement.BW
                 ));
                 break;
+            case SPECTRUM: {
+                nfp::SpectrumConfig cfg;
+                cfg.fft_size = pelement.fft_size;
+                cfg.hop = pelement.hop;
+                cfg.window = window_chk(pelement.window);
+                cfg.output = pelement.spectrum_output == "bands" ? nfp::SpectrumOutput::BANDS : nfp::SpectrumOutput::MAGNITUDE;
+                cfg.bands = pelement.bands;
+                cfg.fs = fs;
+                pipeline.set_spectrum(nfp::SpectrumAnalyzer(cfg));
+                break;
+            }
         
         default:
             break;
@@ -277,4 +589,686 @@ nfp::SignalPipeline nfp::build_pipeline(const std::vector<PElement_info>& peleme
     }
 
     return pipeline;
-}  
\ No newline at end of file
+}
+
+std::map<std::string, std::vector<nfp::PElement_info>> nfp::parse_named_pipelines_from(const json& j) {
+    const json obj = j.value("pipelines", json::object());
+
+    if (!obj.is_object())
+        throw std::runtime_error("Named pipelines must be a JSON Object!");
+
+    std::map<std::string, std::vector<nfp::PElement_info>> out;
+
+    for (const auto& [name, arr] : obj.items()) {
+        try {
+            out.emplace(name, parse_elements(arr));
+        } catch (const std::exception& err) {
+            throw std::runtime_error("Pipeline " + name + " error: " + std::string(err.what()));
+        }
+    }
+
+    return out;
+}
+
+// Each pipeline's fallbacks, cheapest last: element lists or names of pipelines in "pipelines".
+std::map<std::string, std::vector<std::vector<nfp::PElement_info>>> nfp::parse_tiers_from(const json& j,
+    const std::map<std::string, std::vector<PElement_info>>& named) {
+
+    const json obj = j.value("tiers", json::object());
+
+    if (!obj.is_object())
+        throw std::runtime_error("Tiers must be a JSON Object!");
+
+    std::map<std::string, std::vector<std::vector<nfp::PElement_info>>> out;
+
+    for (const auto& [name, arr] : obj.items()) {
+        if (!arr.is_array() || arr.empty() || arr.size() > MAX_TIERS)
+            throw std::runtime_error("Tiers of " + name + " must be an array of 1 to " + std::to_string(MAX_TIERS) + " pipelines!");
+
+        auto & tiers = out[name];
+
+        for (size_t i = 0; i < arr.size(); ++i) {
+            if (arr[i].is_string()) {
+                auto it = named.find(arr[i].get<std::string>());
+
+                if (it == named.end())
+                    throw std::runtime_error("Tier " + std::to_string(i + 1) + " of " + name + " refers to unknown pipeline " + arr[i].get<std::string>() + "!");
+
+                tiers.push_back(it->second);
+                continue;
+            }
+
+            try {
+                tiers.push_back(parse_elements(arr[i]));
+            } catch (const std::exception& err) {
+                throw std::runtime_error("Tier " + std::to_string(i + 1) + " of " + name + " error: " + std::string(err.what()));
+            }
+        }
+    }
+
+    return out;
+}
+
+static std::vector<std::string> name_list_from(const json& j, const std::string& key, const std::string& what) {
+    if (!j.contains(key) || !j[key].is_array() || j[key].empty())
+        throw std::runtime_error(what + " must be a non-empty array of node names!");
+
+    std::vector<std::string> names;
+
+    for (const auto& name : j[key]) {
+        if (!name.is_string())
+            throw std::runtime_error(what + " must contain only node names!");
+
+        names.push_back(name.get<std::string>());
+    }
+
+    return names;
+}
+
+void nfp::from_json(const json& j, nfp::GraphNode_info& node) {
+    if (!j.is_object())
+        throw std::runtime_error("Graph node must be a JSON Object!");
+
+    if (!j.contains("name") || !j["name"].is_string())
+        throw std::runtime_error("Graph node must have a string name!");
+
+    node.name = j["name"].get<std::string>();
+
+    if (j.contains("mix")) {
+        if (j.contains("pipeline") || j.contains("input"))
+            throw std::runtime_error("Graph node " + node.name + " can't be both a mix and a pipeline!");
+
+        node.mix = name_list_from(j, "mix", "Graph mix " + node.name);
+
+        if (j.contains("weights")) {
+            if (!j["weights"].is_array() || j["weights"].size() != node.mix.size())
+                throw std::runtime_error("Graph mix " + node.name + " must have one weight per input!");
+
+            for (const auto& w : j["weights"]) {
+                if (!w.is_number())
+                    throw std::runtime_error("Graph mix weights must be numbers!");
+
+                node.weights.push_back(w.get<float>());
+            }
+        }
+        return;
+    }
+
+    if (j.contains("input")) {
+        if (!j["input"].is_string())
+            throw std::runtime_error("Graph node " + node.name + " input must be a node name!");
+
+        node.input = j["input"].get<std::string>();
+    }
+
+    if (!j.contains("pipeline"))
+        throw std::runtime_error("Graph node " + node.name + " must have a pipeline or a mix!");
+
+    if (j["pipeline"].is_string())
+        node.pipeline_ref = j["pipeline"].get<std::string>();
+    else
+        node.pipeline = parse_elements(j["pipeline"]);
+}
+
+void nfp::from_json(const json& j, nfp::Graph_info& g_info) {
+    if (!j.is_object())
+        throw std::runtime_error("Graph must be a JSON Object!");
+
+    if (!j.contains("nodes") || !j["nodes"].is_array() || j["nodes"].empty())
+        throw std::runtime_error("Graph must have a non-empty nodes array!");
+
+    for (size_t i = 0; i < j["nodes"].size(); ++i) {
+        try {
+            g_info.nodes.push_back(j["nodes"].at(i).get<nfp::GraphNode_info>());
+        } catch (const std::exception& err) {
+            throw std::runtime_error("Node Error[" + std::to_string(i) + "]: " + std::string(err.what()));
+        }
+    }
+
+    g_info.outputs = name_list_from(j, "outputs", "Graph outputs");
+
+    if (j.contains("parallel")) {
+        if (!j["parallel"].is_boolean())
+            throw std::runtime_error("Graph parallel flag must be a boolean!");
+
+        g_info.parallel = j["parallel"].get<bool>();
+    }
+}
+
+std::map<std::string, nfp::Graph_info> nfp::parse_graphs_from(const json& j) {
+    const json obj = j.value("graphs", json::object());
+
+    if (!obj.is_object())
+        throw std::runtime_error("Graphs must be a JSON Object!");
+
+    std::map<std::string, nfp::Graph_info> out;
+
+    for (const auto& [name, g] : obj.items()) {
+        try {
+            out.emplace(name, g.get<nfp::Graph_info>());
+        } catch (const std::exception& err) {
+            throw std::runtime_error("Graph " + name + " error: " + std::string(err.what()));
+        }
+    }
+
+    return out;
+}
+
+nfp::PipelineGraph nfp::build_graph(const Graph_info& g_info, const std::map<std::string, std::vector<PElement_info>>& named, float fs) {
+    nfp::PipelineGraph graph;
+
+    for (const auto& node : g_info.nodes) {
+        if (!node.mix.empty()) {
+            graph.add_mix(node.name, node.mix, node.weights);
+            continue;
+        }
+
+        const std::vector<PElement_info> * elements = &node.pipeline;
+
+        if (!node.pipeline_ref.empty()) {
+            auto it = named.find(node.pipeline_ref);
+
+            if (it == named.end())
+                throw std::runtime_error("Graph node " + node.name + " refers to unknown pipeline " + node.pipeline_ref + "!");
+
+            elements = &it->second;
+        }
+
+        graph.add_chain(node.name, node.input, build_pipeline(*elements, fs));
+    }
+
+    for (const auto& out : g_info.outputs)
+        graph.add_output(out);
+
+    graph.compile(g_info.parallel);
+    return graph;
+}
+
+static void port_range_from(const json& j, const std::string& key, uint16_t& lo, uint16_t& hi) {
+    if (!j.contains(key))
+        return;
+
+    const json& v = j[key];
+
+    if (v.is_number_unsigned() && v.get<uint64_t>() <= UINT16_MAX) {
+        lo = hi = v.get<uint16_t>();
+        return;
+    }
+
+    if (!v.is_array() || v.size() != 2 || !v[0].is_number_unsigned() || !v[1].is_number_unsigned())
+        throw std::runtime_error(key + " must be a port or a [min, max] port range!");
+
+    if (v[0].get<uint64_t>() > UINT16_MAX || v[1].get<uint64_t>() > UINT16_MAX || v[0].get<uint16_t>() > v[1].get<uint16_t>())
+        throw std::runtime_error(key + " must be a valid [min, max] port range!");
+
+    lo = v[0].get<uint16_t>();
+    hi = v[1].get<uint16_t>();
+}
+
+void nfp::from_json(const json& j, nfp::Route_info& route_info) {
+    if (!j.is_object())
+        throw std::runtime_error("Route must be a JSON Object!");
+
+    if (!j.contains("pipeline") || !j["pipeline"].is_string())
+        throw std::runtime_error("Route must have a string pipeline name!");
+
+    route_info.pipeline = j["pipeline"].get<std::string>();
+
+    if (j.contains("src-addrv4")) {
+        if (!j["src-addrv4"].is_string())
+            throw std::runtime_error("Route's source address must be a string!");
+
+        std::string cidr = j["src-addrv4"].get<std::string>();
+        int prefix = 32;
+        auto slash = cidr.find('/');
+
+        if (slash != std::string::npos) {
+            try {
+                prefix = std::stoi(cidr.substr(slash + 1));
+            } catch (const std::exception&) {
+                throw std::runtime_error(cidr + " is not a valid address prefix!");
+            }
+            cidr = cidr.substr(0, slash);
+        }
+
+        if (prefix < 0 || prefix > 32)
+            throw std::runtime_error("Route's address prefix must be between 0 and 32!");
+
+        boost::system::error_code ec;
+        auto addr = boost::asio::ip::make_address_v4(cidr, ec);
+
+        if (ec)
+            throw std::runtime_error(cidr + " is not a valid IPV4 address!");
+
+        route_info.src_net = addr.to_uint();
+        route_info.src_prefix = static_cast<uint8_t>(prefix);
+    }
+
+    port_range_from(j, "src-ports", route_info.src_port_min, route_info.src_port_max);
+    port_range_from(j, "out-ports", route_info.out_port_min, route_info.out_port_max);
+
+    if (j.contains("concealment-policy")) {
+        if (!j["concealment-policy"].is_string())
+            throw std::runtime_error("Route's concealment policy must be a string!");
+
+        route_info.policy = concealment_policy_chk(j["concealment-policy"]);
+        route_info.has_policy = true;
+    }
+
+    if (j.contains("sinks")) {
+        route_info.sinks = sinks_from(j["sinks"]);
+        route_info.has_sinks = true;
+    }
+
+    if (j.contains("shm-output")) {
+        route_info.shm = shm_output_from(j["shm-output"]);
+        route_info.has_shm = true;
+    }
+}
+
+std::vector<nfp::Route_info> nfp::parse_routes_from(const json& j) {
+    const json arr = j.value("routes", json::array());
+
+    if (!arr.is_array())
+        throw std::runtime_error("Routes must be an array!");
+
+    std::vector<nfp::Route_info> out;
+    out.reserve(arr.size());
+
+    for (size_t i = 0; i < arr.size(); i++) {
+        try {
+            out.push_back(arr.at(i).get<Route_info>());
+        } catch (const std::exception& err) {
+            throw std::runtime_error("Route Error[" + std::to_string(i) + "]: " + std::string(err.what()));
+        }
+    }
+
+    return out;
+}
+
+nfp::RouteTable nfp::build_route_table(const json& j, const Conn_info& conn_info) {
+    nfp::RouteTable table;
+
+    auto named = parse_named_pipelines_from(j);
+
+    if (named.count("default"))
+        throw std::runtime_error("Pipeline name default is reserved!");
+
+    std::map<std::string, nfp::SignalPipeline> compiled;
+    compiled.emplace("default", build_pipeline(parse_pipeline_from(j), conn_info.samp_freq));
+
+    for (const auto& [name, elements] : named)
+        compiled.emplace(name, build_pipeline(elements, conn_info.samp_freq));
+
+    std::map<std::string, nfp::PipelineGraph> graphs;
+
+    for (const auto& [name, g_info] : parse_graphs_from(j)) {
+        if (compiled.count(name))
+            throw std::runtime_error("Graph " + name + " has the same name as a pipeline!");
+
+        try {
+            graphs.emplace(name, build_graph(g_info, named, conn_info.samp_freq));
+        } catch (const std::exception& err) {
+            throw std::runtime_error("Graph " + name + " error: " + std::string(err.what()));
+        }
+    }
+
+    auto quantized = [&](const nfp::SignalPipeline& p) {
+        return conn_info.fixed_point ? nfp::FixedPointFilter(p.coeffs()) : nfp::FixedPointFilter();
+    };
+
+    std::map<std::string, std::vector<nfp::SignalPipeline>> tiers;
+
+    for (const auto& [name, levels] : parse_tiers_from(j, named)) {
+        auto it = compiled.find(name);
+
+        if (it == compiled.end())
+            throw std::runtime_error("Tiers refer to unknown pipeline " + name + "!");
+
+        if (conn_info.fixed_point)
+            throw std::runtime_error("Tiers need float arithmetic!");
+
+        auto & built = tiers[name];
+
+        for (const auto& elements : levels)
+            built.push_back(build_pipeline(elements, conn_info.samp_freq));
+
+        if (it->second.get_spectrum() || std::any_of(built.begin(), built.end(), [](const auto& p) { return p.get_spectrum() != nullptr; }))
+            throw std::runtime_error("Tiers of " + name + " can't have spectrum elements!");
+    }
+
+    auto tiers_of = [&](const std::string& name) {
+        std::vector<nfp::SignalPipeline> out;
+        auto it = tiers.find(name);
+
+        if (it != tiers.end())
+            for (const auto& p : it->second)
+                out.push_back(p.clone());
+
+        return out;
+    };
+
+    const auto& def = compiled.at("default");
+    table.set_default_route(table.add_route("default", def.clone(), conn_info.policy, quantized(def)));
+    table.set_sinks(0, conn_info.sinks);
+    table.set_shm_output(0, conn_info.shm);
+    table.set_tiers(0, tiers_of("default"));
+
+    for (const auto& r : parse_routes_from(j)) {
+        auto it = compiled.find(r.pipeline);
+        auto git = graphs.find(r.pipeline);
+
+        if (it == compiled.end() && git == graphs.end())
+            throw std::runtime_error("Route refers to unknown pipeline " + r.pipeline + "!");
+
+        auto policy = r.has_policy ? r.policy : conn_info.policy;
+        const auto& sinks = r.has_sinks ? r.sinks : conn_info.sinks;
+        const auto& shm = r.has_shm ? r.shm : conn_info.shm;
+        int route = -1;
+
+        for (size_t i = 0; i < table.size(); ++i)
+            if (table.at(i).name == r.pipeline && table.at(i).policy == policy && table.at(i).sinks == sinks && table.at(i).shm == shm)
+                route = static_cast<int>(i);
+
+        // Graphs always run in float; Q15 streams are converted at their edges.
+        if (route < 0 && git != graphs.end())
+            route = table.add_route(r.pipeline, git->second.clone(), policy);
+        else if (route < 0) {
+            route = table.add_route(r.pipeline, it->second.clone(), policy, quantized(it->second));
+            table.set_tiers(static_cast<uint16_t>(route), tiers_of(r.pipeline));
+        }
+
+        table.set_sinks(static_cast<uint16_t>(route), sinks);
+        table.set_shm_output(static_cast<uint16_t>(route), shm);
+
+        table.add_rule(r.src_net, r.src_prefix, r.src_port_min, r.src_port_max,
+            r.out_port_min, r.out_port_max, static_cast<uint16_t>(route));
+    }
+
+    return table;
+}
+
+static unsigned thread_count_from(const json& j, const std::string& key, unsigned def) {
+    if (!j.contains(key))
+        return def;
+
+    if (!j[key].is_number_unsigned() || j[key].get<uint64_t>() > 1024)
+        throw std::runtime_error(key + " must be a positive integer <= 1024!");
+
+    return j[key].get<unsigned>();
+}
+
+static std::vector<int> cpu_list_from(const json& j, const std::string& key) {
+    std::vector<int> cpus;
+
+    if (!j.contains(key))
+        return cpus;
+
+    if (!j[key].is_array())
+        throw std::runtime_error(key + " must be an array of CPU indexes!");
+
+    for (const auto& cpu : j[key]) {
+        if (!cpu.is_number_unsigned())
+            throw std::runtime_error(key + " must contain only non-negative CPU indexes!");
+
+        cpus.push_back(cpu.get<int>());
+    }
+
+    return cpus;
+}
+
+void nfp::from_json(const json& j, nfp::Thread_info& t_info) {
+    if (j.contains("mode")) {
+        if (!j["mode"].is_string())
+            throw std::runtime_error("Threading mode must be a string!");
+
+        auto mode = lower_string(j["mode"].get<std::string>());
+
+        if (mode == "run-to-completion")
+            t_info.run_to_completion = true;
+        else if (mode == "coroutine")
+            t_info.coroutines = true;
+        else if (mode != "pool")
+            throw std::runtime_error(mode + " is not a valid threading mode!");
+    }
+
+    t_info.receivers = thread_count_from(j, "receivers", t_info.receivers);
+    t_info.workers = thread_count_from(j, "workers", t_info.workers);
+    t_info.senders = thread_count_from(j, "senders", t_info.senders);
+
+    if (t_info.receivers == 0 || (!t_info.run_to_completion && (t_info.workers == 0 || t_info.senders == 0)))
+        throw std::runtime_error("Thread counts must be non-zero!");
+
+    t_info.receiver_cpus = cpu_list_from(j, "receiver-cpus");
+    t_info.worker_cpus = cpu_list_from(j, "worker-cpus");
+    t_info.sender_cpus = cpu_list_from(j, "sender-cpus");
+
+    if (j.contains("fifo-priority")) {
+        if (!j["fifo-priority"].is_number_unsigned())
+            throw std::runtime_error("SCHED_FIFO priority must be an integer!");
+
+        int prio = j["fifo-priority"].get<int>();
+
+        if (prio < 1 || prio > 99)
+            throw std::runtime_error("SCHED_FIFO priority must be between 1 and 99!");
+
+        t_info.fifo_priority = prio;
+    }
+
+    if (j.contains("mlockall")) {
+        if (!j["mlockall"].is_boolean())
+            throw std::runtime_error("mlockall must be a boolean!");
+
+        t_info.lock_memory = j["mlockall"].get<bool>();
+    }
+
+    if (j.contains("queue-capacity")) {
+        if (!j["queue-capacity"].is_number_unsigned() || j["queue-capacity"].get<uint64_t>() == 0 || j["queue-capacity"].get<uint64_t>() > 65536)
+            throw std::runtime_error("queue-capacity must be an integer between 1 and 65536!");
+
+        t_info.queue_capacity = j["queue-capacity"].get<unsigned>();
+    }
+
+    if (j.contains("overload-policy")) {
+        static const std::unordered_map<std::string, nfp::OVERLOAD> conv = {
+            {"drop-newest", nfp::OVERLOAD::DROP_NEWEST},
+            {"drop-oldest", nfp::OVERLOAD::DROP_OLDEST},
+            {"established-first", nfp::OVERLOAD::ESTABLISHED_FIRST}
+        };
+
+        if (!j["overload-policy"].is_string())
+            throw std::runtime_error("Overload policy must be a string!");
+
+        auto policy = lower_string(j["overload-policy"].get<std::string>());
+        auto it = conv.find(policy);
+
+        if (it == conv.end())
+            throw std::runtime_error(policy + " is not a valid overload policy!");
+
+        t_info.overload_policy = it->second;
+    }
+
+    if (j.contains("pause-reads")) {
+        if (!j["pause-reads"].is_boolean())
+            throw std::runtime_error("pause-reads must be a boolean!");
+
+        t_info.pause_reads = j["pause-reads"].get<bool>();
+    }
+
+    if (j.contains("backends")) {
+        if (!j["backends"].is_number_unsigned() || j["backends"].get<uint64_t>() > 64)
+            throw std::runtime_error("backends must be an integer between 0 and 64!");
+
+        t_info.backends = j["backends"].get<unsigned>();
+    }
+
+    if (j.contains("ring-capacity")) {
+        if (!j["ring-capacity"].is_number_unsigned())
+            throw std::runtime_error("ring-capacity must be a power of two between 64 and 1048576!");
+
+        const uint64_t capacity = j["ring-capacity"].get<uint64_t>();
+
+        if (capacity < 64 || capacity > (1u << 20) || (capacity & (capacity - 1)) != 0)
+            throw std::runtime_error("ring-capacity must be a power of two between 64 and 1048576!");
+
+        t_info.ring_capacity = static_cast<unsigned>(capacity);
+    }
+
+    if (j.contains("tier-high")) {
+        if (!j["tier-high"].is_number() || j["tier-high"].get<float>() <= 0.0f || j["tier-high"].get<float>() > 1.0f)
+            throw std::runtime_error("tier-high must be a number in (0, 1]!");
+
+        t_info.tier_high = j["tier-high"].get<float>();
+    }
+
+    if (j.contains("tier-low")) {
+        if (!j["tier-low"].is_number() || j["tier-low"].get<float>() <= 0.0f || j["tier-low"].get<float>() > 1.0f)
+            throw std::runtime_error("tier-low must be a number in (0, 1]!");
+
+        t_info.tier_low = j["tier-low"].get<float>();
+    }
+
+    if (t_info.tier_low >= t_info.tier_high)
+        throw std::runtime_error("tier-low must be below tier-high!");
+
+    // Whether the host runs it is only known where the plan is run.
+    if (j.contains("isa")) {
+        if (!j["isa"].is_string())
+            throw std::runtime_error("isa must be a string!");
+
+        auto isa = lower_string(j["isa"].get<std::string>());
+
+        if (isa != "auto") {
+            t_info.has_isa = true;
+            t_info.isa = nfp::isa_from_name(isa);
+        }
+    }
+
+    if (t_info.run_to_completion) {
+        t_info.receivers = 1;
+        t_info.workers = 0;
+        t_info.senders = 0;
+    }
+
+    // Each receiver runs its own coroutine, which filters and sends too.
+    if (t_info.coroutines) {
+        #ifndef NFP_COROUTINES
+            throw std::runtime_error("coroutine mode needs a build with NFP_COROUTINES=ON!");
+        #endif
+
+        t_info.workers = 0;
+        t_info.senders = 0;
+    }
+}
+
+nfp::Thread_info nfp::parse_threads_from(const json& j) {
+    const json obj = j.value("threads", json::object());
+
+    if (!obj.is_object())
+        throw std::runtime_error("Threads configuration must be a JSON Object!");
+
+    try {
+        return obj.get<nfp::Thread_info>();
+    } catch (const std::exception& err) {
+        throw std::runtime_error("Threads error: " + std::string(err.what()));
+    }
+}
+
+void nfp::from_json(const json& j, nfp::Analysis_info& a_info) {
+    if (j.contains("enabled")) {
+        if (!j["enabled"].is_boolean())
+            throw std::runtime_error("Analysis enabled flag must be a boolean!");
+
+        a_info.enabled = j["enabled"].get<bool>();
+    }
+
+    if (j.contains("max-gain-db")) {
+        if (!j["max-gain-db"].is_number())
+            throw std::runtime_error("Maximum gain must be a number!");
+
+        a_info.max_gain_db = j["max-gain-db"].get<float>();
+    }
+
+    if (j.contains("min-stability-margin")) {
+        if (!j["min-stability-margin"].is_number())
+            throw std::runtime_error("Minimum stability margin must be a number!");
+
+        float margin = j["min-stability-margin"].get<float>();
+
+        if (margin < 0.0f || margin >= 1.0f)
+            throw std::runtime_error("Minimum stability margin must be in [0, 1)!");
+
+        a_info.min_stability_margin = margin;
+    }
+
+    if (j.contains("points")) {
+        if (!j["points"].is_number_unsigned() || j["points"].get<uint64_t>() < 2 || j["points"].get<uint64_t>() > (1u << 20))
+            throw std::runtime_error("Analysis points must be an integer between 2 and 1048576!");
+
+        a_info.points = j["points"].get<unsigned>();
+    }
+
+    if (j.contains("min-snr-db")) {
+        if (!j["min-snr-db"].is_number())
+            throw std::runtime_error("Minimum SNR must be a number!");
+
+        a_info.min_snr_db = j["min-snr-db"].get<float>();
+    }
+}
+
+nfp::Analysis_info nfp::parse_analysis_from(const json& j) {
+    const json obj = j.value("analysis", json::object());
+
+    if (!obj.is_object())
+        throw std::runtime_error("Analysis configuration must be a JSON Object!");
+
+    try {
+        return obj.get<nfp::Analysis_info>();
+    } catch (const std::exception& err) {
+        throw std::runtime_error("Analysis error: " + std::string(err.what()));
+    }
+}
+
+void nfp::validate_route_table(const RouteTable& table, const Analysis_info& a_info, float fs) {
+    if (!a_info.enabled)
+        return;
+
+    auto check = [&](const std::string& name, const nfp::SignalPipeline& pipeline, const nfp::FixedPointFilter& fixed) {
+        auto report = nfp::FilterAnalysis(pipeline.coeffs(), fs).stability(a_info.points);
+
+        if (!report.stable || report.stability_margin < a_info.min_stability_margin)
+            throw std::runtime_error("Pipeline " + name + " is unstable (pole radius " +
+                std::to_string(report.max_pole_radius) + ")!");
+
+        if (report.peak_gain_db > a_info.max_gain_db)
+            throw std::runtime_error("Pipeline " + name + " clips: peak gain " + std::to_string(report.peak_gain_db) +
+                " dB at " + std::to_string(report.peak_freq) + " Hz exceeds " + std::to_string(a_info.max_gain_db) + " dB!");
+
+        if (fixed.empty())
+            return;
+
+        float snr = nfp::quantization_snr(pipeline.coeffs(), fixed);
+
+        if (snr < a_info.min_snr_db)
+            throw std::runtime_error("Pipeline " + name + " loses too much precision in fixed point: SNR " +
+                std::to_string(snr) + " dB is below " + std::to_string(a_info.min_snr_db) + " dB!");
+    };
+
+    for (uint16_t r = 0; r < table.size(); ++r) {
+        const auto& route = table.at(r);
+
+        // Only plain pipelines have tiers, and a tier runs in production as much as the main pipeline.
+        if (!route.graph) {
+            check(route.name, route.pipeline, route.fixed);
+
+            for (size_t t = 0; t < route.tiers.size(); ++t)
+                check(route.name + "/tier " + std::to_string(t + 1), route.tiers[t], nfp::FixedPointFilter{});
+
+            continue;
+        }
+
+        // Each chain is checked on its own; mixes only sum already validated branches.
+        for (size_t c = 0; c < route.graph->n_chains(); ++c)
+            check(route.name + "/" + route.graph->chain_name(c), route.graph->chain(c), nfp::FixedPointFilter{});
+    }
+}
@@ -0,0 +1,180 @@
+#include <nfp/ConnTable.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+using nfp::SlabAllocator;
+using nfp::ConnTable;
+using nfp::ConnState;
+using nfp::ConnCold;
+using nfp::Datagram;
+
+static constexpr size_t CACHE_LINE = 64;
+
+SlabAllocator::SlabAllocator(size_t slot_size, size_t slots_per_chunk) : slots_per_chunk(slots_per_chunk) {
+    if (slot_size < sizeof(void *))
+        slot_size = sizeof(void *);
+
+    this->slot_size = (slot_size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+}
+
+SlabAllocator::~SlabAllocator() {
+    for (auto chunk : this->chunks)
+        ::operator delete(chunk, std::align_val_t{CACHE_LINE});
+}
+
+void SlabAllocator::grow() {
+    auto chunk = static_cast<unsigned char *>(::operator new(this->slot_size * this->slots_per_chunk, std::align_val_t{CACHE_LINE}));
+    this->chunks.push_back(chunk);
+
+    for (size_t i = this->slots_per_chunk; i-- > 0; ) {
+        void * slot = chunk + i * this->slot_size;
+        *static_cast<void **>(slot) = this->free_list;
+        this->free_list = slot;
+    }
+}
+
+void * SlabAllocator::allocate() {
+    if (!this->free_list)
+        this->grow();
+
+    void * slot = this->free_list;
+    this->free_list = *static_cast<void **>(slot);
+    return slot;
+}
+
+void SlabAllocator::deallocate(void * slot) {
+    *static_cast<void **>(slot) = this->free_list;
+    this->free_list = slot;
+}
+
+void SlabAllocator::set_slot_size(size_t slot_size) {
+    if (!this->chunks.empty())
+        throw std::runtime_error("Slab slot size can't change once slots were handed out!");
+
+    slot_size = std::max(slot_size, sizeof(void *));
+    this->slot_size = (slot_size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+}
+
+ConnTable::ConnTable(unsigned jitter_depth)
+    : entries(64), jitter_depth(jitter_depth), cold_slab(sizeof(ConnCold) + jitter_depth * sizeof(Datagram)),
+      presence(size_t(1) << PRESENCE_BITS) {
+
+    if (jitter_depth == 0 || jitter_depth > 32 || (jitter_depth & (jitter_depth - 1)) != 0)
+        throw std::runtime_error("Jitter depth must be a power of two <= 32!");
+
+    this->set_arena_bytes(0);
+}
+
+ConnTable::~ConnTable() {
+    this->for_each([](ConnState & e) { e.cold->~ConnCold(); });
+}
+
+size_t ConnTable::arena_offset() const {
+    const size_t header = sizeof(ConnCold) + this->jitter_depth * sizeof(Datagram);
+    return (header + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+}
+
+void ConnTable::set_arena_bytes(size_t bytes) {
+    if (this->count != 0)
+        throw std::runtime_error("Connection arenas can't be resized while connections are open!");
+
+    // monotonic_buffer_resource wants a non-empty initial buffer.
+    this->cold_slab.set_slot_size(this->arena_offset() + std::max(bytes, CACHE_LINE));
+}
+
+ConnState * ConnTable::find(uint64_t key) {
+    const size_t mask = this->entries.size() - 1;
+
+    for (size_t i = this->ideal_slot(key); ; i = (i + 1) & mask) {
+        auto & e = this->entries[i];
+
+        if (!(e.flags & ConnState::OCCUPIED))
+            return nullptr;
+
+        if (e.key == key)
+            return &e;
+    }
+}
+
+ConnState & ConnTable::find_or_insert(uint64_t key, bool & inserted) {
+    inserted = false;
+
+    if (auto e = this->find(key))
+        return *e;
+
+    if (this->count + 1 > this->entries.size() * max_load)
+        this->rehash();
+
+    const size_t mask = this->entries.size() - 1;
+    size_t i = this->ideal_slot(key);
+
+    while (this->entries[i].flags & ConnState::OCCUPIED)
+        i = (i + 1) & mask;
+
+    auto & e = this->entries[i];
+    e = ConnState{};
+    e.key = key;
+    e.flags = ConnState::OCCUPIED;
+
+    auto slot = static_cast<unsigned char *>(this->cold_slab.allocate());
+    e.cold = new (slot) ConnCold(slot + this->arena_offset(), this->arena_bytes_per_connection());
+
+    this->presence[presence_slot(key)].fetch_add(1, std::memory_order_relaxed);
+    ++this->count;
+    inserted = true;
+    return e;
+}
+
+bool ConnTable::erase(uint64_t key) {
+    ConnState * e = this->find(key);
+
+    if (!e)
+        return false;
+
+    const size_t mask = this->entries.size() - 1;
+    size_t i = static_cast<size_t>(e - this->entries.data());
+
+    e->cold->~ConnCold();
+    this->cold_slab.deallocate(e->cold);
+
+    // Backward-shift deletion keeps probe sequences intact without tombstones.
+    for (size_t j = (i + 1) & mask; this->entries[j].flags & ConnState::OCCUPIED; j = (j + 1) & mask) {
+        size_t k = this->ideal_slot(this->entries[j].key);
+
+        bool movable = (j > i) ? (k <= i || k > j) : (k <= i && k > j);
+
+        if (movable) {
+            this->entries[i] = std::move(this->entries[j]);
+            i = j;
+        }
+    }
+
+    this->entries[i] = ConnState{};
+    this->presence[presence_slot(key)].fetch_sub(1, std::memory_order_relaxed);
+    --this->count;
+    return true;
+}
+
+void ConnTable::rehash() {
+    std::vector<ConnState> old(this->entries.size() * 2);
+    old.swap(this->entries);
+    --this->shift;
+
+    const size_t mask = this->entries.size() - 1;
+
+    for (auto & e : old) {
+        if (!(e.flags & ConnState::OCCUPIED))
+            continue;
+
+        size_t i = this->ideal_slot(e.key);
+
+        while (this->entries[i].flags & ConnState::OCCUPIED)
+            i = (i + 1) & mask;
+
+        this->entries[i] = std::move(e);
+    }
+}
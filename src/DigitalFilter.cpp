@@ -1,4 +1,5 @@
 #include <nfp/DigitalFilter.hpp>
+#include <nfp/Kernels.hpp>
 #include <array>
 #include <math.h>
 #include <algorithm>
@@ -12,7 +13,7 @@ using std::sort;
 using std::complex;
 using std::exp;
 
-const int PI = 3.14159;
+const float PI = 3.14159265f;
 
 
 void DigitalFilter::normalize_ggain(DigitalFilter::Normalization norm) {
@@ -28,7 +29,7 @@ void DigitalFilter::normalize_ggain(DigitalFilter::Normalization norm) {
     for (auto f : this->biquad_cascate) {
 
         float f_b0 = f.coeffs()[3], f_b1 = f.coeffs()[4], f_b2 = f.coeffs()[5];
-        float f_a0 = coeffs()[0], f_a1 = coeffs()[1], f_a2 = coeffs()[2];
+        float f_a0 = f.coeffs()[0], f_a1 = f.coeffs()[1], f_a2 = f.coeffs()[2];
 
         float filter_gain = 1.0f;
 
@@ -71,16 +72,62 @@ void DigitalFilter::reset() {
         f.reset();
 }
 
+bool DigitalFilter::quiescent(float threshold) const {
+    for (const auto & f : this->biquad_cascate)
+        if (!f.quiescent(threshold))
+            return false;
+
+    return true;
+}
+
+void DigitalFilter::save_state(vector<unsigned char> & out) const {
+    for (const auto & f : this->biquad_cascate)
+        f.save_state(out);
+}
+
+const unsigned char * DigitalFilter::load_state(const unsigned char * in) {
+    for (auto & f : this->biquad_cascate)
+        in = f.load_state(in);
+
+    return in;
+}
+
 void DigitalFilter::processBlock(const vector<float> & input, vector<float> & output) {
-    output.clear();
-    output.reserve(input.size());
+    output.resize(input.size());
+    this->processBlock(input.data(), output.data(), input.size());
+}
+
+// Sections are gathered into contiguous arrays a group at a time, the layout the kernels read.
+void DigitalFilter::processBlock(const float * input, float * output, size_t n) {
+    constexpr size_t GROUP = 16;
+    const auto & k = nfp::kernels();
+    const size_t sections = this->biquad_cascate.size();
+
+    if (sections == 0) {
+        std::copy(input, input + n, output);
+        return;
+    }
+
+    float coeffs[5 * GROUP], state[2 * GROUP];
+
+    for (size_t g = 0; g < sections; g += GROUP) {
+        const size_t m = std::min(GROUP, sections - g);
 
-    for (const auto & x : input)
-        output.push_back(this->eval(x)); 
+        for (size_t s = 0; s < m; ++s) {
+            auto & f = this->biquad_cascate[g + s];
+            std::copy(f.normalized(), f.normalized() + 5, coeffs + 5 * s);
+            std::copy(f.delay_line(), f.delay_line() + 2, state + 2 * s);
+        }
+
+        k.cascade(coeffs, state, m, input, output, n);
+        input = output;
 
+        for (size_t s = 0; s < m; ++s)
+            std::copy(state + 2 * s, state + 2 * s + 2, this->biquad_cascate[g + s].delay_line());
+    }
 }
 
-vector<float> DigitalFilter::coeffs() {
+vector<float> DigitalFilter::coeffs() const {
     vector<float> cs;
     cs.reserve(this->biquad_cascate.size() * 6);
 
@@ -92,6 +139,10 @@ vector<float> DigitalFilter::coeffs() {
     return cs;
 }
 
+size_t DigitalFilter::footprint() const {
+    return sizeof(*this) + this->biquad_cascate.capacity() * sizeof(BiquadFilter);
+}
+
 DigitalFilter DigitalFilter::low_pass_filter(float w0, int ord, float Q) {
     DigitalFilter ret{w0, Q};
     
@@ -151,4 +202,10 @@ DigitalFilter DigitalFilter::band_pass_filter(float w0, float BW) {
     ret.biquad_cascate.push_back(BiquadFilter::bpf(w0, BW));
     ret.normalize_ggain(DigitalFilter::Normalization::FC);
     return ret;
+}
+
+DigitalFilter DigitalFilter::from_sections(float w0, vector<BiquadFilter> sections) {
+    DigitalFilter ret {w0, 0};
+    ret.biquad_cascate.assign(sections.begin(), sections.end());
+    return ret;
 }
\ No newline at end of file
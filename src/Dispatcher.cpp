@@ -0,0 +1,131 @@
+#include <nfp/Dispatcher.hpp>
+#include <chrono>
+#include <thread>
+
+using boost::asio::ip::udp;
+using nfp::Datagram;
+using nfp::Datagram16;
+using nfp::Dispatcher;
+using nfp::RingServer;
+using nfp::RingSlot;
+using nfp::ShmRing;
+
+Dispatcher::Dispatcher(boost::asio::io_context& io_context, int port, bool reuse_port, std::vector<ShmRing> rings)
+    : socket(UDPServer::open_socket(io_context, port, reuse_port)), rings(std::move(rings)) {
+    if (this->rings.empty())
+        throw std::runtime_error("Dispatcher needs at least one backend!");
+
+    this->socket.non_blocking(true);
+}
+
+std::string Dispatcher::ring_name(uint16_t port, unsigned backend, unsigned receiver) {
+    return "/nfp-" + std::to_string(port) + "-" + std::to_string(backend) + "-" + std::to_string(receiver);
+}
+
+void Dispatcher::forward(size_t bytes) {
+    if (bytes != sizeof(Datagram) && bytes != sizeof(Datagram16))
+        return;
+
+    const uint64_t key = UDPWorker::conn_key(this->remote_endpoint);
+    this->rings[backend_of(key, this->rings.size())].push(this->rcv_package, bytes,
+        this->remote_endpoint.address().to_v4().to_uint(), this->remote_endpoint.port());
+}
+
+void Dispatcher::start() {
+    this->start_receive();
+}
+
+// One wake-up takes whatever else is already queued on the socket.
+void Dispatcher::start_receive() {
+    auto self = shared_from_this();
+
+    this->socket.async_receive_from(
+        boost::asio::buffer(&this->rcv_package, sizeof(Datagram)),
+        this->remote_endpoint,
+        [self](boost::system::error_code ec, std::size_t bytes_recv) {
+
+            if (ec == boost::asio::error::operation_aborted) return;
+
+            if (!ec)
+                self->forward(bytes_recv);
+
+            for (unsigned n = 1; n < RECV_BATCH && !ec; ++n) {
+                bytes_recv = self->socket.receive_from(boost::asio::buffer(&self->rcv_package, sizeof(Datagram)), self->remote_endpoint, 0, ec);
+
+                if (!ec)
+                    self->forward(bytes_recv);
+            }
+
+            if (self->socket.is_open())
+                self->start_receive();
+        }
+    );
+}
+
+void Dispatcher::close() {
+    boost::system::error_code ec;
+    this->socket.cancel(ec);
+    this->socket.close(ec);
+}
+
+RingServer::RingServer(std::vector<ShmRing> rings) : rings(std::move(rings)) {
+    for (auto & ring : this->rings)
+        ring.claim();
+
+    std::weak_ptr<std::atomic<bool>> weak = this->paused;
+
+    this->resume_reads = [weak]() {
+        if (auto paused = weak.lock())
+            *paused = false;
+    };
+}
+
+size_t RingServer::poll(ShmRing& ring) {
+    return ring.consume(POLL_BATCH, [this](const RingSlot& slot) {
+        const udp::endpoint from {boost::asio::ip::address_v4(slot.addr), slot.port};
+        const bool q15 = slot.bytes == sizeof(Datagram16);
+
+        if (this->inline_dispatch) {
+            this->worker->handle_pkg(slot.pkg, from, q15);
+            return true;
+        }
+
+        // Set first: the worker may resume reads before enqueue returns.
+        *this->paused = true;
+
+        if (!this->worker->enqueue(slot.pkg, from, q15, this->resume_reads))
+            return false;
+
+        *this->paused = false;
+        return true;
+    });
+}
+
+void RingServer::run() {
+    std::lock_guard<std::mutex> lock(this->run_mtx);
+    unsigned idle = 0;
+
+    while (this->running) {
+        size_t n = 0;
+
+        if (!*this->paused)
+            for (auto & ring : this->rings)
+                n += this->poll(ring);
+
+        if (n) {
+            idle = 0;
+        } else if (++idle < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+void RingServer::close() {
+    this->running = false;
+    std::lock_guard<std::mutex> lock(this->run_mtx);
+
+    for (auto & ring : this->rings)
+        ring.release();
+}
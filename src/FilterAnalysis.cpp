@@ -0,0 +1,164 @@
+#include <nfp/FilterAnalysis.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+using nfp::FilterAnalysis;
+using nfp::FrequencyResponse;
+using nfp::StabilityReport;
+using nfp::SectionReport;
+using std::vector;
+using std::complex;
+
+static constexpr double PI = 3.14159265358979323846;
+static constexpr float DB_PER_LOG2 = 3.01029995f;
+static constexpr float EPS = 1e-30f;
+
+// Branch-free log2 so the per-frequency loops below stay vectorizable.
+static inline float fast_log2(float x) {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+
+    float e = static_cast<float>(static_cast<int32_t>(bits >> 23) - 127);
+    bits = (bits & 0x007FFFFFu) | 0x3F800000u;
+
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+
+    float t = (m - 1.0f) / (m + 1.0f);
+    float t2 = t * t;
+    float p = t * (2.88539008f + t2 * (0.961796694f + t2 * (0.577078016f + t2 * 0.412198595f)));
+
+    return e + p;
+}
+
+struct Grid {
+    vector<float> c1, s1, c2, s2;
+
+    explicit Grid(size_t n) : c1(n), s1(n), c2(n), s2(n) {
+        for (size_t k = 0; k < n; ++k) {
+            double w = PI * static_cast<double>(k) / static_cast<double>(n - 1);
+            c1[k] = static_cast<float>(std::cos(w));
+            s1[k] = static_cast<float>(std::sin(w));
+            c2[k] = static_cast<float>(std::cos(2 * w));
+            s2[k] = static_cast<float>(std::sin(2 * w));
+        }
+    }
+};
+
+static std::array<complex<float>, 2> quadratic_roots(double c2, double c1, double c0) {
+    if (c2 == 0.0) {
+        if (c1 == 0.0)
+            return {complex<float>{0, 0}, complex<float>{0, 0}};
+        return {complex<float>(static_cast<float>(-c0 / c1), 0), complex<float>{0, 0}};
+    }
+
+    complex<double> d = std::sqrt(complex<double>(c1 * c1 - 4 * c2 * c0, 0));
+    complex<double> r0 = (-c1 + d) / (2 * c2);
+    complex<double> r1 = (-c1 - d) / (2 * c2);
+
+    return {complex<float>(r0), complex<float>(r1)};
+}
+
+FilterAnalysis::FilterAnalysis(vector<float> coeffs, float fs) : cs(std::move(coeffs)), fs(fs) {
+    if (this->cs.size() % 6 != 0)
+        throw std::runtime_error("Coefficients must be grouped in sections of 6!");
+
+    if (fs <= 0.0f)
+        throw std::runtime_error("Sampling frequency must be a non-zero positive number!");
+}
+
+FrequencyResponse FilterAnalysis::response(size_t n_points) const {
+    n_points = std::max<size_t>(n_points, 2);
+
+    Grid g {n_points};
+    FrequencyResponse ret;
+
+    vector<float> log_mag(n_points, 0.0f), pr(n_points, 1.0f), pi(n_points, 0.0f), gd(n_points, 0.0f);
+
+    const float * c1 = g.c1.data(), * s1 = g.s1.data(), * c2 = g.c2.data(), * s2 = g.s2.data();
+
+    for (size_t i = 0; i < this->n_sections(); ++i) {
+        const float a0 = cs[6*i], a1 = cs[6*i+1], a2 = cs[6*i+2];
+        const float b0 = cs[6*i+3], b1 = cs[6*i+4], b2 = cs[6*i+5];
+
+        for (size_t k = 0; k < n_points; ++k) {
+            float br = b0 + b1 * c1[k] + b2 * c2[k], bi = -(b1 * s1[k] + b2 * s2[k]);
+            float ar = a0 + a1 * c1[k] + a2 * c2[k], ai = -(a1 * s1[k] + a2 * s2[k]);
+            float nb = br * br + bi * bi + EPS, na = ar * ar + ai * ai + EPS;
+
+            log_mag[k] += fast_log2(nb) - fast_log2(na);
+
+            float inv = 1.0f / std::sqrt(nb * na);
+            float hr = (br * ar + bi * ai) * inv, hi = (bi * ar - br * ai) * inv;
+            float tr = pr[k] * hr - pi[k] * hi;
+            pi[k] = pr[k] * hi + pi[k] * hr;
+            pr[k] = tr;
+
+            float dbr = b1 * c1[k] + 2 * b2 * c2[k], dbi = -(b1 * s1[k] + 2 * b2 * s2[k]);
+            float dar = a1 * c1[k] + 2 * a2 * c2[k], dai = -(a1 * s1[k] + 2 * a2 * s2[k]);
+            gd[k] += (dbr * br + dbi * bi) / nb - (dar * ar + dai * ai) / na;
+        }
+    }
+
+    ret.freqs.resize(n_points);
+    ret.magnitude_db.resize(n_points);
+    ret.phase.resize(n_points);
+    ret.group_delay = std::move(gd);
+
+    for (size_t k = 0; k < n_points; ++k) {
+        ret.freqs[k] = 0.5f * this->fs * static_cast<float>(k) / static_cast<float>(n_points - 1);
+        ret.magnitude_db[k] = DB_PER_LOG2 * log_mag[k];
+        ret.phase[k] = std::atan2(pi[k], pr[k]);
+    }
+
+    return ret;
+}
+
+StabilityReport FilterAnalysis::stability(size_t n_points) const {
+    n_points = std::max<size_t>(n_points, 2);
+
+    Grid g {n_points};
+    StabilityReport ret {true, 0.0f, 1.0f, 0.0f, 0.0f, {}};
+    ret.sections.reserve(this->n_sections());
+
+    vector<float> log_mag(n_points, 0.0f), state(n_points);
+    const float * c1 = g.c1.data(), * s1 = g.s1.data(), * c2 = g.c2.data(), * s2 = g.s2.data();
+
+    for (size_t i = 0; i < this->n_sections(); ++i) {
+        const float a0 = cs[6*i], a1 = cs[6*i+1], a2 = cs[6*i+2];
+        const float b0 = cs[6*i+3], b1 = cs[6*i+4], b2 = cs[6*i+5];
+        const float log_a0 = fast_log2(a0 * a0 + EPS);
+
+        SectionReport sec;
+        sec.poles = quadratic_roots(a0, a1, a2);
+        sec.zeros = quadratic_roots(b0, b1, b2);
+        sec.pole_radius = std::max(std::abs(sec.poles[0]), std::abs(sec.poles[1]));
+
+        for (size_t k = 0; k < n_points; ++k) {
+            float br = b0 + b1 * c1[k] + b2 * c2[k], bi = -(b1 * s1[k] + b2 * s2[k]);
+            float ar = a0 + a1 * c1[k] + a2 * c2[k], ai = -(a1 * s1[k] + a2 * s2[k]);
+            float log_na = fast_log2(ar * ar + ai * ai + EPS);
+
+            // Direct form II keeps x / (A / a0) in its state, which is what overflows first.
+            state[k] = log_mag[k] + log_a0 - log_na;
+            log_mag[k] += fast_log2(br * br + bi * bi + EPS) - log_na;
+        }
+
+        auto peak = std::max_element(log_mag.begin(), log_mag.end());
+        sec.peak_gain_db = DB_PER_LOG2 * *peak;
+        sec.state_peak_gain_db = DB_PER_LOG2 * *std::max_element(state.begin(), state.end());
+
+        ret.max_pole_radius = std::max(ret.max_pole_radius, sec.pole_radius);
+        ret.peak_gain_db = sec.peak_gain_db;
+        ret.peak_freq = 0.5f * this->fs * static_cast<float>(peak - log_mag.begin()) / static_cast<float>(n_points - 1);
+        ret.sections.push_back(sec);
+    }
+
+    ret.stability_margin = 1.0f - ret.max_pole_radius;
+    ret.stable = ret.max_pole_radius < 1.0f;
+
+    return ret;
+}
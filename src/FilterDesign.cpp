@@ -0,0 +1,363 @@
+#include <nfp/FilterDesign.hpp>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+using nfp::FilterFamily;
+using nfp::FilterSpec;
+using nfp::DigitalFilter;
+using nfp::BiquadFilter;
+using std::vector;
+
+using cd = std::complex<double>;
+
+static constexpr double PI = 3.14159265358979323846;
+static constexpr int MAX_ORDER = 64;
+static constexpr double IM_EPS = 1e-9;
+
+// Elliptic helpers after Orfanidis, "Lecture Notes on Elliptic Filter Design" (Landen transformations).
+static vector<double> landen(double k, int M = 7) {
+    vector<double> v;
+    v.reserve(M);
+
+    for (int n = 0; n < M; ++n) {
+        k = k / (1 + std::sqrt(1 - k * k));
+        k *= k;
+        v.push_back(k);
+    }
+
+    return v;
+}
+
+static double ellipk(double k) {
+    double K = PI / 2;
+
+    for (double vn : landen(k))
+        K *= 1 + vn;
+
+    return K;
+}
+
+static double ellipk_prime(double k) {
+    return ellipk(std::sqrt(1 - k * k));
+}
+
+static cd cde(cd u, double k) {
+    auto v = landen(k);
+    cd w = std::cos(u * PI / 2.0);
+
+    for (size_t n = v.size(); n-- > 0; )
+        w = (1 + v[n]) * w / (1.0 + v[n] * w * w);
+
+    return w;
+}
+
+static cd sne(cd u, double k) {
+    auto v = landen(k);
+    cd w = std::sin(u * PI / 2.0);
+
+    for (size_t n = v.size(); n-- > 0; )
+        w = (1 + v[n]) * w / (1.0 + v[n] * w * w);
+
+    return w;
+}
+
+static double srem(double x, double y) {
+    return x - y * std::round(x / y);
+}
+
+static cd acde(cd w, double k) {
+    auto v = landen(k);
+
+    for (size_t n = 0; n < v.size(); ++n) {
+        double v1 = n == 0 ? k : v[n - 1];
+        w = w / (1.0 + std::sqrt(1.0 - w * w * v1 * v1)) * 2.0 / (1 + v[n]);
+    }
+
+    cd u = 2.0 / PI * std::acos(w);
+    double R = ellipk_prime(k) / ellipk(k);
+
+    return cd(srem(u.real(), 4), srem(u.imag(), 2 * R));
+}
+
+static cd asne(cd w, double k) {
+    return 1.0 - acde(w, k);
+}
+
+static double ellipdeg(int N, double k1) {
+    double k1p = std::sqrt(1 - k1 * k1);
+    double prod = 1;
+
+    for (int i = 1; i <= N / 2; ++i)
+        prod *= sne((2.0 * i - 1) / N, k1p).real();
+
+    double kp = std::pow(k1p, N) * std::pow(prod, 4);
+    return std::sqrt(1 - kp * kp);
+}
+
+struct SpecParams {
+    bool high_pass;
+    double omega_p;
+    double selectivity;
+    double eps_p;
+    double eps_s;
+};
+
+static SpecParams spec_params(const FilterSpec& spec) {
+    if (!(spec.pass_w > 0 && spec.pass_w < PI && spec.stop_w > 0 && spec.stop_w < PI))
+        throw std::runtime_error("Filter edges must lie between 0 and the Nyquist frequency!");
+
+    if (spec.pass_w == spec.stop_w)
+        throw std::runtime_error("Filter pass and stop edges must differ!");
+
+    if (spec.ripple_db <= 0 || spec.attenuation_db <= spec.ripple_db)
+        throw std::runtime_error("Filter attenuation must exceed a non-zero passband ripple!");
+
+    SpecParams p;
+    p.high_pass = spec.pass_w > spec.stop_w;
+
+    double omega_s = std::tan(spec.stop_w / 2.0);
+    p.omega_p = std::tan(spec.pass_w / 2.0);
+    p.selectivity = p.high_pass ? omega_s / p.omega_p : p.omega_p / omega_s;
+    p.eps_p = std::sqrt(std::pow(10.0, spec.ripple_db / 10.0) - 1);
+    p.eps_s = std::sqrt(std::pow(10.0, spec.attenuation_db / 10.0) - 1);
+
+    return p;
+}
+
+static int order_of(FilterFamily family, const SpecParams& p) {
+    const double k = p.selectivity;
+    const double k1 = p.eps_p / p.eps_s;
+    double n;
+
+    switch (family) {
+        case FilterFamily::BUTTERWORTH:
+            n = std::log(1 / k1) / std::log(1 / k);
+            break;
+        case FilterFamily::CHEBYSHEV1:
+        case FilterFamily::CHEBYSHEV2:
+            n = std::acosh(1 / k1) / std::acosh(1 / k);
+            break;
+        case FilterFamily::ELLIPTIC:
+            n = (ellipk(k) * ellipk_prime(k1)) / (ellipk_prime(k) * ellipk(k1));
+            break;
+        default:
+            throw std::runtime_error("Filter family must be explicit to compute an order!");
+    }
+
+    return std::max(1, static_cast<int>(std::ceil(n - 1e-9)));
+}
+
+int nfp::minimum_order(FilterFamily family, const FilterSpec& spec) {
+    return order_of(family, spec_params(spec));
+}
+
+FilterFamily nfp::cheapest_family(const FilterSpec& spec) {
+    static const FilterFamily preference[] = {
+        FilterFamily::BUTTERWORTH, FilterFamily::CHEBYSHEV2, FilterFamily::CHEBYSHEV1, FilterFamily::ELLIPTIC
+    };
+
+    auto p = spec_params(spec);
+    FilterFamily best = FilterFamily::BUTTERWORTH;
+    int best_sections = INT32_MAX;
+
+    for (auto family : preference) {
+        int sections = (order_of(family, p) + 1) / 2;
+
+        if (sections < best_sections) {
+            best = family;
+            best_sections = sections;
+        }
+    }
+
+    return best;
+}
+
+std::string nfp::family_name(FilterFamily family) {
+    switch (family) {
+        case FilterFamily::BUTTERWORTH: return "butterworth";
+        case FilterFamily::CHEBYSHEV1: return "chebyshev1";
+        case FilterFamily::CHEBYSHEV2: return "chebyshev2";
+        case FilterFamily::ELLIPTIC: return "elliptic";
+        default: return "auto";
+    }
+}
+
+// Analog low-pass prototype with the passband edge at 1 rad/s.
+struct Prototype {
+    vector<cd> poles;
+    vector<cd> zeros;
+    double gain;
+};
+
+static Prototype prototype(FilterFamily family, int N, const SpecParams& p) {
+    Prototype proto {{}, {}, 1.0};
+
+    switch (family) {
+        case FilterFamily::BUTTERWORTH: {
+            double wc = std::pow(p.eps_p, -1.0 / N);
+            for (int k = 0; k < N; ++k)
+                proto.poles.push_back(wc * std::exp(cd(0, PI * (2.0 * k + N + 1) / (2.0 * N))));
+            break;
+        }
+        case FilterFamily::CHEBYSHEV1: {
+            double v0 = std::asinh(1 / p.eps_p) / N;
+            for (int k = 0; k < N; ++k) {
+                double th = PI * (2.0 * k + 1) / (2.0 * N);
+                proto.poles.push_back(cd(-std::sinh(v0) * std::sin(th), std::cosh(v0) * std::cos(th)));
+            }
+            proto.gain = N % 2 ? 1.0 : 1.0 / std::sqrt(1 + p.eps_p * p.eps_p);
+            break;
+        }
+        case FilterFamily::CHEBYSHEV2: {
+            double v0 = std::asinh(p.eps_s) / N;
+            double ws = 1 / p.selectivity;
+            for (int k = 0; k < N; ++k) {
+                double th = PI * (2.0 * k + 1) / (2.0 * N);
+                proto.poles.push_back(ws / cd(-std::sinh(v0) * std::sin(th), std::cosh(v0) * std::cos(th)));
+                if (std::abs(std::cos(th)) > 1e-12)
+                    proto.zeros.push_back(cd(0, ws / std::cos(th)));
+            }
+            break;
+        }
+        case FilterFamily::ELLIPTIC: {
+            double k1 = p.eps_p / p.eps_s;
+            double k = ellipdeg(N, k1);
+            double v0 = (cd(0, -1) * asne(cd(0, 1 / p.eps_p), k1) / static_cast<double>(N)).real();
+
+            for (int i = 1; i <= N / 2; ++i) {
+                double u = (2.0 * i - 1) / N;
+                cd zeta = cde(u, k);
+                cd z = cd(0, 1) / (k * zeta);
+                cd pole = cd(0, 1) * cde(cd(u, -v0), k);
+
+                proto.zeros.push_back(z);
+                proto.zeros.push_back(std::conj(z));
+                proto.poles.push_back(pole);
+                proto.poles.push_back(std::conj(pole));
+            }
+
+            if (N % 2)
+                proto.poles.push_back(cd(0, 1) * sne(cd(0, v0), k));
+
+            proto.gain = N % 2 ? 1.0 : 1.0 / std::sqrt(1 + p.eps_p * p.eps_p);
+            break;
+        }
+        default:
+            break;
+    }
+
+    return proto;
+}
+
+static cd bilinear(cd s) {
+    return (1.0 + s) / (1.0 - s);
+}
+
+static cd eval_poly(double c0, double c1, double c2, cd z) {
+    return c0 + c1 / z + c2 / (z * z);
+}
+
+DigitalFilter nfp::design_filter(const FilterSpec& spec, FilterFamily family) {
+    auto p = spec_params(spec);
+
+    if (family == FilterFamily::AUTO)
+        family = cheapest_family(spec);
+
+    int N = order_of(family, p);
+
+    if (N > MAX_ORDER)
+        throw std::runtime_error("Filter spec requires order " + std::to_string(N) + " (max " + std::to_string(MAX_ORDER) + ")!");
+
+    Prototype proto = prototype(family, N, p);
+
+    vector<cd> poles, zeros;
+
+    for (auto s : proto.poles)
+        poles.push_back(bilinear(p.high_pass ? p.omega_p / s : p.omega_p * s));
+
+    for (auto s : proto.zeros)
+        zeros.push_back(bilinear(p.high_pass ? p.omega_p / s : p.omega_p * s));
+
+    // Zeros at analog infinity land on Nyquist (low-pass) or DC (high-pass).
+    while (zeros.size() < poles.size())
+        zeros.push_back(p.high_pass ? cd(1, 0) : cd(-1, 0));
+
+    vector<cd> cpoles, rpoles, czeros, rzeros;
+
+    for (auto z : poles) {
+        if (z.imag() > IM_EPS) cpoles.push_back(z);
+        else if (std::abs(z.imag()) <= IM_EPS) rpoles.push_back(cd(z.real(), 0));
+    }
+
+    for (auto z : zeros) {
+        if (z.imag() > IM_EPS) czeros.push_back(z);
+        else if (std::abs(z.imag()) <= IM_EPS) rzeros.push_back(cd(z.real(), 0));
+    }
+
+    struct Section { double a1, a2, b1, b2, radius; };
+    vector<Section> sections;
+
+    for (auto pole : cpoles) {
+        Section sec {-2 * pole.real(), std::norm(pole), 0, 0, std::abs(pole)};
+
+        if (!czeros.empty()) {
+            auto nearest = std::min_element(czeros.begin(), czeros.end(), [pole](cd a, cd b) {
+                return std::abs(a - pole) < std::abs(b - pole);
+            });
+            sec.b1 = -2 * nearest->real();
+            sec.b2 = std::norm(*nearest);
+            czeros.erase(nearest);
+        } else if (rzeros.size() >= 2) {
+            sec.b1 = -(rzeros[0].real() + rzeros[1].real());
+            sec.b2 = rzeros[0].real() * rzeros[1].real();
+            rzeros.erase(rzeros.begin(), rzeros.begin() + 2);
+        }
+
+        sections.push_back(sec);
+    }
+
+    for (size_t i = 0; i < rpoles.size(); i += 2) {
+        Section sec {0, 0, 0, 0, std::abs(rpoles[i])};
+
+        if (i + 1 < rpoles.size()) {
+            sec.a1 = -(rpoles[i].real() + rpoles[i + 1].real());
+            sec.a2 = rpoles[i].real() * rpoles[i + 1].real();
+            sec.radius = std::max(sec.radius, std::abs(rpoles[i + 1]));
+        } else {
+            sec.a1 = -rpoles[i].real();
+        }
+
+        size_t n_zeros = i + 1 < rpoles.size() ? 2 : 1;
+
+        if (rzeros.size() >= n_zeros) {
+            sec.b1 = n_zeros == 2 ? -(rzeros[0].real() + rzeros[1].real()) : -rzeros[0].real();
+            sec.b2 = n_zeros == 2 ? rzeros[0].real() * rzeros[1].real() : 0;
+            rzeros.erase(rzeros.begin(), rzeros.begin() + n_zeros);
+        }
+
+        sections.push_back(sec);
+    }
+
+    std::sort(sections.begin(), sections.end(), [](const Section& a, const Section& b) {
+        return a.radius > b.radius;
+    });
+
+    const cd z_ref = p.high_pass ? cd(-1, 0) : cd(1, 0);
+    vector<BiquadFilter> cascade;
+
+    for (size_t i = 0; i < sections.size(); ++i) {
+        const auto& sec = sections[i];
+        double g = std::abs(eval_poly(1, sec.a1, sec.a2, z_ref) / eval_poly(1, sec.b1, sec.b2, z_ref));
+
+        if (i == 0)
+            g *= proto.gain;
+
+        cascade.push_back(BiquadFilter(1.0f, static_cast<float>(sec.a1), static_cast<float>(sec.a2),
+            static_cast<float>(g), static_cast<float>(g * sec.b1), static_cast<float>(g * sec.b2)));
+    }
+
+    return DigitalFilter::from_sections(spec.pass_w, std::move(cascade));
+}
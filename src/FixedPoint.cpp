@@ -0,0 +1,249 @@
+#include <nfp/FixedPoint.hpp>
+#include <nfp/Kernels.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define NFP_SSE2 1
+#endif
+
+using nfp::FixedPointFilter;
+using std::vector;
+
+static constexpr int STATE_PER_SECTION = 5;
+static constexpr int COEFF_BITS = 29;
+
+static inline int32_t saturate32(int64_t x) {
+    return static_cast<int32_t>(std::clamp<int64_t>(x, INT32_MIN, INT32_MAX));
+}
+
+int16_t nfp::to_q15(float x) {
+    float y = std::nearbyint(std::clamp(x * 32768.0f, -32768.0f, 32767.0f));
+    return static_cast<int16_t>(y);
+}
+
+void nfp::q15_from_float(const float * in, int16_t * out, size_t n) {
+    nfp::kernels().q15_from_float(in, out, n);
+}
+
+void nfp::float_from_q15(const int16_t * in, float * out, size_t n) {
+    nfp::kernels().float_from_q15(in, out, n);
+}
+
+void nfp::scale_q15(int16_t * x, size_t n, int16_t gain) {
+    nfp::kernels().scale_q15(x, n, gain);
+}
+
+// Q15 input block widened to the Q31 working format.
+static void q31_from_q15(const int16_t * in, int32_t * out, size_t n) {
+    size_t i = 0;
+
+    #ifdef NFP_SSE2
+        const __m128i zero = _mm_setzero_si128();
+
+        for (; i + 8 <= n; i += 8) {
+            __m128i q = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_unpacklo_epi16(zero, q));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 4), _mm_unpackhi_epi16(zero, q));
+        }
+    #endif
+
+    for (; i < n; ++i)
+        out[i] = static_cast<int32_t>(in[i]) * 65536;
+}
+
+// Rounds Q31 back to Q15; ((x >> 15) + 1) >> 1 cannot overflow and packs saturate.
+static void q15_from_q31(const int32_t * in, int16_t * out, size_t n) {
+    size_t i = 0;
+
+    #ifdef NFP_SSE2
+        const __m128i one = _mm_set1_epi32(1);
+
+        for (; i + 8 <= n; i += 8) {
+            __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+            __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 4));
+            lo = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(lo, 15), one), 1);
+            hi = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(hi, 15), one), 1);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packs_epi32(lo, hi));
+        }
+    #endif
+
+    for (; i < n; ++i)
+        out[i] = static_cast<int16_t>(std::clamp(((in[i] >> 15) + 1) >> 1, -32768, 32767));
+}
+
+FixedPointFilter::FixedPointFilter(const vector<float> & coeffs) {
+    if (coeffs.size() % 6 != 0)
+        throw std::runtime_error("Coefficients must be grouped in sections of 6!");
+
+    vector<Section> secs;
+    vector<double> pending;
+    double gain = 1.0;
+
+    for (size_t i = 0; i < coeffs.size(); i += 6) {
+        double a0 = coeffs[i];
+
+        if (a0 == 0.0)
+            throw std::runtime_error("Section with a0 = 0 can't be quantized!");
+
+        double c[5] = {coeffs[i+3] / a0, coeffs[i+4] / a0, coeffs[i+5] / a0, coeffs[i+1] / a0, coeffs[i+2] / a0};
+
+        // Pure gains are folded into the next filtering section instead of costing a pass.
+        if (c[1] == 0.0 && c[2] == 0.0 && c[3] == 0.0 && c[4] == 0.0) {
+            gain *= c[0];
+            continue;
+        }
+
+        for (int k = 0; k < 3; ++k)
+            c[k] *= gain;
+        gain = 1.0;
+
+        pending.insert(pending.end(), c, c + 5);
+    }
+
+    if (pending.empty() || gain != 1.0)
+        pending.insert(pending.end(), {gain, 0.0, 0.0, 0.0, 0.0});
+
+    for (size_t i = 0; i < pending.size(); i += 5) {
+        double peak = 0.0;
+        for (int k = 0; k < 5; ++k)
+            peak = std::max(peak, std::fabs(pending[i + k]));
+
+        int int_bits = 0;
+        while (int_bits < COEFF_BITS && peak >= std::ldexp(1.0, int_bits))
+            ++int_bits;
+
+        if (peak >= std::ldexp(1.0, COEFF_BITS))
+            throw std::runtime_error("Section coefficients are too large for Q31 quantization!");
+
+        Section s;
+        s.frac_bits = COEFF_BITS - int_bits;
+
+        int32_t * q[5] = {&s.b0, &s.b1, &s.b2, &s.a1, &s.a2};
+        for (int k = 0; k < 5; ++k)
+            *q[k] = static_cast<int32_t>(std::llround(std::ldexp(pending[i + k], s.frac_bits)));
+
+        secs.push_back(s);
+    }
+
+    this->state.assign(secs.size() * STATE_PER_SECTION, 0);
+    this->sections = std::make_shared<const vector<Section>>(std::move(secs));
+}
+
+void FixedPointFilter::processBlock(const int16_t * input, int16_t * output, size_t n) {
+    if (this->empty()) {
+        std::copy(input, input + n, output);
+        return;
+    }
+
+    int32_t buf[256];
+
+    for (size_t off = 0; off < n; off += 256) {
+        const size_t len = std::min<size_t>(256, n - off);
+        q31_from_q15(input + off, buf, len);
+
+        int32_t * st = this->state.data();
+
+        for (const auto & s : *this->sections) {
+            int64_t x1 = st[0], x2 = st[1], y1 = st[2], y2 = st[3], err = st[4];
+            const int64_t mask = (int64_t{1} << s.frac_bits) - 1;
+
+            for (size_t i = 0; i < len; ++i) {
+                const int64_t x = buf[i];
+                int64_t acc = s.b0 * x + s.b1 * x1 + s.b2 * x2 - s.a1 * y1 - s.a2 * y2 + err;
+
+                // Truncation residue is fed back into the next sample, shaping the noise away from DC.
+                err = acc & mask;
+                int64_t y = saturate32(acc >> s.frac_bits);
+
+                x2 = x1; x1 = x;
+                y2 = y1; y1 = y;
+                buf[i] = static_cast<int32_t>(y);
+            }
+
+            st[0] = static_cast<int32_t>(x1); st[1] = static_cast<int32_t>(x2);
+            st[2] = static_cast<int32_t>(y1); st[3] = static_cast<int32_t>(y2);
+            st[4] = static_cast<int32_t>(err);
+            st += STATE_PER_SECTION;
+        }
+
+        q15_from_q31(buf, output + off, len);
+    }
+}
+
+void FixedPointFilter::reset() {
+    std::fill(this->state.begin(), this->state.end(), 0);
+}
+
+// Error feedback residue is left out: it is below one Q31 LSB of output and never decays to zero.
+bool FixedPointFilter::quiescent(int32_t threshold) const {
+    for (size_t i = 0; i < this->state.size(); i += STATE_PER_SECTION)
+        for (size_t k = 0; k < 4; ++k)
+            if (std::abs(static_cast<int64_t>(this->state[i + k])) >= threshold)
+                return false;
+
+    return true;
+}
+
+void FixedPointFilter::save_state(std::vector<unsigned char> & out) const {
+    const auto * p = reinterpret_cast<const unsigned char *>(this->state.data());
+    out.insert(out.end(), p, p + this->state_bytes());
+}
+
+const unsigned char * FixedPointFilter::load_state(const unsigned char * in) {
+    std::memcpy(this->state.data(), in, this->state_bytes());
+    return in + this->state_bytes();
+}
+
+FixedPointFilter FixedPointFilter::clone(std::pmr::memory_resource * arena) const {
+    FixedPointFilter ret {arena};
+    ret.sections = this->sections;
+    ret.state.assign(this->state.size(), 0);
+    return ret;
+}
+
+float nfp::quantization_snr(const vector<float> & coeffs, const FixedPointFilter & filter, size_t n_samples) {
+    FixedPointFilter q = filter.clone();
+    vector<int16_t> in(n_samples), out(n_samples);
+
+    uint32_t seed = 0x12345678u;
+    for (auto & x : in) {
+        seed = seed * 1664525u + 1013904223u;
+        x = static_cast<int16_t>(static_cast<int32_t>(seed >> 16) / 4 - 8192);
+    }
+
+    q.processBlock(in.data(), out.data(), n_samples);
+
+    vector<double> ref(n_samples);
+    for (size_t k = 0; k < n_samples; ++k)
+        ref[k] = in[k] / 32768.0;
+
+    for (size_t i = 0; i < coeffs.size(); i += 6) {
+        const double a0 = coeffs[i], a1 = coeffs[i+1] / a0, a2 = coeffs[i+2] / a0;
+        const double b0 = coeffs[i+3] / a0, b1 = coeffs[i+4] / a0, b2 = coeffs[i+5] / a0;
+        double v1 = 0, v2 = 0;
+
+        for (auto & x : ref) {
+            double v = x - a1 * v1 - a2 * v2;
+            x = b0 * v + b1 * v1 + b2 * v2;
+            v2 = v1;
+            v1 = v;
+        }
+    }
+
+    double signal = 0, noise = 0;
+    for (size_t k = 0; k < n_samples; ++k) {
+        double e = ref[k] - out[k] / 32768.0;
+        signal += ref[k] * ref[k];
+        noise += e * e;
+    }
+
+    if (noise == 0.0)
+        return std::numeric_limits<float>::infinity();
+
+    return static_cast<float>(10.0 * std::log10(signal / noise));
+}
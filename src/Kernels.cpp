@@ -0,0 +1,158 @@
+#include <nfp/Kernels.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+using nfp::ISA;
+using nfp::Kernels;
+
+// Portable versions, also the reference the others must match bit for bit.
+static void cascade(const float * c, float * st, size_t sections, const float * in, float * out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        float z = in[i];
+
+        for (size_t s = 0; s < sections; ++s) {
+            const float * k = c + 5 * s;
+            float * vs = st + 2 * s;
+            const float v = z - k[0] * vs[0] - k[1] * vs[1];
+            z = k[2] * v + k[3] * vs[0] + k[4] * vs[1];
+            vs[1] = vs[0];
+            vs[0] = v;
+        }
+
+        out[i] = z;
+    }
+}
+
+static void scale(const float * in, float * out, size_t n, float gain) {
+    for (size_t i = 0; i < n; ++i)
+        out[i] = gain * in[i];
+}
+
+static void fade(const float * in, float * out, size_t n, float start, float step) {
+    for (size_t i = 0; i < n; ++i)
+        out[i] = std::max(0.0f, start - step * static_cast<float>(i)) * in[i];
+}
+
+static void crossfade(const float * from, float * to, size_t n, size_t steps, float gain) {
+    for (size_t i = 0; i < n; ++i) {
+        const float w = static_cast<float>(i + 1) / static_cast<float>(steps);
+        to[i] = w * to[i] + (1.0f - w) * gain * from[i];
+    }
+}
+
+static void q15_from_float(const float * in, int16_t * out, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        out[i] = static_cast<int16_t>(std::nearbyint(std::clamp(in[i] * 32768.0f, -32768.0f, 32767.0f)));
+}
+
+static void float_from_q15(const int16_t * in, float * out, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        out[i] = static_cast<float>(in[i]) * (1.0f / 32768.0f);
+}
+
+// Same rounding as pmulhrsw, including its wrap of -1 * -1.
+static void scale_q15(int16_t * x, size_t n, int16_t gain) {
+    for (size_t i = 0; i < n; ++i)
+        x[i] = static_cast<int16_t>((static_cast<int32_t>(x[i]) * gain + 0x4000) >> 15);
+}
+
+const Kernels nfp::scalar_kernels {ISA::SCALAR, cascade, scale, fade, crossfade, q15_from_float, float_from_q15, scale_q15};
+
+static const Kernels * set_of(ISA isa) {
+    switch (isa) {
+        #ifdef NFP_KERNELS_SSE2
+            case ISA::SSE2: return &nfp::sse2_kernels;
+        #endif
+        #ifdef NFP_KERNELS_AVX2
+            case ISA::AVX2: return &nfp::avx2_kernels;
+        #endif
+        #ifdef NFP_KERNELS_AVX512
+            case ISA::AVX512: return &nfp::avx512_kernels;
+        #endif
+        #ifdef NFP_KERNELS_NEON
+            case ISA::NEON: return &nfp::neon_kernels;
+        #endif
+        default: return &nfp::scalar_kernels;
+    }
+}
+
+bool nfp::isa_supported(ISA isa) {
+    #if defined(NFP_KERNELS_AVX2) || defined(NFP_KERNELS_AVX512)
+        __builtin_cpu_init();
+    #endif
+
+    switch (isa) {
+        case ISA::SCALAR: return true;
+        #ifdef NFP_KERNELS_SSE2
+            case ISA::SSE2: return true;
+        #endif
+        #ifdef NFP_KERNELS_AVX2
+            case ISA::AVX2: return __builtin_cpu_supports("avx2");
+        #endif
+        #ifdef NFP_KERNELS_AVX512
+            case ISA::AVX512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+        #endif
+        #ifdef NFP_KERNELS_NEON
+            case ISA::NEON: return true;
+        #endif
+        default: return false;
+    }
+}
+
+ISA nfp::best_isa() {
+    for (ISA isa : {ISA::AVX512, ISA::AVX2, ISA::SSE2, ISA::NEON})
+        if (isa_supported(isa))
+            return isa;
+
+    return ISA::SCALAR;
+}
+
+// NFP_ISA is checked again by app, which reports a bad one; here it is just skipped.
+static std::atomic<const Kernels *> & active() {
+    static std::atomic<const Kernels *> set {[] {
+        ISA isa = nfp::best_isa();
+
+        if (const char * name = std::getenv("NFP_ISA")) {
+            try {
+                if (nfp::isa_supported(nfp::isa_from_name(name)))
+                    isa = nfp::isa_from_name(name);
+            } catch (const std::runtime_error&) {}
+        }
+
+        return set_of(isa);
+    }()};
+
+    return set;
+}
+
+const Kernels & nfp::kernels() {
+    return *active().load(std::memory_order_relaxed);
+}
+
+void nfp::select_isa(ISA isa) {
+    if (!isa_supported(isa))
+        throw std::runtime_error(std::string(isa_name(isa)) + " kernels aren't available on this host!");
+
+    active().store(set_of(isa), std::memory_order_relaxed);
+}
+
+const char * nfp::isa_name(ISA isa) {
+    switch (isa) {
+        case ISA::SSE2: return "sse2";
+        case ISA::AVX2: return "avx2";
+        case ISA::AVX512: return "avx512";
+        case ISA::NEON: return "neon";
+        default: return "scalar";
+    }
+}
+
+ISA nfp::isa_from_name(const std::string& name) {
+    for (ISA isa : {ISA::SCALAR, ISA::SSE2, ISA::AVX2, ISA::AVX512, ISA::NEON})
+        if (name == isa_name(isa))
+            return isa;
+
+    throw std::runtime_error(name + " is not a valid instruction set!");
+}
@@ -0,0 +1,165 @@
+#include <nfp/Kernels.hpp>
+#include <immintrin.h>
+
+// Built with -mavx2 and only reached after the cpuid check; see KernelsSSE2.cpp for the lane layout.
+namespace {
+
+    constexpr size_t W = 8;
+    constexpr size_t MIN_LANES = 3;
+    constexpr size_t CHUNK = 4096;
+
+    void cascade_lanes(const float * c, float * st, size_t m, const float * in, float * out, size_t n) {
+        alignas(32) float k[5][W] = {}, s[2][W] = {}, y_lanes[W];
+
+        for (size_t j = 0; j < m; ++j) {
+            for (size_t q = 0; q < 5; ++q)
+                k[q][j] = c[5 * j + q];
+            s[0][j] = st[2 * j];
+            s[1][j] = st[2 * j + 1];
+        }
+
+        const __m256 a1 = _mm256_load_ps(k[0]), a2 = _mm256_load_ps(k[1]);
+        const __m256 b0 = _mm256_load_ps(k[2]), b1 = _mm256_load_ps(k[3]), b2 = _mm256_load_ps(k[4]);
+        const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i up = _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6);
+        __m256 s0 = _mm256_load_ps(s[0]), s1 = _mm256_load_ps(s[1]), y = _mm256_setzero_ps();
+
+        for (size_t t = 0; t < n + m - 1; ++t) {
+            const float x = t < n ? in[t] : 0.0f;
+            const __m256 u = _mm256_blend_ps(_mm256_permutevar8x32_ps(y, up), _mm256_set1_ps(x), 1);
+            const __m256 v = _mm256_sub_ps(_mm256_sub_ps(u, _mm256_mul_ps(a1, s0)), _mm256_mul_ps(a2, s1));
+            y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b0, v), _mm256_mul_ps(b1, s0)), _mm256_mul_ps(b2, s1));
+
+            if (t + 1 >= m && t < n) {
+                s1 = s0;
+                s0 = v;
+            } else {
+                const __m256i now = _mm256_set1_epi32(static_cast<int>(t));
+                const __m256 on = _mm256_castsi256_ps(_mm256_andnot_si256(_mm256_cmpgt_epi32(lane, now),
+                    _mm256_cmpgt_epi32(_mm256_add_epi32(lane, _mm256_set1_epi32(static_cast<int>(n))), now)));
+                s1 = _mm256_blendv_ps(s1, s0, on);
+                s0 = _mm256_blendv_ps(s0, v, on);
+            }
+
+            if (t + 1 >= m) {
+                _mm256_store_ps(y_lanes, y);
+                out[t + 1 - m] = y_lanes[m - 1];
+            }
+        }
+
+        _mm256_store_ps(s[0], s0);
+        _mm256_store_ps(s[1], s1);
+
+        for (size_t j = 0; j < m; ++j) {
+            st[2 * j] = s[0][j];
+            st[2 * j + 1] = s[1][j];
+        }
+    }
+
+    void cascade(const float * c, float * st, size_t sections, const float * in, float * out, size_t n) {
+        for (size_t i = 0; i < n; i += CHUNK) {
+            const size_t len = n - i < CHUNK ? n - i : CHUNK;
+            const float * src = in + i;
+
+            for (size_t k = 0; k < sections; k += W) {
+                const size_t m = sections - k < W ? sections - k : W;
+
+                if (m >= MIN_LANES)
+                    cascade_lanes(c + 5 * k, st + 2 * k, m, src, out + i, len);
+                else
+                    nfp::scalar_kernels.cascade(c + 5 * k, st + 2 * k, m, src, out + i, len);
+
+                src = out + i;
+            }
+        }
+    }
+
+    void scale(const float * in, float * out, size_t n, float gain) {
+        const __m256 g = _mm256_set1_ps(gain);
+        size_t i = 0;
+
+        for (; i + W <= n; i += W)
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(g, _mm256_loadu_ps(in + i)));
+
+        for (; i < n; ++i)
+            out[i] = gain * in[i];
+    }
+
+    void fade(const float * in, float * out, size_t n, float start, float step) {
+        const __m256 s = _mm256_set1_ps(start), d = _mm256_set1_ps(step), zero = _mm256_setzero_ps();
+        __m256 idx = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+        size_t i = 0;
+
+        for (; i + W <= n; i += W) {
+            const __m256 g = _mm256_max_ps(_mm256_sub_ps(s, _mm256_mul_ps(d, idx)), zero);
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(g, _mm256_loadu_ps(in + i)));
+            idx = _mm256_add_ps(idx, _mm256_set1_ps(W));
+        }
+
+        for (; i < n; ++i) {
+            const float g = start - step * static_cast<float>(i);
+            out[i] = (0.0f < g ? g : 0.0f) * in[i];
+        }
+    }
+
+    void crossfade(const float * from, float * to, size_t n, size_t steps, float gain) {
+        const __m256 total = _mm256_set1_ps(static_cast<float>(steps)), one = _mm256_set1_ps(1.0f), g = _mm256_set1_ps(gain);
+        __m256 idx = _mm256_setr_ps(1, 2, 3, 4, 5, 6, 7, 8);
+        size_t i = 0;
+
+        for (; i + W <= n; i += W) {
+            const __m256 w = _mm256_div_ps(idx, total);
+            const __m256 mixed = _mm256_add_ps(_mm256_mul_ps(w, _mm256_loadu_ps(to + i)),
+                _mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(one, w), g), _mm256_loadu_ps(from + i)));
+            _mm256_storeu_ps(to + i, mixed);
+            idx = _mm256_add_ps(idx, _mm256_set1_ps(W));
+        }
+
+        for (; i < n; ++i) {
+            const float w = static_cast<float>(i + 1) / static_cast<float>(steps);
+            to[i] = w * to[i] + (1.0f - w) * gain * from[i];
+        }
+    }
+
+    void q15_from_float(const float * in, int16_t * out, size_t n) {
+        const __m256 scale = _mm256_set1_ps(32768.0f), lo = _mm256_set1_ps(-32768.0f), hi = _mm256_set1_ps(32767.0f);
+        size_t i = 0;
+
+        for (; i + 16 <= n; i += 16) {
+            __m256 x0 = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), scale), lo), hi);
+            __m256 x1 = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i + 8), scale), lo), hi);
+            // packs works within 128-bit halves; the permute puts the quarters back in order.
+            __m256i q = _mm256_packs_epi32(_mm256_cvtps_epi32(x0), _mm256_cvtps_epi32(x1));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_permute4x64_epi64(q, 0xD8));
+        }
+
+        nfp::scalar_kernels.q15_from_float(in + i, out + i, n - i);
+    }
+
+    void float_from_q15(const int16_t * in, float * out, size_t n) {
+        const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+        size_t i = 0;
+
+        for (; i + W <= n; i += W) {
+            __m256i q = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(q), scale));
+        }
+
+        nfp::scalar_kernels.float_from_q15(in + i, out + i, n - i);
+    }
+
+    void scale_q15(int16_t * x, size_t n, int16_t gain) {
+        const __m256i g = _mm256_set1_epi16(gain);
+        size_t i = 0;
+
+        for (; i + 16 <= n; i += 16) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(x + i), _mm256_mulhrs_epi16(v, g));
+        }
+
+        nfp::scalar_kernels.scale_q15(x + i, n - i, gain);
+    }
+
+}
+
+const nfp::Kernels nfp::avx2_kernels {nfp::ISA::AVX2, cascade, scale, fade, crossfade, q15_from_float, float_from_q15, scale_q15};
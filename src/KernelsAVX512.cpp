@@ -0,0 +1,166 @@
+#include <nfp/Kernels.hpp>
+#include <immintrin.h>
+
+// Built with -mavx512f -mavx512bw and only reached after the cpuid check; see KernelsSSE2.cpp for
+// the lane layout.
+namespace {
+
+    constexpr size_t W = 16;
+    // Up to this many sections the narrower permute of the AVX2 lanes is quicker.
+    constexpr size_t MIN_LANES = 9;
+    constexpr size_t CHUNK = 4096;
+
+    // Lanes 0..i.
+    __mmask16 lanes_upto(size_t i) {
+        return i >= W - 1 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((2u << i) - 1);
+    }
+
+    void cascade_lanes(const float * c, float * st, size_t m, const float * in, float * out, size_t n) {
+        alignas(64) float k[5][W] = {}, s[2][W] = {}, y_lanes[W];
+
+        for (size_t j = 0; j < m; ++j) {
+            for (size_t q = 0; q < 5; ++q)
+                k[q][j] = c[5 * j + q];
+            s[0][j] = st[2 * j];
+            s[1][j] = st[2 * j + 1];
+        }
+
+        const __m512 a1 = _mm512_load_ps(k[0]), a2 = _mm512_load_ps(k[1]);
+        const __m512 b0 = _mm512_load_ps(k[2]), b1 = _mm512_load_ps(k[3]), b2 = _mm512_load_ps(k[4]);
+        const __m512i up = _mm512_set_epi32(14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15);
+        __m512 s0 = _mm512_load_ps(s[0]), s1 = _mm512_load_ps(s[1]), y = _mm512_setzero_ps();
+
+        for (size_t t = 0; t < n + m - 1; ++t) {
+            const float x = t < n ? in[t] : 0.0f;
+            const __m512 u = _mm512_mask_broadcastss_ps(_mm512_permutexvar_ps(up, y), 1, _mm_set_ss(x));
+            const __m512 v = _mm512_sub_ps(_mm512_sub_ps(u, _mm512_mul_ps(a1, s0)), _mm512_mul_ps(a2, s1));
+            y = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(b0, v), _mm512_mul_ps(b1, s0)), _mm512_mul_ps(b2, s1));
+
+            if (t + 1 >= m && t < n) {
+                s1 = s0;
+                s0 = v;
+            } else {
+                const __mmask16 on = lanes_upto(t) & (t >= n ? ~lanes_upto(t - n) : 0xFFFF);
+                s1 = _mm512_mask_mov_ps(s1, on, s0);
+                s0 = _mm512_mask_mov_ps(s0, on, v);
+            }
+
+            if (t + 1 >= m) {
+                _mm512_store_ps(y_lanes, y);
+                out[t + 1 - m] = y_lanes[m - 1];
+            }
+        }
+
+        _mm512_store_ps(s[0], s0);
+        _mm512_store_ps(s[1], s1);
+
+        for (size_t j = 0; j < m; ++j) {
+            st[2 * j] = s[0][j];
+            st[2 * j + 1] = s[1][j];
+        }
+    }
+
+    void cascade(const float * c, float * st, size_t sections, const float * in, float * out, size_t n) {
+        for (size_t i = 0; i < n; i += CHUNK) {
+            const size_t len = n - i < CHUNK ? n - i : CHUNK;
+            const float * src = in + i;
+
+            for (size_t k = 0; k < sections; k += W) {
+                const size_t m = sections - k < W ? sections - k : W;
+
+                if (m >= MIN_LANES)
+                    cascade_lanes(c + 5 * k, st + 2 * k, m, src, out + i, len);
+                else
+                    nfp::avx2_kernels.cascade(c + 5 * k, st + 2 * k, m, src, out + i, len);
+
+                src = out + i;
+            }
+        }
+    }
+
+    void scale(const float * in, float * out, size_t n, float gain) {
+        const __m512 g = _mm512_set1_ps(gain);
+        size_t i = 0;
+
+        for (; i + W <= n; i += W)
+            _mm512_storeu_ps(out + i, _mm512_mul_ps(g, _mm512_loadu_ps(in + i)));
+
+        for (; i < n; ++i)
+            out[i] = gain * in[i];
+    }
+
+    void fade(const float * in, float * out, size_t n, float start, float step) {
+        const __m512 s = _mm512_set1_ps(start), d = _mm512_set1_ps(step), zero = _mm512_setzero_ps();
+        __m512 idx = _mm512_setr_ps(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        size_t i = 0;
+
+        for (; i + W <= n; i += W) {
+            const __m512 g = _mm512_max_ps(_mm512_sub_ps(s, _mm512_mul_ps(d, idx)), zero);
+            _mm512_storeu_ps(out + i, _mm512_mul_ps(g, _mm512_loadu_ps(in + i)));
+            idx = _mm512_add_ps(idx, _mm512_set1_ps(W));
+        }
+
+        for (; i < n; ++i) {
+            const float g = start - step * static_cast<float>(i);
+            out[i] = (0.0f < g ? g : 0.0f) * in[i];
+        }
+    }
+
+    void crossfade(const float * from, float * to, size_t n, size_t steps, float gain) {
+        const __m512 total = _mm512_set1_ps(static_cast<float>(steps)), one = _mm512_set1_ps(1.0f), g = _mm512_set1_ps(gain);
+        __m512 idx = _mm512_setr_ps(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+        size_t i = 0;
+
+        for (; i + W <= n; i += W) {
+            const __m512 w = _mm512_div_ps(idx, total);
+            const __m512 mixed = _mm512_add_ps(_mm512_mul_ps(w, _mm512_loadu_ps(to + i)),
+                _mm512_mul_ps(_mm512_mul_ps(_mm512_sub_ps(one, w), g), _mm512_loadu_ps(from + i)));
+            _mm512_storeu_ps(to + i, mixed);
+            idx = _mm512_add_ps(idx, _mm512_set1_ps(W));
+        }
+
+        for (; i < n; ++i) {
+            const float w = static_cast<float>(i + 1) / static_cast<float>(steps);
+            to[i] = w * to[i] + (1.0f - w) * gain * from[i];
+        }
+    }
+
+    void q15_from_float(const float * in, int16_t * out, size_t n) {
+        const __m512 scale = _mm512_set1_ps(32768.0f), lo = _mm512_set1_ps(-32768.0f), hi = _mm512_set1_ps(32767.0f);
+        size_t i = 0;
+
+        for (; i + W <= n; i += W) {
+            __m512 x = _mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(_mm512_loadu_ps(in + i), scale), lo), hi);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(x)));
+        }
+
+        nfp::scalar_kernels.q15_from_float(in + i, out + i, n - i);
+    }
+
+    void float_from_q15(const int16_t * in, float * out, size_t n) {
+        const __m512 scale = _mm512_set1_ps(1.0f / 32768.0f);
+        size_t i = 0;
+
+        for (; i + W <= n; i += W) {
+            __m512i q = _mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i)));
+            _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_cvtepi32_ps(q), scale));
+        }
+
+        nfp::scalar_kernels.float_from_q15(in + i, out + i, n - i);
+    }
+
+    void scale_q15(int16_t * x, size_t n, int16_t gain) {
+        const __m512i g = _mm512_set1_epi16(gain);
+        size_t i = 0;
+
+        for (; i + 32 <= n; i += 32) {
+            __m512i v = _mm512_loadu_si512(x + i);
+            _mm512_storeu_si512(x + i, _mm512_mulhrs_epi16(v, g));
+        }
+
+        nfp::scalar_kernels.scale_q15(x + i, n - i, gain);
+    }
+
+}
+
+const nfp::Kernels nfp::avx512_kernels {nfp::ISA::AVX512, cascade, scale, fade, crossfade, q15_from_float, float_from_q15, scale_q15};
@@ -0,0 +1,170 @@
+#include <nfp/Kernels.hpp>
+#include <arm_neon.h>
+
+// AArch64 always has NEON; see KernelsSSE2.cpp for the lane layout.
+namespace {
+
+    constexpr size_t W = 4;
+    constexpr size_t MIN_LANES = 3;
+    constexpr size_t CHUNK = 4096;
+
+    void cascade_lanes(const float * c, float * st, size_t m, const float * in, float * out, size_t n) {
+        alignas(16) float k[5][W] = {}, s[2][W] = {}, y_lanes[W];
+
+        for (size_t j = 0; j < m; ++j) {
+            for (size_t q = 0; q < 5; ++q)
+                k[q][j] = c[5 * j + q];
+            s[0][j] = st[2 * j];
+            s[1][j] = st[2 * j + 1];
+        }
+
+        const float32x4_t a1 = vld1q_f32(k[0]), a2 = vld1q_f32(k[1]);
+        const float32x4_t b0 = vld1q_f32(k[2]), b1 = vld1q_f32(k[3]), b2 = vld1q_f32(k[4]);
+        const int32_t lanes[W] = {0, 1, 2, 3};
+        const int32x4_t lane = vld1q_s32(lanes);
+        float32x4_t s0 = vld1q_f32(s[0]), s1 = vld1q_f32(s[1]), y = vdupq_n_f32(0.0f);
+
+        for (size_t t = 0; t < n + m - 1; ++t) {
+            const float x = t < n ? in[t] : 0.0f;
+            const float32x4_t u = vextq_f32(vdupq_n_f32(x), y, 3);
+            const float32x4_t v = vsubq_f32(vsubq_f32(u, vmulq_f32(a1, s0)), vmulq_f32(a2, s1));
+            y = vaddq_f32(vaddq_f32(vmulq_f32(b0, v), vmulq_f32(b1, s0)), vmulq_f32(b2, s1));
+
+            if (t + 1 >= m && t < n) {
+                s1 = s0;
+                s0 = v;
+            } else {
+                const int32x4_t now = vdupq_n_s32(static_cast<int32_t>(t));
+                const uint32x4_t on = vandq_u32(vcleq_s32(lane, now),
+                    vcgtq_s32(vaddq_s32(lane, vdupq_n_s32(static_cast<int32_t>(n))), now));
+                s1 = vbslq_f32(on, s0, s1);
+                s0 = vbslq_f32(on, v, s0);
+            }
+
+            if (t + 1 >= m) {
+                vst1q_f32(y_lanes, y);
+                out[t + 1 - m] = y_lanes[m - 1];
+            }
+        }
+
+        vst1q_f32(s[0], s0);
+        vst1q_f32(s[1], s1);
+
+        for (size_t j = 0; j < m; ++j) {
+            st[2 * j] = s[0][j];
+            st[2 * j + 1] = s[1][j];
+        }
+    }
+
+    void cascade(const float * c, float * st, size_t sections, const float * in, float * out, size_t n) {
+        for (size_t i = 0; i < n; i += CHUNK) {
+            const size_t len = n - i < CHUNK ? n - i : CHUNK;
+            const float * src = in + i;
+
+            for (size_t k = 0; k < sections; k += W) {
+                const size_t m = sections - k < W ? sections - k : W;
+
+                if (m >= MIN_LANES)
+                    cascade_lanes(c + 5 * k, st + 2 * k, m, src, out + i, len);
+                else
+                    nfp::scalar_kernels.cascade(c + 5 * k, st + 2 * k, m, src, out + i, len);
+
+                src = out + i;
+            }
+        }
+    }
+
+    void scale(const float * in, float * out, size_t n, float gain) {
+        size_t i = 0;
+
+        for (; i + W <= n; i += W)
+            vst1q_f32(out + i, vmulq_n_f32(vld1q_f32(in + i), gain));
+
+        for (; i < n; ++i)
+            out[i] = gain * in[i];
+    }
+
+    void fade(const float * in, float * out, size_t n, float start, float step) {
+        const float first[W] = {0.0f, 1.0f, 2.0f, 3.0f};
+        const float32x4_t s = vdupq_n_f32(start), d = vdupq_n_f32(step), zero = vdupq_n_f32(0.0f);
+        float32x4_t idx = vld1q_f32(first);
+        size_t i = 0;
+
+        for (; i + W <= n; i += W) {
+            const float32x4_t g = vsubq_f32(s, vmulq_f32(d, idx));
+            // vmaxq would keep a NaN gain; a compare and select matches the scalar max.
+            const float32x4_t clamped = vbslq_f32(vcltq_f32(zero, g), g, zero);
+            vst1q_f32(out + i, vmulq_f32(clamped, vld1q_f32(in + i)));
+            idx = vaddq_f32(idx, vdupq_n_f32(W));
+        }
+
+        for (; i < n; ++i) {
+            const float g = start - step * static_cast<float>(i);
+            out[i] = (0.0f < g ? g : 0.0f) * in[i];
+        }
+    }
+
+    void crossfade(const float * from, float * to, size_t n, size_t steps, float gain) {
+        const float first[W] = {1.0f, 2.0f, 3.0f, 4.0f};
+        const float32x4_t total = vdupq_n_f32(static_cast<float>(steps)), one = vdupq_n_f32(1.0f), g = vdupq_n_f32(gain);
+        float32x4_t idx = vld1q_f32(first);
+        size_t i = 0;
+
+        for (; i + W <= n; i += W) {
+            const float32x4_t w = vdivq_f32(idx, total);
+            const float32x4_t mixed = vaddq_f32(vmulq_f32(w, vld1q_f32(to + i)),
+                vmulq_f32(vmulq_f32(vsubq_f32(one, w), g), vld1q_f32(from + i)));
+            vst1q_f32(to + i, mixed);
+            idx = vaddq_f32(idx, vdupq_n_f32(W));
+        }
+
+        for (; i < n; ++i) {
+            const float w = static_cast<float>(i + 1) / static_cast<float>(steps);
+            to[i] = w * to[i] + (1.0f - w) * gain * from[i];
+        }
+    }
+
+    void q15_from_float(const float * in, int16_t * out, size_t n) {
+        const float32x4_t scale = vdupq_n_f32(32768.0f), lo = vdupq_n_f32(-32768.0f), hi = vdupq_n_f32(32767.0f);
+        size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            float32x4_t x0 = vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(in + i), scale), lo), hi);
+            float32x4_t x1 = vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(in + i + 4), scale), lo), hi);
+            vst1q_s16(out + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(x0)), vqmovn_s32(vcvtnq_s32_f32(x1))));
+        }
+
+        nfp::scalar_kernels.q15_from_float(in + i, out + i, n - i);
+    }
+
+    void float_from_q15(const int16_t * in, float * out, size_t n) {
+        size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            int16x8_t q = vld1q_s16(in + i);
+            vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(q))), 1.0f / 32768.0f));
+            vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(q))), 1.0f / 32768.0f));
+        }
+
+        nfp::scalar_kernels.float_from_q15(in + i, out + i, n - i);
+    }
+
+    // vqrdmulh saturates -1 * -1 where the others wrap, so round and narrow by hand.
+    void scale_q15(int16_t * x, size_t n, int16_t gain) {
+        const int16x4_t g = vdup_n_s16(gain);
+        const int32x4_t half = vdupq_n_s32(0x4000);
+        size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            int16x8_t v = vld1q_s16(x + i);
+            int16x4_t lo = vshrn_n_s32(vaddq_s32(vmull_s16(vget_low_s16(v), g), half), 15);
+            int16x4_t hi = vshrn_n_s32(vaddq_s32(vmull_s16(vget_high_s16(v), g), half), 15);
+            vst1q_s16(x + i, vcombine_s16(lo, hi));
+        }
+
+        nfp::scalar_kernels.scale_q15(x + i, n - i, gain);
+    }
+
+}
+
+const nfp::Kernels nfp::neon_kernels {nfp::ISA::NEON, cascade, scale, fade, crossfade, q15_from_float, float_from_q15, scale_q15};
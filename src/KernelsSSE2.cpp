@@ -0,0 +1,164 @@
+#include <nfp/Kernels.hpp>
+#include <emmintrin.h>
+
+// Everything here has internal linkage, so no out-of-line copy built for this file's target is shared
+// with the rest of the program; the same holds for the other instruction sets' files.
+namespace {
+
+    constexpr size_t W = 4;
+    // Fewer sections run faster sample by sample than a lane each.
+    constexpr size_t MIN_LANES = 3;
+    constexpr size_t CHUNK = 4096;
+
+    // A lane per section: at step t lane s filters sample t - s, fed by lane s - 1's output of the
+    // step before, so m sections advance together. During the first and last m - 1 steps the lanes
+    // outside the block keep their state.
+    void cascade_lanes(const float * c, float * st, size_t m, const float * in, float * out, size_t n) {
+        alignas(16) float k[5][W] = {}, s[2][W] = {}, y_lanes[W];
+
+        for (size_t j = 0; j < m; ++j) {
+            for (size_t q = 0; q < 5; ++q)
+                k[q][j] = c[5 * j + q];
+            s[0][j] = st[2 * j];
+            s[1][j] = st[2 * j + 1];
+        }
+
+        const __m128 a1 = _mm_load_ps(k[0]), a2 = _mm_load_ps(k[1]);
+        const __m128 b0 = _mm_load_ps(k[2]), b1 = _mm_load_ps(k[3]), b2 = _mm_load_ps(k[4]);
+        const __m128i lane = _mm_set_epi32(3, 2, 1, 0);
+        __m128 s0 = _mm_load_ps(s[0]), s1 = _mm_load_ps(s[1]), y = _mm_setzero_ps();
+
+        for (size_t t = 0; t < n + m - 1; ++t) {
+            const float x = t < n ? in[t] : 0.0f;
+            const __m128 u = _mm_move_ss(_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(y), 4)), _mm_set_ss(x));
+            const __m128 v = _mm_sub_ps(_mm_sub_ps(u, _mm_mul_ps(a1, s0)), _mm_mul_ps(a2, s1));
+            y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, v), _mm_mul_ps(b1, s0)), _mm_mul_ps(b2, s1));
+
+            if (t + 1 >= m && t < n) {
+                s1 = s0;
+                s0 = v;
+            } else {
+                const __m128i now = _mm_set1_epi32(static_cast<int>(t));
+                const __m128 on = _mm_castsi128_ps(_mm_andnot_si128(_mm_cmpgt_epi32(lane, now),
+                    _mm_cmpgt_epi32(_mm_add_epi32(lane, _mm_set1_epi32(static_cast<int>(n))), now)));
+                s1 = _mm_or_ps(_mm_and_ps(on, s0), _mm_andnot_ps(on, s1));
+                s0 = _mm_or_ps(_mm_and_ps(on, v), _mm_andnot_ps(on, s0));
+            }
+
+            if (t + 1 >= m) {
+                _mm_store_ps(y_lanes, y);
+                out[t + 1 - m] = y_lanes[m - 1];
+            }
+        }
+
+        _mm_store_ps(s[0], s0);
+        _mm_store_ps(s[1], s1);
+
+        for (size_t j = 0; j < m; ++j) {
+            st[2 * j] = s[0][j];
+            st[2 * j + 1] = s[1][j];
+        }
+    }
+
+    void cascade(const float * c, float * st, size_t sections, const float * in, float * out, size_t n) {
+        for (size_t i = 0; i < n; i += CHUNK) {
+            const size_t len = n - i < CHUNK ? n - i : CHUNK;
+            const float * src = in + i;
+
+            for (size_t k = 0; k < sections; k += W) {
+                const size_t m = sections - k < W ? sections - k : W;
+
+                if (m >= MIN_LANES)
+                    cascade_lanes(c + 5 * k, st + 2 * k, m, src, out + i, len);
+                else
+                    nfp::scalar_kernels.cascade(c + 5 * k, st + 2 * k, m, src, out + i, len);
+
+                src = out + i;
+            }
+        }
+    }
+
+    void scale(const float * in, float * out, size_t n, float gain) {
+        const __m128 g = _mm_set1_ps(gain);
+        size_t i = 0;
+
+        for (; i + W <= n; i += W)
+            _mm_storeu_ps(out + i, _mm_mul_ps(g, _mm_loadu_ps(in + i)));
+
+        for (; i < n; ++i)
+            out[i] = gain * in[i];
+    }
+
+    void fade(const float * in, float * out, size_t n, float start, float step) {
+        const __m128 s = _mm_set1_ps(start), d = _mm_set1_ps(step), zero = _mm_setzero_ps();
+        __m128 idx = _mm_set_ps(3, 2, 1, 0);
+        size_t i = 0;
+
+        for (; i + W <= n; i += W) {
+            const __m128 g = _mm_max_ps(_mm_sub_ps(s, _mm_mul_ps(d, idx)), zero);
+            _mm_storeu_ps(out + i, _mm_mul_ps(g, _mm_loadu_ps(in + i)));
+            idx = _mm_add_ps(idx, _mm_set1_ps(W));
+        }
+
+        for (; i < n; ++i) {
+            const float g = start - step * static_cast<float>(i);
+            out[i] = (0.0f < g ? g : 0.0f) * in[i];
+        }
+    }
+
+    void crossfade(const float * from, float * to, size_t n, size_t steps, float gain) {
+        const __m128 total = _mm_set1_ps(static_cast<float>(steps)), one = _mm_set1_ps(1.0f), g = _mm_set1_ps(gain);
+        __m128 idx = _mm_set_ps(4, 3, 2, 1);
+        size_t i = 0;
+
+        for (; i + W <= n; i += W) {
+            const __m128 w = _mm_div_ps(idx, total);
+            const __m128 mixed = _mm_add_ps(_mm_mul_ps(w, _mm_loadu_ps(to + i)), _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(one, w), g), _mm_loadu_ps(from + i)));
+            _mm_storeu_ps(to + i, mixed);
+            idx = _mm_add_ps(idx, _mm_set1_ps(W));
+        }
+
+        for (; i < n; ++i) {
+            const float w = static_cast<float>(i + 1) / static_cast<float>(steps);
+            to[i] = w * to[i] + (1.0f - w) * gain * from[i];
+        }
+    }
+
+    void q15_from_float(const float * in, int16_t * out, size_t n) {
+        const __m128 scale = _mm_set1_ps(32768.0f), lo = _mm_set1_ps(-32768.0f), hi = _mm_set1_ps(32767.0f);
+        size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            __m128 x0 = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), lo), hi);
+            __m128 x1 = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale), lo), hi);
+            __m128i q = _mm_packs_epi32(_mm_cvtps_epi32(x0), _mm_cvtps_epi32(x1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), q);
+        }
+
+        nfp::scalar_kernels.q15_from_float(in + i, out + i, n - i);
+    }
+
+    void float_from_q15(const int16_t * in, float * out, size_t n) {
+        const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+        size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            __m128i q = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(q, q), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(q, q), 16);
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+
+        nfp::scalar_kernels.float_from_q15(in + i, out + i, n - i);
+    }
+
+    // pmulhrsw needs SSSE3; same rounding and wrap of -1 * -1.
+    void scale_q15(int16_t * x, size_t n, int16_t gain) {
+        for (size_t i = 0; i < n; ++i)
+            x[i] = static_cast<int16_t>((static_cast<int32_t>(x[i]) * gain + 0x4000) >> 15);
+    }
+
+}
+
+const nfp::Kernels nfp::sse2_kernels {nfp::ISA::SSE2, cascade, scale, fade, crossfade, q15_from_float, float_from_q15, scale_q15};
@@ -0,0 +1,345 @@
+#include <nfp/OutputRing.hpp>
+#include <nfp/nfp_shm.h>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <signal.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef __linux__
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+#endif
+
+using nfp::OutputRing;
+using nfp::OutputRingReader;
+namespace layout = nfp::shm_layout;
+
+static_assert(offsetof(layout::Header, slot_bytes) == 12 && offsetof(layout::Header, capacity) == 16);
+static_assert(offsetof(layout::Header, slot_stride) == 24 && offsetof(layout::Header, closed) == 28);
+static_assert(offsetof(layout::Header, writer) == 32 && offsetof(layout::Header, write_seq) == 64);
+static_assert(offsetof(layout::Header, wake) == 128 && offsetof(layout::Header, waiters) == 132);
+static_assert(sizeof(layout::Header) <= layout::HEADER_BYTES);
+static_assert(sizeof(layout::Slot) == layout::SLOT_HEADER_BYTES && offsetof(layout::Slot, bytes) == 12);
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free);
+
+namespace {
+
+    // Readers sleep on the wake word; elsewhere they poll it.
+    void wait_for_change(std::atomic<uint32_t>& word, uint32_t seen, int timeout_ms) {
+        #ifdef __linux__
+            timespec ts {timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, seen, &ts, nullptr, 0);
+        #else
+            const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+            while (word.load() == seen && std::chrono::steady_clock::now() < until)
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+        #endif
+    }
+
+    void wake_all(std::atomic<uint32_t>& word) {
+        #ifdef __linux__
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        #else
+            (void) word;
+        #endif
+    }
+
+    size_t stride_of(size_t slot_bytes) {
+        return (layout::SLOT_HEADER_BYTES + slot_bytes + 63) / 64 * 64;
+    }
+
+}
+
+OutputRing::OutputRing(const std::string& name, size_t capacity, size_t slot_bytes) : name(name) {
+    #ifdef _WIN32
+        throw std::runtime_error("Shared-memory outputs need a POSIX host!");
+    #else
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+            throw std::runtime_error("Output ring slots must be a power of two!");
+
+        const std::string path = path_of(name);
+
+        // Readers of a ring left by an earlier run learn that it is gone.
+        const int old = ::shm_open(path.c_str(), O_RDWR, 0);
+
+        if (old >= 0) {
+            struct stat st;
+
+            if (::fstat(old, &st) == 0 && static_cast<size_t>(st.st_size) >= layout::HEADER_BYTES) {
+                void * p = ::mmap(nullptr, layout::HEADER_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, old, 0);
+
+                if (p != MAP_FAILED) {
+                    auto * h = static_cast<layout::Header *>(p);
+
+                    if (std::memcmp(h->magic, layout::MAGIC, sizeof(layout::MAGIC)) == 0) {
+                        h->closed = 1;
+                        h->wake.fetch_add(1);
+                        wake_all(h->wake);
+                    }
+
+                    ::munmap(p, layout::HEADER_BYTES);
+                }
+            }
+
+            ::close(old);
+            ::shm_unlink(path.c_str());
+        }
+
+        const int fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+
+        if (fd < 0)
+            throw std::runtime_error("Output ring " + name + " couldn't be created!");
+
+        this->mapped = layout::HEADER_BYTES + capacity * stride_of(slot_bytes);
+
+        void * p = ::ftruncate(fd, static_cast<off_t>(this->mapped)) == 0
+            ? ::mmap(nullptr, this->mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        struct stat st;
+        this->inode = ::fstat(fd, &st) == 0 ? static_cast<uint64_t>(st.st_ino) : 0;
+        ::close(fd);
+
+        if (p == MAP_FAILED) {
+            ::shm_unlink(path.c_str());
+            throw std::runtime_error("Output ring " + name + " couldn't be created!");
+        }
+
+        this->header = new (p) layout::Header{};
+        std::memcpy(this->header->magic, layout::MAGIC, sizeof(layout::MAGIC));
+        this->header->version = layout::VERSION;
+        this->header->slot_bytes = static_cast<uint32_t>(slot_bytes);
+        this->header->capacity = capacity;
+        this->header->slot_stride = static_cast<uint32_t>(stride_of(slot_bytes));
+        this->header->writer = ::getpid();
+        this->slots = static_cast<unsigned char *>(p) + layout::HEADER_BYTES;
+    #endif
+}
+
+OutputRing::~OutputRing() {
+    #ifndef _WIN32
+        if (!this->header)
+            return;
+
+        this->header->closed = 1;
+        this->header->wake.fetch_add(1);
+        wake_all(this->header->wake);
+
+        ::munmap(this->header, this->mapped);
+
+        // Unless a newer ring of the same name has replaced this one.
+        const std::string path = path_of(this->name);
+        const int fd = ::shm_open(path.c_str(), O_RDONLY, 0);
+        struct stat st;
+
+        if (fd >= 0) {
+            const bool ours = ::fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_ino) == this->inode;
+            ::close(fd);
+
+            if (ours)
+                ::shm_unlink(path.c_str());
+        }
+    #endif
+}
+
+// Slots are written as a seqlock: seq carries the WRITING bit while block s is copied in and
+// becomes s + 1 once it is whole. A writer stalled for a whole lap finds the slot taken by a later
+// block and drops its own, which readers count as lost like any overwritten block.
+bool OutputRing::write(const void * data, size_t bytes, uint16_t port, layout::FORMAT format) {
+    if (bytes > this->header->slot_bytes)
+        return false;
+
+    const uint64_t s = this->header->write_seq.fetch_add(1, std::memory_order_relaxed);
+    auto * slot = reinterpret_cast<layout::Slot *>(this->slots + (s & (this->header->capacity - 1)) * this->header->slot_stride);
+    uint64_t current = slot->seq.load(std::memory_order_relaxed);
+
+    for (;;) {
+        if (current & layout::WRITING) {
+            std::this_thread::yield();
+            current = slot->seq.load(std::memory_order_relaxed);
+        } else if (current > s + 1) {
+            return true;
+        } else if (slot->seq.compare_exchange_weak(current, (s + 1) | layout::WRITING, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->port = port;
+    slot->format = format;
+    slot->bytes = static_cast<uint32_t>(bytes);
+    std::memcpy(reinterpret_cast<unsigned char *>(slot) + layout::SLOT_HEADER_BYTES, data, bytes);
+
+    slot->seq.store(s + 1, std::memory_order_release);
+
+    this->header->wake.fetch_add(1);
+
+    if (this->header->waiters.load() > 0)
+        wake_all(this->header->wake);
+
+    return true;
+}
+
+OutputRingReader::OutputRingReader(const std::string& name) {
+    #ifdef _WIN32
+        throw std::runtime_error("Shared-memory outputs need a POSIX host!");
+    #else
+        const int fd = ::shm_open(OutputRing::path_of(name).c_str(), O_RDWR, 0);
+
+        if (fd < 0)
+            throw std::runtime_error("Output ring " + name + " doesn't exist!");
+
+        struct stat st;
+        void * p = MAP_FAILED;
+
+        if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= layout::HEADER_BYTES) {
+            this->mapped = static_cast<size_t>(st.st_size);
+            p = ::mmap(nullptr, this->mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+
+        ::close(fd);
+
+        if (p == MAP_FAILED)
+            throw std::runtime_error("Output ring " + name + " couldn't be mapped!");
+
+        this->header = static_cast<layout::Header *>(p);
+        this->slots = static_cast<unsigned char *>(p) + layout::HEADER_BYTES;
+
+        const bool ok = std::memcmp(this->header->magic, layout::MAGIC, sizeof(layout::MAGIC)) == 0
+            && this->header->version == layout::VERSION
+            && this->mapped == layout::HEADER_BYTES + this->header->capacity * this->header->slot_stride;
+
+        if (!ok) {
+            ::munmap(p, this->mapped);
+            this->header = nullptr;
+            throw std::runtime_error("Output ring " + name + " is not an output ring of this version!");
+        }
+
+        this->next = this->header->write_seq.load(std::memory_order_acquire);
+    #endif
+}
+
+OutputRingReader::~OutputRingReader() {
+    #ifndef _WIN32
+        if (this->header)
+            ::munmap(this->header, this->mapped);
+    #endif
+}
+
+const layout::Slot * OutputRingReader::slot(uint64_t seq) const {
+    return reinterpret_cast<const layout::Slot *>(this->slots + (seq & (this->header->capacity - 1)) * this->header->slot_stride);
+}
+
+int OutputRingReader::next_block(Block& b, int timeout_ms) {
+    #ifdef _WIN32
+        return -1;
+    #else
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout_ms, 0));
+        const uint64_t capacity = this->header->capacity;
+
+        for (;;) {
+            const uint32_t seen = this->header->wake.load(std::memory_order_acquire);
+            const uint64_t written = this->header->write_seq.load(std::memory_order_acquire);
+
+            if (written - this->next > capacity) {
+                this->lost_blocks += written - capacity - this->next;
+                this->next = written - capacity;
+            }
+
+            if (this->next < written) {
+                const layout::Slot * s = this->slot(this->next);
+                const uint64_t seq = s->seq.load(std::memory_order_acquire);
+
+                if (seq == this->next + 1) {
+                    b = Block{this->next, s->port, static_cast<layout::FORMAT>(s->format), s->bytes,
+                              reinterpret_cast<const unsigned char *>(s) + layout::SLOT_HEADER_BYTES};
+                    ++this->next;
+                    return 1;
+                }
+
+                // Already overwritten, or being overwritten, by a later lap.
+                if ((seq & ~layout::WRITING) > this->next + 1) {
+                    ++this->lost_blocks;
+                    ++this->next;
+                    continue;
+                }
+            }
+
+            if (this->header->closed.load())
+                return -1;
+
+            const auto now = std::chrono::steady_clock::now();
+
+            if (timeout_ms >= 0 && now >= deadline)
+                return 0;
+
+            // A writer that died without closing the ring would leave us waiting for ever.
+            if (::kill(static_cast<pid_t>(this->header->writer), 0) != 0 && errno == ESRCH)
+                return -1;
+
+            int wait_ms = 100;
+
+            if (timeout_ms >= 0)
+                wait_ms = static_cast<int>(std::min<int64_t>(wait_ms, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1));
+
+            this->header->waiters.fetch_add(1);
+            wait_for_change(this->header->wake, seen, wait_ms);
+            this->header->waiters.fetch_sub(1);
+        }
+    #endif
+}
+
+bool OutputRingReader::valid(const Block& b) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return this->slot(b.seq)->seq.load(std::memory_order_relaxed) == b.seq + 1;
+}
+
+struct nfp_shm_reader {
+    OutputRingReader reader;
+};
+
+extern "C" {
+
+nfp_shm_reader * nfp_shm_open(const char * name) {
+    try {
+        return new nfp_shm_reader{OutputRingReader(name)};
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+void nfp_shm_close(nfp_shm_reader * reader) {
+    delete reader;
+}
+
+int nfp_shm_next(nfp_shm_reader * reader, nfp_shm_block * block, int timeout_ms) {
+    OutputRingReader::Block b;
+    const int got = reader->reader.next_block(b, timeout_ms);
+
+    if (got == 1)
+        *block = nfp_shm_block{b.seq, b.port, static_cast<uint16_t>(b.format), b.bytes, b.data};
+
+    return got;
+}
+
+int nfp_shm_valid(const nfp_shm_reader * reader, const nfp_shm_block * block) {
+    OutputRingReader::Block b {block->seq, block->port, static_cast<nfp::shm_layout::FORMAT>(block->format), block->bytes, block->data};
+    return reader->reader.valid(b);
+}
+
+uint64_t nfp_shm_lost(const nfp_shm_reader * reader) {
+    return reader->reader.lost();
+}
+
+}
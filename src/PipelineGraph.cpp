@@ -0,0 +1,293 @@
+#include <nfp/PipelineGraph.hpp>
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+using nfp::PipelineGraph;
+using nfp::SignalPipeline;
+using std::vector;
+using std::string;
+
+static const string INPUT_NAME = "in";
+
+void PipelineGraph::add_chain(const string& name, const string& input, SignalPipeline chain) {
+    if (chain.get_spectrum())
+        throw std::runtime_error("Graph node " + name + " can't end in a spectrum element!");
+
+    this->defs.push_back(NodeDef{name, {input}, {}, false, std::move(chain)});
+}
+
+void PipelineGraph::add_mix(const string& name, vector<string> inputs, vector<float> weights) {
+    if (inputs.empty())
+        throw std::runtime_error("Graph mix " + name + " must have at least one input!");
+
+    if (weights.empty())
+        weights.assign(inputs.size(), 1.0f);
+
+    if (weights.size() != inputs.size())
+        throw std::runtime_error("Graph mix " + name + " must have one weight per input!");
+
+    this->defs.push_back(NodeDef{name, std::move(inputs), std::move(weights), true, {}});
+}
+
+void PipelineGraph::compile(bool parallel) {
+    const size_t n = this->defs.size();
+    std::map<string, size_t> index;
+
+    // Value 0 is the graph input, node i produces value i + 1.
+    index[INPUT_NAME] = 0;
+
+    for (size_t i = 0; i < n; ++i)
+        if (!index.emplace(this->defs[i].name, i + 1).second)
+            throw std::runtime_error("Graph node name " + this->defs[i].name + " is duplicated or reserved!");
+
+    if (this->output_names.empty())
+        throw std::runtime_error("Graph must have at least one output!");
+
+    auto value_of = [&](const string& name) {
+        auto it = index.find(name);
+        if (it == index.end())
+            throw std::runtime_error("Graph refers to unknown node " + name + "!");
+        return it->second;
+    };
+
+    vector<vector<size_t>> inputs(n + 1);
+    for (size_t i = 0; i < n; ++i)
+        for (const auto& in : this->defs[i].inputs)
+            inputs[i + 1].push_back(value_of(in));
+
+    // Only nodes feeding an output are scheduled.
+    vector<bool> needed(n + 1, false);
+    vector<size_t> stack;
+    for (const auto& out : this->output_names)
+        stack.push_back(value_of(out));
+
+    while (!stack.empty()) {
+        size_t v = stack.back();
+        stack.pop_back();
+
+        if (needed[v])
+            continue;
+
+        needed[v] = true;
+        stack.insert(stack.end(), inputs[v].begin(), inputs[v].end());
+    }
+
+    // Dependency levels by relaxation; a node still changing after n + 1 rounds sits on a cycle.
+    vector<size_t> level(n + 1, 0);
+    for (size_t round = 0, changed = 1; changed; ++round) {
+        if (round > n + 1)
+            throw std::runtime_error("Graph has a cycle!");
+
+        changed = 0;
+        for (size_t v = 1; v <= n; ++v)
+            for (size_t in : inputs[v])
+                if (level[v] < level[in] + 1) {
+                    level[v] = level[in] + 1;
+                    changed = 1;
+                }
+    }
+
+    vector<size_t> order;
+    for (size_t v = 1; v <= n; ++v)
+        if (needed[v])
+            order.push_back(v);
+
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return level[a] < level[b]; });
+
+    const size_t OUTPUT_LEVEL = SIZE_MAX;
+    vector<size_t> last_level(n + 1, 0);
+    vector<size_t> last_level_uses(n + 1, 0);
+
+    for (size_t v : order)
+        for (size_t in : inputs[v]) {
+            if (level[v] > last_level[in]) {
+                last_level[in] = level[v];
+                last_level_uses[in] = 0;
+            }
+            if (level[v] == last_level[in])
+                ++last_level_uses[in];
+        }
+
+    for (const auto& out : this->output_names)
+        last_level[value_of(out)] = OUTPUT_LEVEL;
+
+    // Greedy slot assignment. A value dying at a level is reused in place by its only consumer in
+    // that level; otherwise its slot is freed once the whole level is done, so nodes of one level
+    // never write a slot another node of the same level still reads.
+    auto sched = std::make_shared<Schedule>();
+    sched->parallel = parallel;
+
+    vector<uint16_t> slot(n + 1, 0), free_slots;
+    vector<bool> reused(n + 1, false);
+    uint16_t n_buffers = 1;
+
+    auto new_slot = [&]() -> uint16_t {
+        if (!free_slots.empty()) {
+            uint16_t s = free_slots.back();
+            free_slots.pop_back();
+            return s;
+        }
+        return n_buffers++;
+    };
+
+    for (size_t i = 0; i < order.size(); ) {
+        const size_t lvl = level[order[i]];
+        vector<size_t> dying;
+
+        for (; i < order.size() && level[order[i]] == lvl; ++i) {
+            const size_t v = order[i];
+            NodeDef& def = this->defs[v - 1];
+
+            Step step;
+            step.mix = def.mix;
+            step.chain = 0;
+            step.weights = def.weights;
+
+            bool in_place = false;
+
+            for (size_t in : inputs[v]) {
+                step.in.push_back(slot[in]);
+
+                if (last_level[in] != lvl)
+                    continue;
+
+                if (!in_place && !reused[in] && last_level_uses[in] == 1) {
+                    slot[v] = slot[in];
+                    reused[in] = in_place = true;
+                } else if (std::find(dying.begin(), dying.end(), in) == dying.end()) {
+                    dying.push_back(in);
+                }
+            }
+
+            if (!in_place)
+                slot[v] = new_slot();
+
+            step.out = slot[v];
+
+            if (!def.mix) {
+                step.chain = static_cast<uint16_t>(sched->chains.size());
+                sched->chains.push_back(std::move(def.chain));
+                sched->chain_names.push_back(def.name);
+            }
+
+            sched->steps.push_back(std::move(step));
+        }
+
+        for (size_t v : dying)
+            if (!reused[v])
+                free_slots.push_back(slot[v]);
+
+        sched->level_ends.push_back(sched->steps.size());
+    }
+
+    for (const auto& out : this->output_names)
+        sched->outputs.push_back(slot[value_of(out)]);
+
+    sched->n_buffers = n_buffers;
+
+    this->defs.clear();
+    this->output_names.clear();
+    this->schedule = sched;
+
+    for (const auto& c : sched->chains)
+        this->chains.push_back(c.clone());
+
+    this->blocks.assign(static_cast<size_t>(n_buffers) * BLOCK, 0.0f);
+}
+
+void PipelineGraph::run_step(const Step& s, size_t n) {
+    float * out = this->buffer(s.out);
+
+    if (!s.mix) {
+        this->chains[s.chain].processBlock(this->buffer(s.in[0]), out, n);
+        return;
+    }
+
+    // Reads every input at j before writing j, so out may alias one of them.
+    const size_t k = s.in.size();
+    for (size_t j = 0; j < n; ++j) {
+        float acc = 0.0f;
+        for (size_t i = 0; i < k; ++i)
+            acc += s.weights[i] * this->blocks[s.in[i] * BLOCK + j];
+        out[j] = acc;
+    }
+}
+
+void PipelineGraph::processBlock(const float * input, size_t n, const ParallelFor * parallel_for) {
+    if (n > BLOCK)
+        throw std::runtime_error("Graph blocks are limited to 128 samples!");
+
+    std::copy(input, input + n, this->buffer(0));
+
+    const Schedule& sched = *this->schedule;
+    size_t begin = 0;
+
+    for (size_t end : sched.level_ends) {
+        if (sched.parallel && parallel_for && *parallel_for && end - begin > 1)
+            (*parallel_for)(end - begin, [&, begin](size_t i) { this->run_step(sched.steps[begin + i], n); });
+        else
+            for (size_t i = begin; i < end; ++i)
+                this->run_step(sched.steps[i], n);
+
+        begin = end;
+    }
+}
+
+void PipelineGraph::reset() {
+    for (auto & c : this->chains)
+        c.reset();
+}
+
+bool PipelineGraph::quiescent(float threshold) const {
+    for (const auto & c : this->chains)
+        if (!c.quiescent(threshold))
+            return false;
+
+    return true;
+}
+
+size_t PipelineGraph::state_bytes() const {
+    size_t bytes = 0;
+
+    for (const auto & c : this->chains)
+        bytes += c.state_bytes();
+
+    return bytes;
+}
+
+void PipelineGraph::save_state(vector<unsigned char> & out) const {
+    for (const auto & c : this->chains)
+        c.save_state(out);
+}
+
+const unsigned char * PipelineGraph::load_state(const unsigned char * in) {
+    for (auto & c : this->chains)
+        in = c.load_state(in);
+
+    return in;
+}
+
+PipelineGraph PipelineGraph::clone(std::pmr::memory_resource * arena) const {
+    if (!this->schedule)
+        throw std::runtime_error("Graph must be compiled before it is cloned!");
+
+    PipelineGraph ret {arena};
+    ret.schedule = this->schedule;
+    ret.chains.reserve(this->schedule->chains.size());
+
+    for (const auto& c : this->schedule->chains)
+        ret.chains.push_back(c.clone(arena));
+
+    ret.blocks.assign(this->blocks.size(), 0.0f);
+    return ret;
+}
+
+size_t PipelineGraph::footprint() const {
+    size_t bytes = sizeof(*this) + this->blocks.capacity() * sizeof(float) + this->chains.capacity() * sizeof(SignalPipeline);
+
+    for (const auto& c : this->chains)
+        bytes += c.footprint();
+
+    return bytes;
+}
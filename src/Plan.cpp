@@ -0,0 +1,601 @@
+#include <nfp/Plan.hpp>
+#include <nfp/BiquadFilter.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using std::string;
+using std::vector;
+
+namespace {
+
+    constexpr char PLAN_MAGIC[8] = {'N', 'F', 'P', 'P', 'L', 'A', 'N', '\0'};
+    constexpr uint32_t PLAN_ENDIAN = 0x01020304;
+
+    uint64_t fnv1a(const char * p, size_t n) {
+        uint64_t h = 14695981039346656037ull;
+
+        for (size_t i = 0; i < n; ++i) {
+            h ^= static_cast<unsigned char>(p[i]);
+            h *= 1099511628211ull;
+        }
+
+        return h;
+    }
+
+    class PlanWriter {
+    public:
+        string bytes;
+
+        template<typename T> void pod(const T& v) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            this->bytes.append(reinterpret_cast<const char *>(&v), sizeof(T));
+        }
+
+        template<typename T> void vec(const vector<T>& v) {
+            this->pod(static_cast<uint32_t>(v.size()));
+            for (const auto& x : v)
+                this->pod(x);
+        }
+
+        void str(const string& s) {
+            this->pod(static_cast<uint32_t>(s.size()));
+            this->bytes.append(s);
+        }
+    };
+
+    // Reads straight from the mapped pages; every field is bounds checked against the payload.
+    class PlanReader {
+    private:
+        const char * p;
+        const char * end;
+
+        const char * take(size_t n) {
+            if (static_cast<size_t>(this->end - this->p) < n)
+                throw std::runtime_error("Plan file is truncated!");
+
+            const char * at = this->p;
+            this->p += n;
+            return at;
+        }
+
+    public:
+        PlanReader(const char * p, size_t n) : p(p), end(p + n) {}
+
+        template<typename T> T pod() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T v;
+            std::memcpy(&v, this->take(sizeof(T)), sizeof(T));
+            return v;
+        }
+
+        // Enums are stored in one byte; a value past last comes from a producer with other enums.
+        template<typename E> E enumerated(E last, const char * section) {
+            const auto v = this->pod<uint8_t>();
+
+            if (v > static_cast<uint8_t>(last))
+                throw std::runtime_error(string("Plan file has a malformed ") + section + "!");
+
+            return static_cast<E>(v);
+        }
+
+        template<typename T> vector<T> vec() {
+            auto n = this->pod<uint32_t>();
+            const char * at = this->take(n * sizeof(T));
+            vector<T> v(n);
+            if (n)
+                std::memcpy(v.data(), at, n * sizeof(T));
+            return v;
+        }
+
+        string str() {
+            auto n = this->pod<uint32_t>();
+            return string(this->take(n), n);
+        }
+
+        bool done() const { return this->p == this->end; }
+    };
+
+    class MappedFile {
+    private:
+        const char * data = nullptr;
+        size_t n = 0;
+        #ifdef _WIN32
+            HANDLE mapping = nullptr;
+        #endif
+
+    public:
+        explicit MappedFile(const string& path) {
+            #ifdef _WIN32
+                HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (file == INVALID_HANDLE_VALUE)
+                    throw std::runtime_error("Plan file " + path + " couldn't be opened!");
+
+                LARGE_INTEGER size;
+                if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+                    this->mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                CloseHandle(file);
+
+                if (!this->mapping)
+                    throw std::runtime_error("Plan file " + path + " couldn't be mapped!");
+
+                this->n = static_cast<size_t>(size.QuadPart);
+                this->data = static_cast<const char *>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0));
+
+                if (!this->data) {
+                    CloseHandle(this->mapping);
+                    throw std::runtime_error("Plan file " + path + " couldn't be mapped!");
+                }
+            #else
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0)
+                    throw std::runtime_error("Plan file " + path + " couldn't be opened!");
+
+                struct stat st;
+                void * p = MAP_FAILED;
+                if (::fstat(fd, &st) == 0 && st.st_size > 0)
+                    p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+                ::close(fd);
+
+                if (p == MAP_FAILED)
+                    throw std::runtime_error("Plan file " + path + " couldn't be mapped!");
+
+                this->n = static_cast<size_t>(st.st_size);
+                this->data = static_cast<const char *>(p);
+            #endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() {
+            #ifdef _WIN32
+                UnmapViewOfFile(this->data);
+                CloseHandle(this->mapping);
+            #else
+                ::munmap(const_cast<char *>(this->data), this->n);
+            #endif
+        }
+
+        const char * bytes() const { return this->data; }
+        size_t size() const { return this->n; }
+    };
+
+}
+
+namespace nfp {
+
+    // Friend of the classes whose compiled form is private: graphs are stored as their schedule and
+    // route tables as their rules, so loading repeats neither the topological sort nor the lookups.
+    struct PlanCodec {
+
+        static void put(PlanWriter& w, const vector<Sink>& sinks) {
+            w.pod(static_cast<uint32_t>(sinks.size()));
+            for (const auto& s : sinks) {
+                w.pod(s.addr);
+                w.pod(s.port);
+                w.pod(s.ttl);
+                w.pod(s.iface);
+            }
+        }
+
+        static vector<Sink> get_sinks(PlanReader& r) {
+            vector<Sink> sinks(r.pod<uint32_t>());
+            for (auto& s : sinks) {
+                s.addr = r.pod<uint32_t>();
+                s.port = r.pod<uint16_t>();
+                s.ttl = r.pod<uint8_t>();
+                s.iface = r.pod<uint32_t>();
+            }
+            return sinks;
+        }
+
+        static void put(PlanWriter& w, const SignalPipeline& p) {
+            w.vec(p.coeffs());
+
+            const SpectrumAnalyzer * s = p.get_spectrum();
+            w.pod<uint8_t>(s != nullptr);
+
+            if (!s)
+                return;
+
+            const SpectrumConfig& cfg = s->config();
+            w.pod<uint64_t>(cfg.fft_size);
+            w.pod<uint64_t>(cfg.hop);
+            w.pod(static_cast<uint8_t>(cfg.window));
+            w.pod(static_cast<uint8_t>(cfg.output));
+            w.pod(static_cast<uint32_t>(cfg.bands.size()));
+            for (const auto& [lo, hi] : cfg.bands) {
+                w.pod(lo);
+                w.pod(hi);
+            }
+            w.pod(cfg.fs);
+        }
+
+        // Sections of the form {1, 0, 0, g, 0, 0} are gains, runs of other sections become one cascade.
+        static SignalPipeline get_pipeline(PlanReader& r) {
+            auto cs = r.vec<float>();
+
+            if (cs.size() % 6)
+                throw std::runtime_error("Plan file has a malformed pipeline!");
+
+            SignalPipeline p;
+            vector<BiquadFilter> run;
+
+            auto flush = [&]() {
+                if (!run.empty())
+                    p.add_digital_filter(DigitalFilter::from_sections(0, std::move(run)));
+                run.clear();
+            };
+
+            for (size_t i = 0; i < cs.size(); i += 6) {
+                const float * c = cs.data() + i;
+
+                if (c[0] == 1 && c[1] == 0 && c[2] == 0 && c[4] == 0 && c[5] == 0) {
+                    flush();
+                    p.add_gain(c[3]);
+                } else
+                    run.emplace_back(c[0], c[1], c[2], c[3], c[4], c[5]);
+            }
+
+            flush();
+
+            if (r.pod<uint8_t>()) {
+                SpectrumConfig cfg;
+                cfg.fft_size = r.pod<uint64_t>();
+                cfg.hop = r.pod<uint64_t>();
+                cfg.window = r.enumerated(WindowType::HAMMING, "pipeline");
+                cfg.output = r.enumerated(SpectrumOutput::BANDS, "pipeline");
+                cfg.bands.resize(r.pod<uint32_t>());
+                for (auto& [lo, hi] : cfg.bands) {
+                    lo = r.pod<float>();
+                    hi = r.pod<float>();
+                }
+                cfg.fs = r.pod<float>();
+                p.set_spectrum(SpectrumAnalyzer(cfg));
+            }
+
+            return p;
+        }
+
+        static void put(PlanWriter& w, const PipelineGraph& g) {
+            if (!g.schedule)
+                throw std::runtime_error("Graph must be compiled before it is saved!");
+
+            const PipelineGraph::Schedule& s = *g.schedule;
+
+            w.pod(static_cast<uint32_t>(s.steps.size()));
+            for (const auto& step : s.steps) {
+                w.pod<uint8_t>(step.mix);
+                w.pod(step.chain);
+                w.pod(step.out);
+                w.vec(step.in);
+                w.vec(step.weights);
+            }
+
+            w.vec(vector<uint64_t>(s.level_ends.begin(), s.level_ends.end()));
+            w.vec(s.outputs);
+
+            w.pod(static_cast<uint32_t>(s.chains.size()));
+            for (size_t i = 0; i < s.chains.size(); ++i) {
+                w.str(s.chain_names[i]);
+                put(w, s.chains[i]);
+            }
+
+            w.pod(s.n_buffers);
+            w.pod<uint8_t>(s.parallel);
+        }
+
+        static PipelineGraph get_graph(PlanReader& r) {
+            auto s = std::make_shared<PipelineGraph::Schedule>();
+
+            s->steps.resize(r.pod<uint32_t>());
+            for (auto& step : s->steps) {
+                step.mix = r.pod<uint8_t>();
+                step.chain = r.pod<uint16_t>();
+                step.out = r.pod<uint16_t>();
+                step.in = r.vec<uint16_t>();
+                step.weights = r.vec<float>();
+            }
+
+            for (auto end : r.vec<uint64_t>())
+                s->level_ends.push_back(static_cast<size_t>(end));
+            s->outputs = r.vec<uint16_t>();
+
+            auto n_chains = r.pod<uint32_t>();
+            for (uint32_t i = 0; i < n_chains; ++i) {
+                s->chain_names.push_back(r.str());
+                s->chains.push_back(get_pipeline(r));
+            }
+
+            s->n_buffers = r.pod<uint16_t>();
+            s->parallel = r.pod<uint8_t>();
+
+            // processBlock trusts the schedule, so a plan that would index past it is refused here.
+            bool ok = s->n_buffers > 0 && !s->level_ends.empty() && s->level_ends.back() == s->steps.size();
+
+            for (size_t i = 1; i < s->level_ends.size(); ++i)
+                ok = ok && s->level_ends[i - 1] <= s->level_ends[i];
+
+            for (const auto& step : s->steps) {
+                ok = ok && step.out < s->n_buffers && !step.in.empty();
+                ok = ok && (step.mix ? step.weights.size() == step.in.size() : step.chain < s->chains.size());
+                for (auto in : step.in)
+                    ok = ok && in < s->n_buffers;
+            }
+
+            for (auto out : s->outputs)
+                ok = ok && out < s->n_buffers;
+
+            if (!ok || s->outputs.empty())
+                throw std::runtime_error("Plan file has a malformed graph!");
+
+            PipelineGraph g;
+            g.schedule = s;
+
+            for (const auto& c : s->chains)
+                g.chains.push_back(c.clone());
+
+            g.blocks.assign(static_cast<size_t>(s->n_buffers) * PipelineGraph::BLOCK, 0.0f);
+            return g;
+        }
+
+        static void put(PlanWriter& w, const RouteTable& t) {
+            w.pod(static_cast<uint32_t>(t.routes.size()));
+            for (const auto& route : t.routes) {
+                w.str(route.name);
+                w.pod(static_cast<uint8_t>(route.policy));
+                w.pod<uint8_t>(route.graph != nullptr);
+
+                if (route.graph)
+                    put(w, *route.graph);
+                else
+                    put(w, route.pipeline);
+
+                put(w, route.sinks);
+                w.str(route.shm.name);
+                w.pod(route.shm.slots);
+                w.pod<uint8_t>(route.shm.udp);
+
+                w.pod(static_cast<uint8_t>(route.tiers.size()));
+                for (const auto& tier : route.tiers)
+                    put(w, tier);
+            }
+
+            w.vec(t.rules);
+            w.vec(t.rule_targets);
+            w.pod(t.default_route);
+        }
+
+        // Q31 sections are requantized from the stored coefficients, as build_route_table does.
+        static RouteTable get_routes(PlanReader& r, bool fixed_point) {
+            RouteTable t;
+
+            auto n_routes = r.pod<uint32_t>();
+            for (uint32_t i = 0; i < n_routes; ++i) {
+                auto name = r.str();
+                auto policy = r.enumerated(CONCEALMENT::PITCH_REPETITION, "route table");
+
+                uint16_t route;
+
+                if (r.pod<uint8_t>()) {
+                    route = t.add_route(name, get_graph(r), policy);
+                } else {
+                    auto pipeline = get_pipeline(r);
+                    auto fixed = fixed_point ? FixedPointFilter(pipeline.coeffs()) : FixedPointFilter();
+                    route = t.add_route(name, std::move(pipeline), policy, std::move(fixed));
+                }
+
+                t.set_sinks(route, get_sinks(r));
+
+                ShmOutput shm;
+                shm.name = r.str();
+                shm.slots = r.pod<uint32_t>();
+                shm.udp = r.pod<uint8_t>();
+                t.set_shm_output(route, std::move(shm));
+
+                const auto n_tiers = r.pod<uint8_t>();
+
+                if (n_tiers > nfp::MAX_TIERS)
+                    throw std::runtime_error("Plan file has a malformed route table!");
+
+                std::vector<SignalPipeline> tiers;
+                for (uint8_t k = 0; k < n_tiers; ++k)
+                    tiers.push_back(get_pipeline(r));
+                t.set_tiers(route, std::move(tiers));
+            }
+
+            t.rules = r.vec<RouteTable::Rule>();
+            t.rule_targets = r.vec<uint16_t>();
+            t.default_route = r.pod<uint16_t>();
+
+            bool ok = t.rules.size() == t.rule_targets.size() && t.default_route < t.routes.size();
+            for (auto target : t.rule_targets)
+                ok = ok && target < t.routes.size();
+
+            if (!ok)
+                throw std::runtime_error("Plan file has a malformed route table!");
+
+            return t;
+        }
+    };
+
+}
+
+nfp::Plan nfp::plan_from_config(const json& j) {
+    Plan plan;
+    plan.conn = parse_conn_from(j);
+    plan.threads = parse_threads_from(j);
+    plan.analysis = parse_analysis_from(j);
+    plan.routes = build_route_table(j, plan.conn);
+    return plan;
+}
+
+void nfp::save_plan(const Plan& plan, const std::string& path) {
+    PlanWriter w;
+
+    const auto& c = plan.conn;
+    w.pod(c.samp_freq);
+    w.pod(c.server_port);
+    w.str(c.client_addrv4);
+    w.pod(static_cast<uint8_t>(c.policy));
+    w.pod<uint32_t>(c.jitter_depth);
+    w.pod<uint32_t>(c.warm_up);
+    w.pod(c.conn_timeout_ms);
+    w.pod<uint8_t>(c.fixed_point);
+    w.pod(c.silence_threshold);
+    w.pod<uint8_t>(c.suppress_silence);
+    PlanCodec::put(w, c.sinks);
+
+    const auto& t = plan.threads;
+    w.pod<uint8_t>(t.run_to_completion);
+    w.pod<uint8_t>(t.coroutines);
+    w.pod<uint32_t>(t.receivers);
+    w.pod<uint32_t>(t.workers);
+    w.pod<uint32_t>(t.senders);
+    w.vec(vector<int32_t>(t.receiver_cpus.begin(), t.receiver_cpus.end()));
+    w.vec(vector<int32_t>(t.worker_cpus.begin(), t.worker_cpus.end()));
+    w.vec(vector<int32_t>(t.sender_cpus.begin(), t.sender_cpus.end()));
+    w.pod<int32_t>(t.fifo_priority);
+    w.pod<uint8_t>(t.lock_memory);
+    w.pod<uint32_t>(t.queue_capacity);
+    w.pod(static_cast<uint8_t>(t.overload_policy));
+    w.pod<uint8_t>(t.pause_reads);
+    w.pod<uint32_t>(t.backends);
+    w.pod<uint32_t>(t.ring_capacity);
+    w.pod(t.tier_high);
+    w.pod(t.tier_low);
+    w.pod<uint8_t>(t.has_isa);
+    w.pod(static_cast<uint8_t>(t.isa));
+
+    const auto& a = plan.analysis;
+    w.pod<uint8_t>(a.enabled);
+    w.pod(a.max_gain_db);
+    w.pod(a.min_stability_margin);
+    w.pod<uint32_t>(a.points);
+    w.pod(a.min_snr_db);
+
+    PlanCodec::put(w, plan.routes);
+
+    PlanHeader header {};
+    std::memcpy(header.magic, PLAN_MAGIC, sizeof(PLAN_MAGIC));
+    header.version = PLAN_VERSION;
+    header.endian = PLAN_ENDIAN;
+    header.payload_bytes = w.bytes.size();
+    header.checksum = fnv1a(w.bytes.data(), w.bytes.size());
+
+    // Written aside and renamed over the target: instances still mapping the old plan keep valid pages.
+    const string tmp = path + ".tmp";
+    {
+        std::ofstream file {tmp, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(w.bytes.data(), static_cast<std::streamsize>(w.bytes.size()));
+
+        if (!file)
+            throw std::runtime_error("Plan file " + tmp + " couldn't be written!");
+    }
+
+    #ifdef _WIN32
+        bool moved = MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+    #else
+        bool moved = std::rename(tmp.c_str(), path.c_str()) == 0;
+    #endif
+
+    if (!moved)
+        throw std::runtime_error("Plan file " + path + " couldn't be written!");
+}
+
+nfp::Plan nfp::load_plan(const std::string& path) {
+    MappedFile file {path};
+
+    PlanHeader header;
+    if (file.size() < sizeof(header))
+        throw std::runtime_error("Plan file is truncated!");
+
+    std::memcpy(&header, file.bytes(), sizeof(header));
+
+    if (std::memcmp(header.magic, PLAN_MAGIC, sizeof(PLAN_MAGIC)) != 0)
+        throw std::runtime_error(path + " is not a plan file!");
+
+    if (header.endian != PLAN_ENDIAN)
+        throw std::runtime_error("Plan file was written with another byte order!");
+
+    if (header.version != PLAN_VERSION)
+        throw std::runtime_error("Plan file version " + std::to_string(header.version) + " is not supported!");
+
+    if (header.payload_bytes != file.size() - sizeof(header))
+        throw std::runtime_error("Plan file is truncated!");
+
+    const char * payload = file.bytes() + sizeof(header);
+
+    if (fnv1a(payload, header.payload_bytes) != header.checksum)
+        throw std::runtime_error("Plan file checksum mismatch!");
+
+    PlanReader r {payload, header.payload_bytes};
+    Plan plan;
+
+    auto& c = plan.conn;
+    c.samp_freq = r.pod<float>();
+    c.server_port = r.pod<uint16_t>();
+    c.client_addrv4 = r.str();
+    c.policy = r.enumerated(CONCEALMENT::PITCH_REPETITION, "connection section");
+    c.jitter_depth = r.pod<uint32_t>();
+    c.warm_up = r.pod<uint32_t>();
+    c.conn_timeout_ms = r.pod<uint32_t>();
+    c.fixed_point = r.pod<uint8_t>();
+    c.silence_threshold = r.pod<float>();
+    c.suppress_silence = r.pod<uint8_t>();
+    c.sinks = PlanCodec::get_sinks(r);
+
+    auto& t = plan.threads;
+    t.run_to_completion = r.pod<uint8_t>();
+    t.coroutines = r.pod<uint8_t>();
+
+    #ifndef NFP_COROUTINES
+        if (t.coroutines)
+            throw std::runtime_error("Plan uses coroutine mode, which needs a build with NFP_COROUTINES=ON!");
+    #endif
+
+    t.receivers = r.pod<uint32_t>();
+    t.workers = r.pod<uint32_t>();
+    t.senders = r.pod<uint32_t>();
+    for (auto cpu : r.vec<int32_t>()) t.receiver_cpus.push_back(cpu);
+    for (auto cpu : r.vec<int32_t>()) t.worker_cpus.push_back(cpu);
+    for (auto cpu : r.vec<int32_t>()) t.sender_cpus.push_back(cpu);
+    t.fifo_priority = r.pod<int32_t>();
+    t.lock_memory = r.pod<uint8_t>();
+    t.queue_capacity = r.pod<uint32_t>();
+    t.overload_policy = r.enumerated(OVERLOAD::ESTABLISHED_FIRST, "thread section");
+    t.pause_reads = r.pod<uint8_t>();
+    t.backends = r.pod<uint32_t>();
+    t.ring_capacity = r.pod<uint32_t>();
+    t.tier_high = r.pod<float>();
+    t.tier_low = r.pod<float>();
+    t.has_isa = r.pod<uint8_t>();
+    t.isa = r.enumerated(nfp::ISA::NEON, "thread section");
+
+    auto& a = plan.analysis;
+    a.enabled = r.pod<uint8_t>();
+    a.max_gain_db = r.pod<float>();
+    a.min_stability_margin = r.pod<float>();
+    a.points = r.pod<uint32_t>();
+    a.min_snr_db = r.pod<float>();
+
+    plan.routes = PlanCodec::get_routes(r, c.fixed_point);
+
+    if (!r.done())
+        throw std::runtime_error("Plan file has trailing bytes!");
+
+    return plan;
+}
@@ -0,0 +1,81 @@
+#include <nfp/RouteTable.hpp>
+#include <optional>
+#include <stdexcept>
+
+using nfp::RouteTable;
+using nfp::SignalPipeline;
+
+// Bytes a connection arena needs to hold a copy of this route's filter state.
+size_t nfp::Route::arena_bytes() const {
+    nfp::ArenaSizer sizer;
+
+    {
+        auto pipeline_copy = this->pipeline.clone(&sizer);
+        auto fixed_copy = this->fixed.clone(&sizer);
+        auto graph_copy = this->graph ? this->graph->clone(&sizer) : nfp::PipelineGraph{};
+        std::pmr::vector<SignalPipeline> tier_copies {&sizer};
+        std::optional<nfp::Concealer> concealer;
+
+        tier_copies.reserve(this->tiers.size());
+        for (const auto& tier : this->tiers)
+            tier_copies.push_back(tier.clone(&sizer));
+
+        if (nfp::model_based(this->policy))
+            concealer.emplace(nfp::concealment_model(this->policy), &sizer);
+    }
+
+    return sizer.bytes();
+}
+
+uint16_t RouteTable::add_route(const std::string& name, SignalPipeline pipeline, CONCEALMENT policy, nfp::FixedPointFilter fixed) {
+    if (this->routes.size() >= UINT16_MAX)
+        throw std::runtime_error("Too many routes!");
+
+    // Members are set by name; sinks, the shared-memory output and tiers come later.
+    Route& route = this->routes.emplace_back();
+    route.name = name;
+    route.pipeline = std::move(pipeline);
+    route.policy = policy;
+    route.fixed = std::move(fixed);
+    return static_cast<uint16_t>(this->routes.size() - 1);
+}
+
+uint16_t RouteTable::add_route(const std::string& name, nfp::PipelineGraph graph, CONCEALMENT policy) {
+    if (this->routes.size() >= UINT16_MAX)
+        throw std::runtime_error("Too many routes!");
+
+    auto shared = std::make_shared<const nfp::PipelineGraph>(std::move(graph));
+    Route& route = this->routes.emplace_back();
+    route.name = name;
+    route.policy = policy;
+    route.graph = std::move(shared);
+    return static_cast<uint16_t>(this->routes.size() - 1);
+}
+
+void RouteTable::add_rule(uint32_t net, uint8_t prefix, uint16_t src_port_min, uint16_t src_port_max,
+    uint16_t out_port_min, uint16_t out_port_max, uint16_t route) {
+
+    if (route >= this->routes.size())
+        throw std::runtime_error("Rule points to an unknown route!");
+
+    uint32_t mask = prefix == 0 ? 0 : (prefix >= 32 ? UINT32_MAX : ~(UINT32_MAX >> prefix));
+
+    this->rules.push_back(Rule{net & mask, mask, src_port_min, src_port_max, out_port_min, out_port_max});
+    this->rule_targets.push_back(route);
+}
+
+uint16_t RouteTable::lookup(uint32_t addr, uint16_t port, uint16_t out_port) const {
+    const Rule * rules = this->rules.data();
+    const size_t n = this->rules.size();
+
+    for (size_t i = 0; i < n; ++i) {
+        const Rule & r = rules[i];
+
+        if ((addr & r.mask) == r.net &&
+            port >= r.src_port_min && port <= r.src_port_max &&
+            out_port >= r.out_port_min && out_port <= r.out_port_max)
+            return this->rule_targets[i];
+    }
+
+    return this->default_route;
+}
@@ -0,0 +1,153 @@
+#include <nfp/ShmRing.hpp>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <signal.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using nfp::RingSlot;
+using nfp::ShmRing;
+
+static size_t header_bytes() {
+    return (sizeof(ShmRing::Header) + 63) / 64 * 64;
+}
+
+ShmRing::ShmRing(const std::string& name, bool create, size_t capacity) : name(name), owner(create) {
+    #ifdef _WIN32
+        throw std::runtime_error("Shared-memory rings need a POSIX host!");
+    #else
+        if (create && (capacity == 0 || (capacity & (capacity - 1)) != 0))
+            throw std::runtime_error("Ring capacity must be a power of two!");
+
+        if (create)
+            ::shm_unlink(name.c_str());
+
+        const int fd = ::shm_open(name.c_str(), create ? O_RDWR | O_CREAT | O_EXCL : O_RDWR, 0600);
+
+        if (fd < 0)
+            throw std::runtime_error("Ring " + name + (create ? " couldn't be created!" : " doesn't exist, start the dispatcher first!"));
+
+        if (create) {
+            this->mapped = header_bytes() + capacity * sizeof(RingSlot);
+
+            if (::ftruncate(fd, static_cast<off_t>(this->mapped)) != 0) {
+                ::close(fd);
+                ::shm_unlink(name.c_str());
+                throw std::runtime_error("Ring " + name + " couldn't be created!");
+            }
+        } else {
+            struct stat st;
+
+            if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < header_bytes()) {
+                ::close(fd);
+                throw std::runtime_error("Ring " + name + " is not a datagram ring!");
+            }
+
+            this->mapped = static_cast<size_t>(st.st_size);
+        }
+
+        void * p = ::mmap(nullptr, this->mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if (p == MAP_FAILED) {
+            if (create)
+                ::shm_unlink(name.c_str());
+            throw std::runtime_error("Ring " + name + " couldn't be mapped!");
+        }
+
+        this->header = static_cast<Header *>(p);
+        this->slots = reinterpret_cast<RingSlot *>(static_cast<unsigned char *>(p) + header_bytes());
+
+        if (create) {
+            new (this->header) Header{MAGIC, capacity, {0}, {0}, {0}, {0}};
+        } else if (this->header->magic != MAGIC || this->mapped != header_bytes() + this->header->capacity * sizeof(RingSlot)) {
+            this->unmap();
+            throw std::runtime_error("Ring " + name + " is not a datagram ring!");
+        }
+
+        this->mask = this->header->capacity - 1;
+        this->cached_head = this->header->head.load();
+        this->cached_tail = this->header->tail.load();
+    #endif
+}
+
+ShmRing ShmRing::create(const std::string& name, size_t capacity) {
+    return ShmRing(name, true, capacity);
+}
+
+ShmRing ShmRing::attach(const std::string& name) {
+    return ShmRing(name, false, 0);
+}
+
+ShmRing::ShmRing(ShmRing&& other) noexcept
+    : name(std::move(other.name)), header(std::exchange(other.header, nullptr)), slots(other.slots), mapped(other.mapped),
+      mask(other.mask), cached_head(other.cached_head), cached_tail(other.cached_tail), owner(std::exchange(other.owner, false)) {}
+
+ShmRing& ShmRing::operator=(ShmRing&& other) noexcept {
+    if (this != &other) {
+        this->unmap();
+        this->name = std::move(other.name);
+        this->header = std::exchange(other.header, nullptr);
+        this->slots = other.slots;
+        this->mapped = other.mapped;
+        this->mask = other.mask;
+        this->cached_head = other.cached_head;
+        this->cached_tail = other.cached_tail;
+        this->owner = std::exchange(other.owner, false);
+    }
+
+    return *this;
+}
+
+ShmRing::~ShmRing() {
+    this->unmap();
+}
+
+// The producer removes the name; consumers still mapping the ring keep their pages.
+void ShmRing::unmap() {
+    #ifndef _WIN32
+        if (!this->header)
+            return;
+
+        ::munmap(this->header, this->mapped);
+        this->header = nullptr;
+
+        if (this->owner)
+            ::shm_unlink(this->name.c_str());
+    #endif
+}
+
+void ShmRing::claim() {
+    #ifndef _WIN32
+        const int64_t self = ::getpid();
+        int64_t current = this->header->consumer.load();
+
+        for (;;) {
+            const bool alive = current != 0 && current != self
+                && (::kill(static_cast<pid_t>(current), 0) == 0 || errno == EPERM);
+
+            if (alive)
+                throw std::runtime_error("Ring " + this->name + " already has a consumer!");
+
+            if (this->header->consumer.compare_exchange_weak(current, self))
+                break;
+        }
+
+        this->cached_tail = this->header->tail.load();
+    #endif
+}
+
+void ShmRing::release() {
+    #ifndef _WIN32
+        int64_t self = ::getpid();
+        this->header->consumer.compare_exchange_strong(self, 0);
+    #endif
+}
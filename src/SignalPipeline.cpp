@@ -1,4 +1,5 @@
 #include <nfp/SignalPipeline.hpp>
+#include <algorithm>
 
 using std::vector;
 using nfp::SignalPipeline;
@@ -8,6 +9,11 @@ void SignalPipeline::PipelineElement::processBlock(const vector<float> & input,
         output.push_back(this->eval(x));
 }
 
+void SignalPipeline::PipelineElement::processBlock(const float * input, float * output, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        output[i] = this->eval(input[i]);
+}
+
 float SignalPipeline::process(float x) {
     float z = x;
     for (auto & element : this->elements)
@@ -16,10 +22,22 @@ float SignalPipeline::process(float x) {
 }
 
 void SignalPipeline::processBlock(const vector<float> & input, vector<float> & output) {
-    output.clear();
-    output.reserve(input.size());
-    for (const auto & x : input)
-        output.push_back(this->process(x));
+    output.resize(input.size());
+    this->processBlock(input.data(), output.data(), input.size());
+}
+
+// Element by element over the whole block, which gives the same samples as process; output may
+// alias input.
+void SignalPipeline::processBlock(const float * input, float * output, size_t n) {
+    if (this->elements.empty()) {
+        std::copy(input, input + n, output);
+        return;
+    }
+
+    for (auto & element : this->elements) {
+        element->processBlock(input, output, n);
+        input = output;
+    }
 }
 
 vector<float> SignalPipeline::coeffs() const {
@@ -31,4 +49,71 @@ vector<float> SignalPipeline::coeffs() const {
     }
 
     return as;
-}
\ No newline at end of file
+}
+
+// Every element, filter section and spectrum buffer of the copy is allocated from arena.
+SignalPipeline SignalPipeline::clone(std::pmr::memory_resource * arena) const {
+    SignalPipeline ret {arena};
+    ret.elements.reserve(this->elements.size());
+
+    for (const auto & element : this->elements)
+        ret.elements.push_back(element->clone(arena));
+
+    if (this->spectrum)
+        ret.set_spectrum(this->spectrum->clone(arena));
+
+    return ret;
+}
+
+
+size_t SignalPipeline::footprint() const {
+    size_t bytes = this->elements.capacity() * sizeof(nfp::arena_ptr<PipelineElement>);
+
+    for (const auto & element : this->elements)
+        bytes += element->footprint();
+
+    if (this->spectrum)
+        bytes += this->spectrum->footprint();
+
+    return bytes;
+}
+
+void SignalPipeline::reset() {
+    for (auto & element : this->elements)
+        element->reset();
+}
+
+bool SignalPipeline::quiescent(float threshold) const {
+    for (const auto & element : this->elements)
+        if (!element->quiescent(threshold))
+            return false;
+
+    return true;
+}
+
+size_t SignalPipeline::state_bytes() const {
+    size_t bytes = this->spectrum ? this->spectrum->state_bytes() : 0;
+
+    for (const auto & element : this->elements)
+        bytes += element->state_bytes();
+
+    return bytes;
+}
+
+void SignalPipeline::save_state(vector<unsigned char> & out) const {
+    for (const auto & element : this->elements)
+        element->save_state(out);
+
+    if (this->spectrum)
+        this->spectrum->save_state(out);
+}
+
+const unsigned char * SignalPipeline::load_state(const unsigned char * in) {
+    for (auto & element : this->elements)
+        in = element->load_state(in);
+
+    if (this->spectrum)
+        in = this->spectrum->load_state(in);
+
+    return in;
+}
@@ -0,0 +1,111 @@
+#include <nfp/Simulator.hpp>
+#include <nfp/FixedPoint.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using nfp::Simulator;
+
+Simulator::Simulator(UDPWorker& w) : worker(w), next_tick(w.get_reap_period()) {
+    this->worker.set_manual_clock(this->epoch);
+
+    this->payload = [](const udp::endpoint&, uint64_t seq, Datagram& pkg) {
+        for (size_t i = 0; i < 128; ++i)
+            pkg.data[i] = 0.5f * std::sin(2.0f * 3.14159265f * 440.0f * static_cast<float>((seq * 128 + i) % 8000) / 8000.0f);
+    };
+}
+
+void Simulator::stream(const udp::endpoint& src, uint16_t out_port, std::vector<uint64_t> seqs, Duration start, Duration interval, bool q15) {
+    if (seqs.empty())
+        return;
+
+    this->events.push(Event{std::max(start, this->clock), this->order++, this->streams.size(), 0});
+    this->streams.push_back(Stream{src, out_port, std::move(seqs), start, interval, q15});
+}
+
+void Simulator::emit(boost::asio::const_buffer data, uint16_t port, uint16_t offset, const std::vector<nfp::Sink>& sinks) {
+    ++this->counters.outputs;
+    this->counters.output_bytes += data.size();
+
+    if (this->observer)
+        this->observer(Output{this->clock, port, offset, &sinks, data});
+}
+
+// Expiry ticks fall on the worker's reap period, as its timer would fire them.
+void Simulator::advance(Duration to) {
+    for (; this->next_tick <= to; this->next_tick += this->worker.get_reap_period()) {
+        this->clock = this->next_tick;
+        this->worker.tick(this->epoch + this->next_tick);
+        ++this->counters.ticks;
+    }
+
+    this->clock = std::max(this->clock, to);
+}
+
+void Simulator::run_until(Duration t) {
+    while (!this->events.empty() && this->events.top().at <= t) {
+        Event ev = this->events.top();
+        this->events.pop();
+        this->advance(ev.at);
+
+        const Stream& s = this->streams[ev.stream];
+        Datagram pkg {};
+        pkg.seq = s.seqs[ev.next];
+        pkg.out_port = s.out_port;
+        this->payload(s.src, pkg.seq, pkg);
+
+        if (s.q15) {
+            int16_t q[128];
+            nfp::q15_from_float(pkg.data, q, 128);
+            std::copy(q, q + 128, pkg.data16);
+        }
+
+        const auto t0 = steady_clock::now();
+        this->worker.handle_pkg(pkg, s.src, s.q15, *this);
+        this->counters.busy += steady_clock::now() - t0;
+        ++this->counters.delivered;
+
+        if (ev.next + 1 < s.seqs.size())
+            this->events.push(Event{s.start + static_cast<Duration::rep>(ev.next + 1) * s.interval, this->order++, ev.stream, ev.next + 1});
+    }
+
+    this->advance(t);
+}
+
+void Simulator::run() {
+    while (!this->events.empty())
+        this->run_until(this->events.top().at);
+}
+
+std::vector<uint64_t> nfp::sim::sequence(uint64_t first, size_t n) {
+    std::vector<uint64_t> seqs(n);
+
+    for (size_t i = 0; i < n; ++i)
+        seqs[i] = first + i;
+
+    return seqs;
+}
+
+void nfp::sim::drop(std::vector<uint64_t>& seqs, uint64_t from, size_t n) {
+    seqs.erase(std::remove_if(seqs.begin(), seqs.end(), [&](uint64_t s) { return s >= from && s < from + n; }), seqs.end());
+}
+
+void nfp::sim::drop_random(std::vector<uint64_t>& seqs, double p, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::bernoulli_distribution lost(p);
+
+    seqs.erase(std::remove_if(seqs.begin(), seqs.end(), [&](uint64_t) { return lost(rng); }), seqs.end());
+}
+
+void nfp::sim::delay(std::vector<uint64_t>& seqs, size_t i, size_t distance) {
+    if (i >= seqs.size())
+        return;
+
+    const size_t to = std::min(i + distance, seqs.size() - 1);
+    std::rotate(seqs.begin() + i, seqs.begin() + i + 1, seqs.begin() + to + 1);
+}
+
+void nfp::sim::jump(std::vector<uint64_t>& seqs, size_t i, uint64_t n) {
+    for (; i < seqs.size(); ++i)
+        seqs[i] += n;
+}
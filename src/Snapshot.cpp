@@ -0,0 +1,384 @@
+#include <nfp/UDPInterface.hpp>
+#include <nfp/Snapshot.hpp>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+using nfp::ConnState;
+using nfp::Datagram;
+using nfp::Datagram16;
+using nfp::SnapshotHeader;
+using nfp::UDPWorker;
+
+namespace {
+
+    constexpr char SNAPSHOT_MAGIC[8] = {'N', 'F', 'P', 'S', 'N', 'A', 'P', '\0'};
+    constexpr uint32_t SNAPSHOT_ENDIAN = 0x01020304;
+
+    uint64_t fnv1a(const unsigned char * p, size_t n) {
+        uint64_t h = 14695981039346656037ull;
+
+        for (size_t i = 0; i < n; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+
+        return h;
+    }
+
+    class SnapshotWriter {
+    private:
+        std::vector<unsigned char> & out;
+
+    public:
+        explicit SnapshotWriter(std::vector<unsigned char> & out) : out(out) {}
+
+        template<typename T> void pod(const T& v) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            this->bytes(&v, sizeof(T));
+        }
+
+        void bytes(const void * p, size_t n) {
+            const auto * b = static_cast<const unsigned char *>(p);
+            this->out.insert(this->out.end(), b, b + n);
+        }
+    };
+
+    class SnapshotReader {
+    private:
+        const unsigned char * p;
+        const unsigned char * end;
+
+    public:
+        SnapshotReader(const unsigned char * p, const unsigned char * end) : p(p), end(end) {}
+
+        const unsigned char * take(size_t n) {
+            if (static_cast<size_t>(this->end - this->p) < n)
+                throw std::runtime_error("Connection snapshot is truncated!");
+
+            const unsigned char * at = this->p;
+            this->p += n;
+            return at;
+        }
+
+        template<typename T> T pod() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T v;
+            std::memcpy(&v, this->take(sizeof(T)), sizeof(T));
+            return v;
+        }
+
+        const unsigned char * position() const { return this->p; }
+    };
+
+    size_t filter_state_bytes(const nfp::ConnCold& cold) {
+        size_t tiers = 0;
+        for (const auto& tier : cold.tiers)
+            tiers += tier.state_bytes();
+
+        return cold.pipeline->state_bytes() + tiers
+            + (cold.fixed ? cold.fixed->state_bytes() : 0)
+            + (cold.graph ? cold.graph->state_bytes() : 0)
+            + (cold.concealer ? cold.concealer->state_bytes() : 0);
+    }
+
+}
+
+// Buffered datagrams and the last good block are stored at the connection's sample width.
+void UDPWorker::save_conn(const ConnState& conn, std::vector<unsigned char>& out) const {
+    const uint64_t now = this->now_tick.load(std::memory_order_relaxed);
+    const bool q15 = conn.flags & ConnState::INT16;
+    const size_t slot_bytes = q15 ? sizeof(Datagram16) : sizeof(Datagram);
+    SnapshotWriter w {out};
+
+    w.pod(conn.key);
+    w.pod(conn.expected_seq);
+    w.pod<uint64_t>(conn.deadline > now ? conn.deadline - now : 0);
+    w.pod(conn.present);
+    w.pod(conn.last_port);
+    w.pod(conn.route);
+    w.pod(conn.flags);
+    w.pod(conn.tier);
+    w.bytes(conn.cold->last_good, q15 ? sizeof(conn.cold->last_good16) : sizeof(conn.cold->last_good));
+
+    for (unsigned i = 0; i < 32; ++i)
+        if (conn.present & (1u << i))
+            w.bytes(&conn.slots()[i], slot_bytes);
+
+    const auto & cold = *conn.cold;
+    w.pod(static_cast<uint32_t>(filter_state_bytes(cold)));
+    cold.pipeline->save_state(out);
+
+    for (const auto& tier : cold.tiers)
+        tier.save_state(out);
+
+    if (cold.fixed)
+        cold.fixed->save_state(out);
+
+    if (cold.graph)
+        cold.graph->save_state(out);
+
+    if (cold.concealer)
+        cold.concealer->save_state(out);
+}
+
+// Rebuilds the connection's filters from its route, then loads their state. A live connection
+// with the same key is replaced. Called with shard.mtx held.
+const unsigned char * UDPWorker::restore_conn(Shard& shard, const unsigned char * p, const unsigned char * end) {
+    SnapshotReader r {p, end};
+
+    const uint64_t key = r.pod<uint64_t>();
+    const uint64_t expected_seq = r.pod<uint64_t>();
+    const uint64_t ticks_left = r.pod<uint64_t>();
+    const uint32_t present = r.pod<uint32_t>();
+    const uint16_t last_port = r.pod<uint16_t>();
+    const uint16_t route = r.pod<uint16_t>();
+    const uint8_t flags = r.pod<uint8_t>();
+    const uint8_t tier = r.pod<uint8_t>();
+
+    const bool routed = this->routes && !this->routes->empty();
+    const unsigned depth = shard.conns.get_jitter_depth();
+
+    if ((routed && route >= this->routes->size()) || (static_cast<uint64_t>(present) >> depth) != 0)
+        throw std::runtime_error("Connection snapshot doesn't match this worker!");
+
+    shard.conns.erase(key);
+
+    bool inserted;
+    ConnState& conn = shard.conns.find_or_insert(key, inserted);
+
+    try {
+        this->setup_conn(conn, route);
+
+        const bool q15 = flags & ConnState::INT16;
+        const size_t slot_bytes = q15 ? sizeof(Datagram16) : sizeof(Datagram);
+        const size_t last_good_bytes = q15 ? sizeof(conn.cold->last_good16) : sizeof(conn.cold->last_good);
+
+        std::memcpy(conn.cold->last_good, r.take(last_good_bytes), last_good_bytes);
+
+        for (unsigned i = 0; i < depth; ++i)
+            if (present & (1u << i))
+                std::memcpy(&conn.slots()[i], r.take(slot_bytes), slot_bytes);
+
+        auto & cold = *conn.cold;
+        const uint32_t state_bytes = r.pod<uint32_t>();
+
+        if (state_bytes != filter_state_bytes(cold))
+            throw std::runtime_error("Connection snapshot doesn't match its route's filters!");
+
+        if (tier > cold.tiers.size())
+            throw std::runtime_error("Connection snapshot doesn't match its route's filters!");
+
+        const unsigned char * state = cold.pipeline->load_state(r.take(state_bytes));
+
+        for (auto & t : cold.tiers)
+            state = t.load_state(state);
+
+        if (cold.fixed)
+            state = cold.fixed->load_state(state);
+
+        if (cold.graph)
+            state = cold.graph->load_state(state);
+
+        if (cold.concealer)
+            cold.concealer->load_state(state);
+    } catch (...) {
+        shard.conns.erase(key);
+        throw;
+    }
+
+    conn.expected_seq = expected_seq;
+    conn.present = present;
+    conn.last_port = last_port;
+    conn.flags = flags | ConnState::OCCUPIED;
+    conn.tier = tier;
+    conn.deadline = this->now_tick.load(std::memory_order_relaxed) + ticks_left;
+    shard.expiry_wheel.schedule(key, conn.deadline);
+
+    return r.position();
+}
+
+// Called with shard.mtx held.
+void UDPWorker::accept_handoffs(Shard& shard) {
+    if (shard.inbox.empty())
+        return;
+
+    shard.inbox.drain([&](std::vector<unsigned char> records) {
+        const unsigned char * end = records.data() + records.size();
+
+        for (const unsigned char * p = records.data(); p != end; )
+            p = this->restore_conn(shard, p, end);
+    });
+}
+
+// The records reach the new owner's inbox before the owner changes, so whoever locks the new
+// owner for one of these connections restores it first.
+size_t UDPWorker::move_bucket(size_t bucket, unsigned to_shard) {
+    if (bucket >= BUCKETS || to_shard >= this->shards.size())
+        throw std::runtime_error("No such bucket or shard!");
+
+    std::unique_lock<std::mutex> lock;
+    Shard& from = this->lock_bucket(bucket, lock);
+    Shard& to = *this->shards[to_shard];
+
+    if (&from == &to)
+        return 0;
+
+    std::vector<unsigned char> records;
+    std::vector<uint64_t> keys;
+
+    from.conns.for_each([&](ConnState& conn) {
+        if (bucket_of(conn.key) == bucket) {
+            this->save_conn(conn, records);
+            keys.push_back(conn.key);
+        }
+    });
+
+    for (uint64_t key : keys)
+        from.conns.erase(key);
+
+    if (!records.empty())
+        to.inbox.push(std::move(records));
+
+    this->owners[bucket].store(static_cast<uint16_t>(to_shard), std::memory_order_release);
+    return keys.size();
+}
+
+// Each move takes the largest bucket of the busiest shard that still narrows its gap to the idlest.
+size_t UDPWorker::rebalance() {
+    std::vector<size_t> per_bucket(BUCKETS, 0);
+    std::vector<size_t> per_shard(this->shards.size(), 0);
+
+    for (auto & shard : this->shards) {
+        std::lock_guard<std::mutex> lock(shard->mtx);
+        this->accept_handoffs(*shard);
+        shard->conns.for_each([&](ConnState& conn) { ++per_bucket[bucket_of(conn.key)]; });
+    }
+
+    for (size_t b = 0; b < BUCKETS; ++b)
+        per_shard[this->owners[b].load()] += per_bucket[b];
+
+    size_t moves = 0;
+
+    for (;;) {
+        const auto [lo, hi] = std::minmax_element(per_shard.begin(), per_shard.end());
+        const size_t idlest = static_cast<size_t>(lo - per_shard.begin());
+        const size_t busiest = static_cast<size_t>(hi - per_shard.begin());
+        const size_t gap = *hi - *lo;
+
+        size_t best = BUCKETS;
+
+        for (size_t b = 0; b < BUCKETS; ++b)
+            if (this->owners[b].load() == busiest && per_bucket[b] > 0 && per_bucket[b] < gap
+                && (best == BUCKETS || per_bucket[b] > per_bucket[best]))
+                best = b;
+
+        if (best == BUCKETS)
+            return moves;
+
+        this->move_bucket(best, static_cast<unsigned>(idlest));
+        per_shard[busiest] -= per_bucket[best];
+        per_shard[idlest] += per_bucket[best];
+        ++moves;
+    }
+}
+
+std::vector<size_t> UDPWorker::shard_sizes() {
+    std::vector<size_t> sizes;
+
+    for (auto & shard : this->shards) {
+        std::lock_guard<std::mutex> lock(shard->mtx);
+        this->accept_handoffs(*shard);
+        sizes.push_back(shard->conns.size());
+    }
+
+    return sizes;
+}
+
+std::vector<unsigned char> UDPWorker::save_connections() {
+    std::vector<unsigned char> out(sizeof(SnapshotHeader));
+    uint32_t n_conns = 0;
+
+    for (auto & shard : this->shards) {
+        std::lock_guard<std::mutex> lock(shard->mtx);
+        this->accept_handoffs(*shard);
+
+        shard->conns.for_each([&](ConnState& conn) {
+            this->save_conn(conn, out);
+            ++n_conns;
+        });
+    }
+
+    SnapshotHeader header {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = nfp::SNAPSHOT_VERSION;
+    header.endian = SNAPSHOT_ENDIAN;
+    header.jitter_depth = this->shards.front()->conns.get_jitter_depth();
+    header.n_conns = n_conns;
+    header.payload_bytes = out.size() - sizeof(header);
+    header.checksum = fnv1a(out.data() + sizeof(header), header.payload_bytes);
+
+    std::memcpy(out.data(), &header, sizeof(header));
+    return out;
+}
+
+size_t UDPWorker::restore_connections(const unsigned char * data, size_t n) {
+    SnapshotHeader header;
+
+    if (n < sizeof(header))
+        throw std::runtime_error("Connection snapshot is truncated!");
+
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+        throw std::runtime_error("Not a connection snapshot!");
+
+    if (header.endian != SNAPSHOT_ENDIAN)
+        throw std::runtime_error("Connection snapshot was written with another byte order!");
+
+    if (header.version != nfp::SNAPSHOT_VERSION)
+        throw std::runtime_error("Connection snapshot version " + std::to_string(header.version) + " is not supported!");
+
+    if (header.jitter_depth != this->shards.front()->conns.get_jitter_depth())
+        throw std::runtime_error("Connection snapshot was taken with another jitter depth!");
+
+    if (header.payload_bytes != n - sizeof(header))
+        throw std::runtime_error("Connection snapshot is truncated!");
+
+    const unsigned char * p = data + sizeof(header);
+    const unsigned char * end = data + n;
+
+    if (fnv1a(p, header.payload_bytes) != header.checksum)
+        throw std::runtime_error("Connection snapshot checksum mismatch!");
+
+    size_t count = 0;
+
+    while (p != end) {
+        uint64_t key;
+        std::memcpy(&key, SnapshotReader(p, end).take(sizeof(key)), sizeof(key));
+
+        std::unique_lock<std::mutex> lock;
+        Shard& shard = this->lock_bucket(bucket_of(key), lock);
+        p = this->restore_conn(shard, p, end);
+        ++count;
+    }
+
+    return count;
+}
+
+// Until every ingress queue is empty and no drain task is filtering.
+void UDPWorker::wait_idle() {
+    for (auto & shard : this->shards)
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(shard->ingress_mtx);
+
+                if (shard->ingress.empty() && !shard->draining)
+                    break;
+            }
+
+            std::this_thread::yield();
+        }
+}
@@ -0,0 +1,224 @@
+#include <nfp/Spectrum.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+using nfp::RealFFT;
+using nfp::SpectrumAnalyzer;
+using nfp::SpectrumConfig;
+using std::complex;
+using std::vector;
+
+static constexpr double PI = 3.14159265358979323846;
+
+RealFFT::RealFFT(size_t n) : n(n) {
+    if (n < 4 || (n & (n - 1)) != 0)
+        throw std::runtime_error("FFT size must be a power of two >= 4!");
+
+    const size_t m = n / 2;
+
+    this->twiddles.resize(m / 2);
+    for (size_t k = 0; k < m / 2; ++k)
+        this->twiddles[k] = std::polar(1.0f, static_cast<float>(-2 * PI * k / m));
+
+    this->split.resize(m + 1);
+    for (size_t k = 0; k <= m; ++k)
+        this->split[k] = std::polar(1.0f, static_cast<float>(-2 * PI * k / n));
+
+    unsigned bits = 0;
+    while ((size_t{1} << bits) < m)
+        ++bits;
+
+    this->bitrev.resize(m);
+    for (uint32_t i = 0; i < m; ++i) {
+        uint32_t r = 0;
+        for (unsigned b = 0; b < bits; ++b)
+            r |= ((i >> b) & 1u) << (bits - 1 - b);
+        this->bitrev[i] = r;
+    }
+}
+
+void RealFFT::forward(const float * in, complex<float> * bins, complex<float> * z) const {
+    const size_t m = this->n / 2;
+
+    // Even samples as real part, odd samples as imaginary part, in bit-reversed order.
+    for (size_t i = 0; i < m; ++i)
+        z[this->bitrev[i]] = complex<float>(in[2*i], in[2*i+1]);
+
+    for (size_t len = 2; len <= m; len <<= 1) {
+        const size_t half = len / 2, step = m / len;
+
+        for (size_t start = 0; start < m; start += len)
+            for (size_t j = 0; j < half; ++j) {
+                complex<float> t = this->twiddles[j * step] * z[start + j + half];
+                z[start + j + half] = z[start + j] - t;
+                z[start + j] += t;
+            }
+    }
+
+    // Untangle the two interleaved real transforms.
+    for (size_t k = 0; k <= m; ++k) {
+        complex<float> a = z[k % m], b = std::conj(z[(m - k) % m]);
+        complex<float> even = 0.5f * (a + b);
+        complex<float> odd = complex<float>(0.0f, -0.5f) * (a - b);
+        bins[k] = even + this->split[k] * odd;
+    }
+}
+
+SpectrumAnalyzer::Plan::Plan(const SpectrumConfig& cfg)
+    : config(cfg), fft(cfg.fft_size), window(cfg.fft_size), output(cfg.output), hop(cfg.hop) {
+
+    const size_t n = cfg.fft_size;
+
+    if (cfg.hop == 0 || cfg.hop > n)
+        throw std::runtime_error("Spectrum hop must be between 1 and the FFT size!");
+
+    if (cfg.fs <= 0.0f)
+        throw std::runtime_error("Sampling frequency must be a non-zero positive number!");
+
+    double sum = 0.0, sum_sq = 0.0;
+
+    for (size_t i = 0; i < n; ++i) {
+        double w = 1.0;
+        if (cfg.window == WindowType::HANN)
+            w = 0.5 - 0.5 * std::cos(2 * PI * i / n);
+        else if (cfg.window == WindowType::HAMMING)
+            w = 0.54 - 0.46 * std::cos(2 * PI * i / n);
+
+        this->window[i] = static_cast<float>(w);
+        sum += w;
+        sum_sq += w * w;
+    }
+
+    this->magnitude_scale = static_cast<float>(2.0 / sum);
+    this->power_scale = static_cast<float>(2.0 / (n * sum_sq));
+
+    if (cfg.output == SpectrumOutput::BANDS) {
+        if (cfg.bands.empty())
+            throw std::runtime_error("Spectrum band output needs at least one band!");
+
+        for (const auto& [lo, hi] : cfg.bands) {
+            if (lo < 0.0f || hi <= lo || hi > cfg.fs / 2)
+                throw std::runtime_error("Spectrum bands must satisfy 0 <= low < high <= fs/2!");
+
+            auto k_lo = static_cast<uint32_t>(std::lround(lo * n / cfg.fs));
+            auto k_hi = static_cast<uint32_t>(std::lround(hi * n / cfg.fs));
+            k_hi = std::min<uint32_t>(std::max(k_hi, k_lo + 1), static_cast<uint32_t>(n / 2 + 1));
+
+            this->band_bins.emplace_back(k_lo, k_hi);
+        }
+    }
+
+    if ((cfg.output == SpectrumOutput::MAGNITUDE ? n / 2 + 1 : this->band_bins.size()) > UINT16_MAX)
+        throw std::runtime_error("Too many spectrum features per frame!");
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer(const SpectrumConfig& cfg)
+    : plan(std::make_shared<const Plan>(cfg)), history(cfg.fft_size, 0.0f), until_frame(cfg.fft_size) {}
+
+SpectrumAnalyzer::SpectrumAnalyzer(std::shared_ptr<const Plan> plan, std::pmr::memory_resource * arena)
+    : plan(std::move(plan)), history(this->plan->fft.size(), 0.0f, arena), until_frame(this->plan->fft.size()) {}
+
+size_t SpectrumAnalyzer::n_features() const {
+    if (this->plan->output == SpectrumOutput::MAGNITUDE)
+        return this->plan->fft.size() / 2 + 1;
+    return this->plan->band_bins.size();
+}
+
+void SpectrumAnalyzer::push(const float * x, size_t len, vector<uint8_t> & frames) {
+    const size_t mask = this->history.size() - 1;
+
+    while (len > 0) {
+        const size_t chunk = std::min(len, this->until_frame);
+
+        for (size_t i = 0; i < chunk; ++i)
+            this->history[(this->pos + i) & mask] = x[i];
+
+        this->pos = (this->pos + chunk) & mask;
+        this->until_frame -= chunk;
+        x += chunk;
+        len -= chunk;
+
+        if (this->until_frame == 0) {
+            this->emit(frames);
+            this->until_frame = this->plan->hop;
+        }
+    }
+}
+
+void SpectrumAnalyzer::emit(vector<uint8_t> & frames) {
+    const Plan & p = *this->plan;
+    const size_t n = p.fft.size(), mask = n - 1;
+
+    thread_local vector<float> windowed;
+    thread_local vector<complex<float>> bins, work;
+    windowed.resize(n);
+    bins.resize(n / 2 + 1);
+    work.resize(n / 2);
+
+    // pos points at the oldest sample once the history has wrapped.
+    for (size_t i = 0; i < n; ++i)
+        windowed[i] = this->history[(this->pos + i) & mask] * p.window[i];
+
+    p.fft.forward(windowed.data(), bins.data(), work.data());
+
+    const size_t n_feat = this->n_features();
+    FeatureFrameHeader header {this->frame++, static_cast<uint16_t>(n_feat), static_cast<uint8_t>(p.output), 0};
+
+    const size_t off = frames.size();
+    frames.resize(off + sizeof(header) + n_feat * sizeof(float));
+    std::memcpy(frames.data() + off, &header, sizeof(header));
+
+    float * feat = reinterpret_cast<float *>(frames.data() + off + sizeof(header));
+
+    if (p.output == SpectrumOutput::MAGNITUDE) {
+        for (size_t k = 0; k < n_feat; ++k) {
+            float v = std::abs(bins[k]) * p.magnitude_scale;
+            std::memcpy(feat + k, &v, sizeof(v));
+        }
+        return;
+    }
+
+    for (size_t b = 0; b < n_feat; ++b) {
+        float energy = 0.0f;
+
+        for (uint32_t k = p.band_bins[b].first; k < p.band_bins[b].second; ++k)
+            energy += ((k == 0 || k == n / 2) ? 0.5f : 1.0f) * std::norm(bins[k]);
+
+        energy *= p.power_scale;
+        std::memcpy(feat + b, &energy, sizeof(energy));
+    }
+}
+
+void SpectrumAnalyzer::reset() {
+    std::fill(this->history.begin(), this->history.end(), 0.0f);
+    this->pos = 0;
+    this->until_frame = this->history.size();
+    this->frame = 0;
+}
+
+void SpectrumAnalyzer::save_state(vector<unsigned char> & out) const {
+    const uint64_t counters[3] = {this->pos, this->until_frame, this->frame};
+    const auto * h = reinterpret_cast<const unsigned char *>(this->history.data());
+    const auto * c = reinterpret_cast<const unsigned char *>(counters);
+
+    out.insert(out.end(), h, h + this->history.size() * sizeof(float));
+    out.insert(out.end(), c, c + sizeof(counters));
+}
+
+const unsigned char * SpectrumAnalyzer::load_state(const unsigned char * in) {
+    uint64_t counters[3];
+    std::memcpy(this->history.data(), in, this->history.size() * sizeof(float));
+    in += this->history.size() * sizeof(float);
+    std::memcpy(counters, in, sizeof(counters));
+
+    this->pos = static_cast<size_t>(counters[0]);
+    this->until_frame = static_cast<size_t>(counters[1]);
+    this->frame = counters[2];
+    return in + sizeof(counters);
+}
+
+SpectrumAnalyzer SpectrumAnalyzer::clone(std::pmr::memory_resource * arena) const {
+    return SpectrumAnalyzer {this->plan, arena};
+}
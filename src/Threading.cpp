@@ -0,0 +1,67 @@
+#include <nfp/Threading.hpp>
+#include <cstdint>
+
+#if defined(__SSE__) || defined(_M_X64)
+    #include <xmmintrin.h>
+#endif
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/mman.h>
+#endif
+
+bool nfp::pin_current_thread(int cpu) {
+    if (cpu < 0)
+        return false;
+
+    #if defined(_WIN32)
+        if (cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8))
+            return false;
+        return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+    #elif defined(__linux__)
+        if (cpu >= CPU_SETSIZE)
+            return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    #else
+        return false;
+    #endif
+}
+
+bool nfp::set_current_thread_fifo(int priority) {
+    #if defined(_WIN32)
+        return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+    #else
+        sched_param param {};
+        param.sched_priority = priority;
+        return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+    #endif
+}
+
+bool nfp::lock_process_memory() {
+    #if defined(_WIN32)
+        return false;
+    #else
+        return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+    #endif
+}
+
+bool nfp::flush_denormals_on_current_thread() {
+    #if defined(__SSE__) || defined(_M_X64)
+        // FTZ (bit 15) and DAZ (bit 6) of MXCSR.
+        _mm_setcsr(_mm_getcsr() | 0x8040);
+        return true;
+    #elif defined(__aarch64__)
+        uint64_t fpcr;
+        __asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+        __asm__ volatile("msr fpcr, %0" :: "r"(fpcr | (uint64_t{1} << 24)));
+        return true;
+    #else
+        return false;
+    #endif
+}
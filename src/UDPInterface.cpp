@@ -1,12 +1,56 @@
 #include <nfp/UDPInterface.hpp>
+#include <nfp/Kernels.hpp>
 #include <vector>
 #include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <cstdlib>
+#include <cerrno>
+#include <map>
+#include <type_traits>
+
+#ifdef __linux__
+    #include <sys/socket.h>
+#endif
 
 using boost::asio::ip::udp;
 using nfp::Datagram;
+using nfp::Datagram16;
 using nfp::UDPServer;
 using nfp::UDPClient;
 using nfp::UDPWorker;
+using nfp::ConnState;
+
+UDPServer::UDPServer(boost::asio::io_context& io_context, int port, bool reuse_port)
+    : socket(open_socket(io_context, port, reuse_port)) {}
+
+udp::socket UDPServer::open_socket(boost::asio::io_context& io_context, int port, bool reuse_port) {
+    udp::socket socket {io_context};
+    socket.open(udp::v4());
+    socket.set_option(boost::asio::socket_base::reuse_address(true));
+
+    #ifdef SO_REUSEPORT
+        if (reuse_port)
+            socket.set_option(boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+    #endif
+
+    socket.bind(udp::endpoint(udp::v4(), port));
+    return socket;
+}
+
+void UDPServer::start() {
+    std::weak_ptr<UDPServer> weak = this->weak_from_this();
+
+    this->resume_reads = [weak]() {
+        if (auto self = weak.lock())
+            boost::asio::post(self->socket.get_executor(), [self]() {
+                if (self->socket.is_open())
+                    self->start_receive();
+            });
+    };
+
+    this->start_receive();
+}
 
 void UDPServer::start_receive() {
     auto self = shared_from_this();
@@ -18,13 +62,15 @@ void UDPServer::start_receive() {
 
             if (ec == boost::asio::error::operation_aborted) return;
 
-            if (!ec && bytes_recv == sizeof(Datagram)){
+            if (!ec && (bytes_recv == sizeof(Datagram) || bytes_recv == sizeof(Datagram16))){
                 auto from = self->remote_endpoint;
                 auto pkg = self->rcv_package;
+                const bool q15 = bytes_recv == sizeof(Datagram16);
 
-                boost::asio::post(self->worker->get_executor(), [self, pkg = std::move(pkg), from = std::move(from) ](){
-                    self->worker->handle_pkg(std::move(pkg), std::move(from));
-                });
+                if (self->inline_dispatch)
+                    self->worker->handle_pkg(std::move(pkg), std::move(from), q15);
+                else if (!self->worker->enqueue(pkg, from, q15, self->resume_reads))
+                    return;
             }
             
             self->start_receive();
@@ -32,88 +78,475 @@ void UDPServer::start_receive() {
     );
 }
 
-void UDPWorker::handle_pkg(Datagram pkg, udp::endpoint src) {
+#ifdef NFP_COROUTINES
+
+namespace {
+
+    // Output blocks of one receive batch, in buffers reused from batch to batch.
+    class BatchOutbox : public nfp::Outbox {
+    public:
+        struct Block {
+            std::vector<unsigned char> bytes;
+            uint16_t port;
+            uint16_t offset;
+            const std::vector<nfp::Sink> * sinks;
+        };
+
+        std::vector<Block> blocks;
+        size_t used = 0;
+
+        void emit(boost::asio::const_buffer data, uint16_t port, uint16_t offset, const std::vector<nfp::Sink>& sinks) override {
+            if (this->used == this->blocks.size())
+                this->blocks.emplace_back();
+
+            Block & b = this->blocks[this->used++];
+            const auto * p = static_cast<const unsigned char *>(data.data());
+            b.bytes.assign(p, p + data.size());
+            b.port = port;
+            b.offset = offset;
+            b.sinks = &sinks;
+        }
+    };
+
+}
+
+void UDPServer::start_coroutine(std::shared_ptr<UDPClient> client) {
+    boost::asio::co_spawn(this->socket.get_executor(), this->serve(std::move(client)), boost::asio::detached);
+}
+
+boost::asio::awaitable<void> UDPServer::serve(std::shared_ptr<UDPClient> client) {
+    auto self = shared_from_this();
+    BatchOutbox outbox;
+    Datagram pkg;
+    udp::endpoint from;
+    boost::system::error_code ec;
+
+    this->socket.non_blocking(true);
+
+    while (this->socket.is_open()) {
+        size_t n = co_await this->socket.async_receive_from(boost::asio::buffer(&pkg, sizeof(Datagram)), from,
+            boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+
+        if (ec == boost::asio::error::operation_aborted)
+            co_return;
+
+        for (unsigned k = 0; !ec && k < RECV_BATCH; ++k) {
+            if (n == sizeof(Datagram) || n == sizeof(Datagram16))
+                this->worker->handle_pkg(pkg, from, n == sizeof(Datagram16), outbox);
+
+            n = this->socket.receive_from(boost::asio::buffer(&pkg, sizeof(Datagram)), from, 0, ec);
+        }
+
+        for (size_t i = 0; i < outbox.used; ++i) {
+            const auto & b = outbox.blocks[i];
+            co_await client->co_send(boost::asio::buffer(b.bytes), b.port, b.offset, *b.sinks);
+        }
+
+        outbox.used = 0;
+    }
+}
+
+#endif
+
+// Branch-free peak so the per-packet check vectorizes; it costs less than one biquad pass.
+static bool block_below(const float * x, size_t n, float threshold) {
+    float peak = 0.0f;
+    for (size_t i = 0; i < n; ++i)
+        peak = std::max(peak, std::fabs(x[i]));
+    return peak < threshold;
+}
+
+static bool block_below(const int16_t * x, size_t n, int32_t threshold) {
+    int32_t peak = 0;
+    for (size_t i = 0; i < n; ++i)
+        peak = std::max(peak, std::abs(static_cast<int32_t>(x[i])));
+    return peak < threshold;
+}
+
+// Model-based concealment runs on float samples; Q15 connections convert at the edges.
+static void model_receive(nfp::Concealer& concealer, Datagram& block, bool q15) {
+    if (!q15) {
+        concealer.receive(block.data);
+        return;
+    }
+
+    float x[128];
+    nfp::float_from_q15(block.data16, x, 128);
+
+    if (concealer.receive(x))
+        nfp::q15_from_float(x, block.data16, 128);
+}
+
+static void model_conceal(nfp::Concealer& concealer, Datagram& block, bool q15) {
+    if (!q15) {
+        concealer.conceal(block.data);
+        return;
+    }
+
+    float x[128];
+    concealer.conceal(x);
+    nfp::q15_from_float(x, block.data16, 128);
+}
+
+// Linear fade over one block from the tier being left to the one taking over.
+static void crossfade(const float * from, float * to) {
+    nfp::kernels().crossfade(from, to, 128, 128, 1.0f);
+}
+
+// Adds the time until it goes out of scope to a shard's busy time, when tiers are in use.
+class BusyTimer {
+private:
+    std::atomic<uint64_t> & busy_ns;
+    steady_clock::time_point start;
+    bool active;
+
+public:
+    BusyTimer(std::atomic<uint64_t> & busy_ns, bool active)
+        : busy_ns(busy_ns), start(active ? steady_clock::now() : steady_clock::time_point{}), active(active) {}
+
+    ~BusyTimer() {
+        if (this->active)
+            this->busy_ns.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(steady_clock::now() - this->start).count()),
+                std::memory_order_relaxed);
+    }
+};
+
+// Independent graph branches are offered to the pool; the calling worker claims branches too, so a
+// busy pool only costs parallelism, never progress.
+struct GraphJob {
+    std::atomic<size_t> next {0};
+    std::atomic<size_t> done {0};
+    size_t n;
+    const std::function<void(size_t)> * fn;
+
+    void run() {
+        for (size_t i; (i = this->next.fetch_add(1, std::memory_order_relaxed)) < this->n; ) {
+            (*this->fn)(i);
+            this->done.fetch_add(1, std::memory_order_release);
+        }
+    }
+};
+
+UDPWorker::UDPWorker(boost::asio::thread_pool& pool, unsigned n_shards, unsigned jitter_depth)
+    : thread_pool(pool), reap_timer(pool.get_executor()) {
+
+    for (unsigned i = 0; i < std::max(n_shards, 1u); ++i)
+        this->shards.push_back(std::make_unique<Shard>(jitter_depth));
+
+    for (size_t b = 0; b < BUCKETS; ++b)
+        this->owners[b].store(static_cast<uint16_t>(b % this->shards.size()));
+
+    this->graph_runner = [&pool](size_t n, const std::function<void(size_t)>& fn) {
+        auto job = std::make_shared<GraphJob>();
+        job->n = n;
+        job->fn = &fn;
+
+        for (size_t k = 1; k < n; ++k)
+            boost::asio::post(pool, [job]() { job->run(); });
+
+        job->run();
+
+        while (job->done.load(std::memory_order_acquire) < n)
+            std::this_thread::yield();
+    };
+
+    this->schedule_reap();
+}
+
+uint64_t UDPWorker::conn_key(const udp::endpoint& src) {
+    return (static_cast<uint64_t>(src.address().to_v4().to_uint()) << 16) | static_cast<uint64_t>(src.port());
+}
+
+void UDPWorker::set_ingress(size_t capacity, nfp::OVERLOAD policy, bool pause) {
+    for (auto & shard : this->shards) {
+        std::lock_guard<std::mutex> lock(shard->ingress_mtx);
+        shard->ingress = nfp::IngressQueue<Ingress>(capacity);
+    }
+
+    this->overload_policy = policy;
+    this->pause_reads = pause;
+}
+
+// Returns false when the receiver should stop reading: the shard's queue is full, and resume is
+// called once it has drained to half. Meanwhile the kernel socket buffer fills and drops.
+bool UDPWorker::enqueue(const Datagram& pkg, const udp::endpoint& src, bool q15, const std::function<void()>& resume) {
+    const uint64_t key = conn_key(src);
+    Shard& shard = this->shard_of(key);
+
+    // mtx is held while packets are filtered, so the receiver asks the table's lock-free hint
+    // instead; the queue keeps the answer.
+    const bool established = shard.conns.may_contain(key);
+
+    std::lock_guard<std::mutex> lock(shard.ingress_mtx);
+
+    switch (shard.ingress.push(key, Ingress{pkg, src, q15}, this->overload_policy, established)) {
+        case nfp::IngressQueue<Ingress>::Admit::DROPPED:
+            ++shard.stats.dropped;
+            break;
+        case nfp::IngressQueue<Ingress>::Admit::REPLACED:
+            ++shard.stats.replaced;
+            break;
+        default:
+            break;
+    }
+
+    if (!shard.draining) {
+        shard.draining = true;
+        boost::asio::post(this->thread_pool, [this, &shard]() { this->drain(shard); });
+    }
+
+    if (!this->pause_reads || !shard.ingress.full())
+        return true;
+
+    ++shard.stats.read_pauses;
+    shard.paused_readers.push_back(resume);
+    return false;
+}
+
+// Filters up to DRAIN_BATCH packets, then yields the pool thread to the other shards.
+void UDPWorker::drain(Shard& shard) {
+    Ingress item;
+    std::vector<std::function<void()>> resume;
 
-    uint64_t _hash = (static_cast<uint64_t>(src.address().to_v4().to_uint()) << 16) |
-    static_cast<uint64_t>(src.port());
+    for (unsigned n = 0; n < DRAIN_BATCH; ++n) {
+        {
+            std::lock_guard<std::mutex> lock(shard.ingress_mtx);
+
+            if (!shard.ingress.pop(item)) {
+                shard.draining = false;
+                return;
+            }
+
+            if (!shard.paused_readers.empty() && shard.ingress.size() <= shard.ingress.capacity() / 2)
+                resume.swap(shard.paused_readers);
+        }
+
+        for (auto & r : resume)
+            r();
+        resume.clear();
+
+        this->handle_pkg(item.pkg, item.src, item.q15);
+    }
+
+    boost::asio::post(this->thread_pool, [this, &shard]() { this->drain(shard); });
+}
+
+nfp::IngressStats UDPWorker::ingress_stats() {
+    IngressStats total;
+
+    for (auto & shard : this->shards) {
+        std::lock_guard<std::mutex> lock(shard->ingress_mtx);
+        total.dropped += shard->stats.dropped;
+        total.replaced += shard->stats.replaced;
+        total.read_pauses += shard->stats.read_pauses;
+    }
+
+    return total;
+}
+
+void UDPWorker::handle_pkg(Datagram pkg, udp::endpoint src, bool q15) {
+    this->process_pkg(pkg, src, q15, nullptr);
+}
+
+void UDPWorker::handle_pkg(Datagram pkg, udp::endpoint src, bool q15, Outbox & outbox) {
+    this->process_pkg(pkg, src, q15, &outbox);
+}
+
+template<typename T> static constexpr nfp::shm_layout::FORMAT shm_format() {
+    if constexpr (std::is_same_v<T, float>)
+        return nfp::shm_layout::FLOAT32;
+    else if constexpr (std::is_same_v<T, int16_t>)
+        return nfp::shm_layout::INT16;
+    else
+        return nfp::shm_layout::FRAMES;
+}
+
+// out holds one or more datagrams of block elements each. The route's ring, if it has one, gets
+// every block before the sockets do.
+template<typename T>
+void UDPWorker::emit(const std::vector<T>& out, size_t block, uint16_t port, uint16_t route, uint16_t offset, Outbox * outbox) {
+    if (out.empty())
+        return;
+
+    const bool routed = this->routes && !this->routes->empty();
+
+    if (routed && this->shm_outputs[route]) {
+        for (size_t i = 0; i < out.size(); i += block)
+            this->shm_outputs[route]->write(out.data() + i, block * sizeof(T), static_cast<uint16_t>(port + offset), shm_format<T>());
+
+        if (!this->routes->at(route).shm.udp)
+            return;
+    }
+
+    const auto & sinks = routed ? this->routes->at(route).sinks : NO_SINKS;
+
+    if (!outbox) {
+        this->dispatch_send(out, block, port, sinks, offset);
+        return;
+    }
+
+    for (size_t i = 0; i < out.size(); i += block)
+        outbox->emit(boost::asio::buffer(out.data() + i, block * sizeof(T)), port, offset, sinks);
+}
+
+// Locks the shard owning a bucket. The bucket may move while the lock is awaited; then the new
+// owner is tried, which has the bucket's connections in its inbox by the time the owner changes.
+UDPWorker::Shard& UDPWorker::lock_bucket(size_t bucket, std::unique_lock<std::mutex>& lock) {
+    for (;;) {
+        Shard& shard = *this->shards[this->owners[bucket].load(std::memory_order_acquire)];
+        lock = std::unique_lock<std::mutex>(shard.mtx);
+
+        if (this->shards[this->owners[bucket].load(std::memory_order_acquire)].get() == &shard) {
+            this->accept_handoffs(shard);
+            return shard;
+        }
+
+        lock.unlock();
+    }
+}
+
+// Filters, concealment policy and concealer of a new connection on the given route.
+void UDPWorker::setup_conn(ConnState& conn, uint16_t route_index) {
+    if (this->routes && !this->routes->empty()) {
+        conn.route = route_index;
+        const auto& route = this->routes->at(conn.route);
+        conn.cold->pipeline.emplace(route.pipeline.clone(&conn.cold->arena));
+        conn.policy = route.policy;
+
+        if (!route.fixed.empty())
+            conn.cold->fixed.emplace(route.fixed.clone(&conn.cold->arena));
+
+        if (route.graph)
+            conn.cold->graph.emplace(route.graph->clone(&conn.cold->arena));
+
+        conn.cold->tiers.reserve(route.tiers.size());
+        for (const auto& tier : route.tiers)
+            conn.cold->tiers.push_back(tier.clone(&conn.cold->arena));
+    } else {
+        conn.cold->pipeline.emplace(this->pipeline_factory());
+        conn.policy = this->loss_policy;
+    }
+
+    if (nfp::model_based(conn.policy))
+        conn.cold->concealer.emplace(nfp::concealment_model(conn.policy), &conn.cold->arena);
+}
+
+void UDPWorker::process_pkg(Datagram& pkg, const udp::endpoint& src, bool q15, Outbox * outbox) {
+
+    uint64_t _hash = conn_key(src);
 
     uint16_t client_port;
     std::vector<float> client_output;
-    std::vector<float> input;
-    input.reserve(128);
 
     bool send_data = false;
 
-    std::unique_lock<std::mutex> lock(this->conns_mtx);
-    
-    auto& conn = this->conns[_hash];
+    std::unique_lock<std::mutex> lock;
+    Shard& shard = this->lock_bucket(bucket_of(_hash), lock);
+    BusyTimer busy {shard.busy_ns, this->max_tier > 0};
+
+    bool inserted;
+    auto& conn = shard.conns.find_or_insert(_hash, inserted);
+
+    const uint64_t now = this->now_tick.load(std::memory_order_relaxed);
+    conn.deadline = now + this->timeout_ticks();
+
+    if (inserted) {
+        shard.expiry_wheel.schedule(_hash, conn.deadline);
+        conn.expected_seq = pkg.seq;
+
+        const bool routed = this->routes && !this->routes->empty();
+        this->setup_conn(conn, routed ? this->routes->lookup(src.address().to_v4().to_uint(), src.port(), pkg.out_port) : 0);
 
-    if (!conn.is_ready) {
-        conn.is_ready = true;
-        conn.pipeline = this->pipeline_factory();
+        if (q15)
+            conn.flags |= ConnState::INT16;
     }
 
-    auto now = steady_clock::now();
+    // A connection keeps the sample format of its first datagram; stray formats are converted.
+    const bool q15_conn = conn.flags & ConnState::INT16;
+    const size_t payload = q15_conn ? sizeof(pkg.data16) : sizeof(pkg.data);
+
+    if (q15 != q15_conn) {
+        Datagram converted;
 
-    conn.last_arrive = now;
-    conn.deadline = now + this->default_timeout;
+        if (q15_conn)
+            nfp::q15_from_float(pkg.data, converted.data16, 128);
+        else
+            nfp::float_from_q15(pkg.data16, converted.data, 128);
+
+        std::memcpy(pkg.data, converted.data, payload);
+    }
 
-    if (pkg.seq >= conn.expected_seq + 2 * W) {
+    const unsigned depth = shard.conns.get_jitter_depth();
+    const uint64_t mask = depth - 1;
+
+    if (pkg.seq >= conn.expected_seq + 2 * depth || pkg.seq + 2 * depth <= conn.expected_seq) {
         conn.expected_seq = pkg.seq;
-        conn.present.reset();
+        conn.present = 0;
+        conn.flags &= ~ConnState::INITIALIZED;
     }
 
-    int idx_new = pkg.seq % this->W;
-    conn.buffer[idx_new] = pkg;
-    conn.present[idx_new] = true;
+    // Its block was already concealed, and the stream has no lag for it to take up.
+    if ((conn.flags & ConnState::INITIALIZED) && pkg.seq < conn.expected_seq)
+        return;
 
-    if (conn.present.count() < 5)
-        conn.initialized = false;
-    else
-        conn.initialized = true;
+    int idx_new = pkg.seq & mask;
+    std::memcpy(&conn.slots()[idx_new], &pkg, q15_conn ? sizeof(Datagram16) : sizeof(Datagram));
+    conn.present |= 1u << idx_new;
+
+    // Once filled, the buffer stays initialized until a seq jump empties it.
+    if (std::bitset<32>(conn.present).count() >= std::min(this->warm_up, depth))
+        conn.flags |= ConnState::INITIALIZED;
+
+    Datagram block;
 
-    if (conn.initialized) {
-        int idx = conn.expected_seq % this->W;
+    if (conn.flags & ConnState::INITIALIZED) {
+        int idx = conn.expected_seq & mask;
         
-        if (conn.present[idx]) {
+        // A slot may still hold a packet that arrived too late, or one skipped while filling.
+        if ((conn.present & (1u << idx)) && conn.slots()[idx].seq == conn.expected_seq) {
 
-            float * ptr_data = conn.buffer[idx].data;            
-            client_port = conn.buffer[idx].out_port;
+            const Datagram& slot = conn.slots()[idx];
+            client_port = slot.out_port;
             conn.last_port = client_port;
             
-            input.assign(ptr_data, ptr_data + 128);
-            conn.present[idx] = false;
-            
-            conn.last_good = input;
-            conn.faded_last_good.resize(conn.last_good.size());
+            std::memcpy(block.data, slot.data, payload);
+            conn.present &= ~(1u << idx);
+
+            if (conn.cold->concealer)
+                model_receive(*conn.cold->concealer, block, q15_conn);
             
-            for (size_t i = 0; i < conn.last_good.size(); ++i)
-                conn.faded_last_good[i] = 0.8f * conn.last_good[i];
+            std::memcpy(conn.cold->last_good, block.data, payload);
 
             send_data = true;
             ++conn.expected_seq;
 
         } else {
 
-            std::vector<float> faded_last; 
             client_port = conn.last_port;
+            conn.present &= ~(1u << idx);
+            const float * last_good = conn.cold->last_good;
 
-            switch (this->loss_policy) {
+            switch (conn.policy) {
                 case CONCEALMENT::REPEAT_LAST_GOOD:
-                    input = conn.last_good;
+                    std::memcpy(block.data, last_good, payload);
                     break;
                 case CONCEALMENT::FADE_LAST_GOOD:
-                    input = conn.faded_last_good;
-
-                    conn.faded_last_good.resize(conn.last_good.size());
-                    for (size_t i = 0; i < conn.last_good.size(); ++i)
-                        conn.faded_last_good[i] = 0.8f * conn.last_good[i];
-                        
+                    if (q15_conn) {
+                        std::memcpy(block.data16, conn.cold->last_good16, payload);
+                        nfp::scale_q15(block.data16, 128, FADE_FACTOR_Q15);
+                    } else {
+                        nfp::kernels().scale(last_good, block.data, 128, FADE_FACTOR);
+                    }
                     break;
                 case CONCEALMENT::ALL_ZERO:
-                    input = ZERO_OUTPUT;
+                    std::memset(block.data, 0, payload);
                     break;  
+                case CONCEALMENT::LPC_EXTRAPOLATION:
+                case CONCEALMENT::PITCH_REPETITION:
+                    model_conceal(*conn.cold->concealer, block, q15_conn);
+                    break;
                 default:
+                    std::memset(block.data, 0, payload);
                     break;
             }
 
@@ -123,91 +556,589 @@ void UDPWorker::handle_pkg(Datagram pkg, udp::endpoint src) {
 
     } else {
         client_port = conn.last_port;
-        input = ZERO_OUTPUT;
+        std::memset(block.data, 0, payload);
         send_data = true;
         ++conn.expected_seq;
     }
 
-    if (input.size() != 128)
-        input = ZERO_OUTPUT;
+    // Blocks already waiting behind this one, left by a loss or a burst, are released in the same
+    // pass, filtered as one run and handed to the sender together, so the stream never lags.
+    size_t n_blocks = 1;
+    const float * input = block.data;
+    const int16_t * input16 = block.data16;
+    thread_local std::vector<float> batch;
+    thread_local std::vector<int16_t> batch16;
+
+    if (conn.flags & ConnState::INITIALIZED) {
+        for (;;) {
+            const int idx = conn.expected_seq & mask;
+            Datagram& slot = conn.slots()[idx];
+
+            // A batch goes to one port; a block for another waits for the next pass.
+            if (!(conn.present & (1u << idx)) || slot.seq != conn.expected_seq || slot.out_port != client_port)
+                break;
 
-    conn.pipeline.processBlock(input, client_output);
+            if (n_blocks == 1 && q15_conn)
+                batch16.assign(block.data16, block.data16 + 128);
+            else if (n_blocks == 1)
+                batch.assign(block.data, block.data + 128);
+
+            conn.present &= ~(1u << idx);
+
+            if (conn.cold->concealer)
+                model_receive(*conn.cold->concealer, slot, q15_conn);
+
+            if (q15_conn)
+                batch16.insert(batch16.end(), slot.data16, slot.data16 + 128);
+            else
+                batch.insert(batch.end(), slot.data, slot.data + 128);
+
+            std::memcpy(conn.cold->last_good, slot.data, payload);
+            ++conn.expected_seq;
+            ++n_blocks;
+        }
+
+        if (n_blocks > 1) {
+            input = batch.data();
+            input16 = batch16.data();
+        }
+    }
+
+    const size_t n_samples = n_blocks * 128;
+
+    // The connection follows its shard's tier, as far as its route has tiers. The tier it leaves
+    // filters the first block once more, to crossfade into the new one from a reset state.
+    nfp::SignalPipeline * leaving = nullptr;
+    auto & tiers = conn.cold->tiers;
+
+    if (!tiers.empty()) {
+        const uint8_t tier = std::min<uint8_t>(shard.tier, static_cast<uint8_t>(tiers.size()));
+
+        if (tier != conn.tier) {
+            leaving = conn.tier ? &tiers[conn.tier - 1] : &*conn.cold->pipeline;
+            (tier > conn.tier ? shard.downgrades : shard.upgrades)++;
+            conn.tier = tier;
+            (tier ? tiers[tier - 1] : *conn.cold->pipeline).reset();
+        }
+    }
+
+    nfp::SignalPipeline & pipeline = conn.tier ? tiers[conn.tier - 1] : *conn.cold->pipeline;
+    auto & fixed = conn.cold->fixed;
+    auto & graph = conn.cold->graph;
+    const uint16_t route = conn.route;
+
+    nfp::SpectrumAnalyzer * spectrum = pipeline.get_spectrum();
+    std::vector<int16_t> output16;
+    bool silent = false;
+
+    // Idle stream: input and filter state are both below the threshold, so the output is zero
+    // to within it. The state is cleared so decaying tails never reach denormals.
+    if (this->silence_threshold > 0.0f) {
+        const int32_t threshold_q15 = std::max<int32_t>(1, static_cast<int32_t>(this->silence_threshold * 32768));
+
+        if (q15_conn)
+            silent = block_below(input16, n_samples, threshold_q15);
+        else
+            silent = block_below(input, n_samples, this->silence_threshold);
+
+        if (silent && fixed)
+            silent = fixed->quiescent(std::max<int32_t>(65536, static_cast<int32_t>(this->silence_threshold * 2147483648.0f)));
+        else if (silent && graph)
+            silent = graph->quiescent(this->silence_threshold);
+        else if (silent)
+            silent = pipeline.quiescent(this->silence_threshold);
+
+        if (silent) {
+            pipeline.reset();
+
+            if (fixed)
+                fixed->reset();
+
+            if (graph)
+                graph->reset();
+
+            if (!spectrum && !graph) {
+                lock.unlock();
+
+                if (!send_data || this->suppress_silence)
+                    return;
+
+                if (q15_conn && n_blocks == 1)
+                    this->emit(ZERO_OUTPUT16, 128, client_port, route, 0, outbox);
+                else if (q15_conn)
+                    this->emit(std::vector<int16_t>(n_samples, 0), 128, client_port, route, 0, outbox);
+                else if (n_blocks == 1)
+                    this->emit(ZERO_OUTPUT, 128, client_port, route, 0, outbox);
+                else
+                    this->emit(std::vector<float>(n_samples, 0.0f), 128, client_port, route, 0, outbox);
+                return;
+            }
+
+            client_output.assign(n_samples, 0.0f);
+        }
+    }
+
+    // Graph routes fan out: output i goes to client_port + i, in the connection's sample format.
+    // Graphs run block by block; output i's blocks are kept together so each goes out in one call.
+    if (graph) {
+        const size_t n_out = graph->n_outputs();
+
+        if (!silent) {
+            float widened[128];
+            client_output.resize(n_out * n_samples);
+
+            for (size_t k = 0; k < n_blocks; ++k) {
+                const float * in = input + k * 128;
+
+                if (q15_conn) {
+                    nfp::float_from_q15(input16 + k * 128, widened, 128);
+                    in = widened;
+                }
+
+                graph->processBlock(in, 128, &this->graph_runner);
+
+                for (size_t i = 0; i < n_out; ++i)
+                    std::copy(graph->output(i), graph->output(i) + 128, client_output.begin() + i * n_samples + k * 128);
+            }
+        }
+
+        lock.unlock();
+
+        if (!send_data || (silent && this->suppress_silence))
+            return;
+
+        // emit copies whatever it keeps, so one buffer per thread serves every output.
+        thread_local std::vector<float> fanout;
+
+        for (size_t i = 0; i < n_out; ++i) {
+            const uint16_t offset = static_cast<uint16_t>(i);
+            const float * y = silent ? client_output.data() : client_output.data() + i * n_samples;
+
+            if (q15_conn) {
+                output16.resize(n_samples);
+                nfp::q15_from_float(y, output16.data(), n_samples);
+                this->emit(output16, 128, client_port, route, offset, outbox);
+            } else {
+                fanout.assign(y, y + n_samples);
+                this->emit(fanout, 128, client_port, route, offset, outbox);
+            }
+        }
+        return;
+    }
+
+    float faded[128];
+
+    if (!silent && q15_conn) {
+        output16.resize(n_samples);
+
+        if (fixed) {
+            fixed->processBlock(input16, output16.data(), n_samples);
+        } else {
+            client_output.resize(n_samples);
+            nfp::float_from_q15(input16, client_output.data(), n_samples);
+
+            if (leaving)
+                leaving->processBlock(client_output.data(), faded, 128);
+
+            pipeline.processBlock(client_output.data(), client_output.data(), n_samples);
+
+            if (leaving)
+                crossfade(faded, client_output.data());
+
+            nfp::q15_from_float(client_output.data(), output16.data(), n_samples);
+        }
+
+        if (spectrum) {
+            client_output.resize(n_samples);
+            nfp::float_from_q15(output16.data(), client_output.data(), n_samples);
+        }
+    } else if (!silent && fixed) {
+        // A float connection never reads batch16, so it serves as the Q15 scratch.
+        batch16.resize(n_samples);
+        nfp::q15_from_float(input, batch16.data(), n_samples);
+        fixed->processBlock(batch16.data(), batch16.data(), n_samples);
+        client_output.resize(n_samples);
+        nfp::float_from_q15(batch16.data(), client_output.data(), n_samples);
+    } else if (!silent) {
+        client_output.resize(n_samples);
+
+        if (leaving)
+            leaving->processBlock(input, faded, 128);
+
+        pipeline.processBlock(input, client_output.data(), n_samples);
+
+        if (leaving)
+            crossfade(faded, client_output.data());
+    }
+
+    // Spectrum pipelines send feature frames, one datagram each, instead of samples.
+    if (spectrum) {
+        std::vector<uint8_t> frames;
+        spectrum->push(client_output.data(), client_output.size(), frames);
+
+        lock.unlock();
+
+        if (!send_data || (silent && this->suppress_silence))
+            return;
+
+        this->emit(frames, spectrum->frame_bytes(), client_port, route, 0, outbox);
+        return;
+    }
 
     lock.unlock();
 
-    if (send_data)
-        this->send_to_client(client_output, client_port);
+    if (!send_data)
+        return;
+
+    if (q15_conn)
+        this->emit(output16, 128, client_port, route, 0, outbox);
+    else
+        this->emit(client_output, 128, client_port, route, 0, outbox);
 }
 
-void UDPWorker::send_to_client(const std::vector<float>& out, uint16_t port) {
-    if (!this->client)
+// Hot entry, cold slot without the shared arena size, and the arena this route's state needs.
+size_t UDPWorker::connection_bytes(const nfp::Route& route) const {
+    const auto& table = this->shards.front()->conns;
+    return table.hot_bytes_per_connection() + table.cold_bytes_per_connection() - table.arena_bytes_per_connection() + route.arena_bytes();
+}
+
+void UDPWorker::set_routes(std::shared_ptr<const nfp::RouteTable> r) {
+    size_t arena = 0;
+
+    for (uint16_t i = 0; i < r->size(); ++i)
+        arena = std::max(arena, r->at(i).arena_bytes());
+
+    for (auto & shard : this->shards) {
+        std::lock_guard<std::mutex> lock(shard->mtx);
+        shard->conns.set_arena_bytes(arena);
+    }
+
+    // Routes naming the same ring share it, with slots for the largest block any of them sends.
+    std::map<std::string, size_t> slot_bytes;
+    std::map<std::string, std::shared_ptr<nfp::OutputRing>> rings;
+
+    for (uint16_t i = 0; i < r->size(); ++i) {
+        const auto& route = r->at(i);
+        const auto * spectrum = route.graph ? nullptr : route.pipeline.get_spectrum();
+        size_t & bytes = slot_bytes[route.shm.name];
+        bytes = std::max({bytes, 128 * sizeof(float), spectrum ? spectrum->frame_bytes() : 0});
+    }
+
+    this->shm_outputs.assign(r->size(), nullptr);
+    this->max_tier = 0;
+
+    for (uint16_t i = 0; i < r->size(); ++i)
+        this->max_tier = std::max(this->max_tier, static_cast<uint8_t>(r->at(i).tiers.size()));
+
+    for (uint16_t i = 0; i < r->size(); ++i) {
+        const auto& shm = r->at(i).shm;
+
+        if (shm.name.empty())
+            continue;
+
+        auto & ring = rings[shm.name];
+
+        if (!ring)
+            ring = std::make_shared<nfp::OutputRing>(shm.name, shm.slots, slot_bytes[shm.name]);
+
+        this->shm_outputs[i] = ring;
+    }
+
+    this->routes = std::move(r);
+}
+
+size_t UDPWorker::size() {
+    size_t n = 0;
+
+    for (auto & shard : this->shards) {
+        std::lock_guard<std::mutex> lock(shard->mtx);
+        this->accept_handoffs(*shard);
+        n += shard->conns.size();
+    }
+
+    return n;
+}
+
+// One copy of the blocks is shared by every sink; it lives until the last pending send completes.
+// A batch of blocks costs one copy and one post, and goes out in order.
+template<typename T>
+void UDPWorker::dispatch_send(const std::vector<T>& out, size_t block, uint16_t port, const std::vector<nfp::Sink>& sinks, uint16_t offset) {
+    if (this->clients.empty() || out.empty())
         return;
+
+    UDPClient * client = this->clients[(port + offset) % this->clients.size()].get();
     
-    auto data = std::make_shared<std::vector<float>>(out);
+    if (this->inline_send) {
+        for (size_t i = 0; i < out.size(); i += block)
+            client->send(boost::asio::buffer(out.data() + i, block * sizeof(T)), port, offset, sinks);
+        return;
+    }
+
+    auto data = std::make_shared<const std::vector<T>>(out);
     
-    boost::asio::post(this->thread_pool, [this, data, port]() {
-        client->async_send(*data, port);
+    // Route sinks live in the route table, which outlives the clients.
+    boost::asio::post(client->get_executor(), [client, data, block, port, offset, sinks = &sinks]() {
+        for (size_t i = 0; i < data->size(); i += block)
+            client->async_send(data, boost::asio::buffer(data->data() + i, block * sizeof(T)), port, offset, *sinks);
     });
 }
 
-void UDPClient::async_send(const std::vector<float>& data, uint16_t port) {
-    udp::endpoint endp(this->dest_ip, port);
+void UDPWorker::send_to_client(const std::vector<float>& out, uint16_t port, const std::vector<nfp::Sink>& sinks, uint16_t offset) {
+    this->dispatch_send(out, out.size(), port, sinks, offset);
+}
 
-    this->socket.async_send_to(
-        boost::asio::buffer(data.data(), data.size() * sizeof(float)),
-        endp,
-        [](boost::system::error_code ignored_ec, std::size_t l) { }
-    );
+void UDPWorker::send_to_client(const std::vector<int16_t>& out, uint16_t port, const std::vector<nfp::Sink>& sinks, uint16_t offset) {
+    this->dispatch_send(out, out.size(), port, sinks, offset);
+}
+
+void UDPWorker::send_to_client(const std::vector<uint8_t>& out, uint16_t port, const std::vector<nfp::Sink>& sinks, uint16_t offset) {
+    this->dispatch_send(out, out.size(), port, sinks, offset);
+}
+
+UDPClient::UDPClient(boost::asio::io_context & io_context, const boost::asio::ip::address_v4 out_addr)
+    : io_context(io_context), dest_ip(out_addr), strand(boost::asio::make_strand(io_context)) {
+    this->channels.push_back(Channel{1, 0, udp::socket(io_context, udp::v4())});
+}
+
+void UDPClient::add_sinks(const std::vector<nfp::Sink>& sinks) {
+    for (const auto& sink : sinks) {
+        if (!boost::asio::ip::address_v4(sink.addr).is_multicast() || this->channel_for(sink) != 0 || (sink.ttl == 1 && sink.iface == 0))
+            continue;
+
+        udp::socket socket {this->io_context, udp::v4()};
+        socket.set_option(boost::asio::ip::multicast::hops(sink.ttl));
+
+        if (sink.iface)
+            socket.set_option(boost::asio::ip::multicast::outbound_interface(boost::asio::ip::address_v4(sink.iface)));
+
+        this->channels.push_back(Channel{sink.ttl, sink.iface, std::move(socket)});
+    }
+}
+
+size_t UDPClient::channel_for(const nfp::Sink& sink) const {
+    if (!boost::asio::ip::address_v4(sink.addr).is_multicast())
+        return 0;
+
+    for (size_t c = 0; c < this->channels.size(); ++c)
+        if (this->channels[c].ttl == sink.ttl && this->channels[c].iface == sink.iface)
+            return c;
+
+    return 0;
+}
+
+// Sends as much as the socket takes without blocking, in one sendmmsg on Linux; returns how many
+// destinations were handled.
+size_t UDPClient::send_now(udp::socket& socket, const std::vector<udp::endpoint>& dests, boost::asio::const_buffer data) {
+    size_t sent = 0;
+
+    #ifdef __linux__
+        thread_local std::vector<mmsghdr> msgs;
+        iovec iov {const_cast<void *>(data.data()), data.size()};
+
+        msgs.assign(dests.size(), mmsghdr{});
+
+        for (size_t i = 0; i < dests.size(); ++i) {
+            msgs[i].msg_hdr.msg_name = const_cast<sockaddr *>(dests[i].data());
+            msgs[i].msg_hdr.msg_namelen = static_cast<socklen_t>(dests[i].size());
+            msgs[i].msg_hdr.msg_iov = &iov;
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        while (sent < dests.size()) {
+            int n = ::sendmmsg(socket.native_handle(), msgs.data() + sent, static_cast<unsigned>(dests.size() - sent), MSG_DONTWAIT);
+
+            if (n > 0)
+                sent += static_cast<size_t>(n);
+            else if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            else
+                ++sent;
+        }
+    #endif
+
+    return sent;
+}
+
+// Calls fn(socket, destinations) once per socket the sinks use.
+template<typename Fn>
+void UDPClient::each_channel(uint16_t port, uint16_t offset, const std::vector<nfp::Sink>& sinks, Fn&& fn) {
+    thread_local std::vector<udp::endpoint> dests;
+
+    if (sinks.empty()) {
+        dests.assign(1, udp::endpoint(this->dest_ip, static_cast<uint16_t>(port + offset)));
+        fn(this->channels[0].socket, dests);
+        return;
+    }
+
+    for (size_t c = 0; c < this->channels.size(); ++c) {
+        dests.clear();
+
+        for (const auto& sink : sinks)
+            if (this->channel_for(sink) == c)
+                dests.emplace_back(boost::asio::ip::address_v4(sink.addr), static_cast<uint16_t>((sink.port ? sink.port : port) + offset));
+
+        if (!dests.empty())
+            fn(this->channels[c].socket, dests);
+    }
+}
+
+// Whatever the socket can't take right away is handed to asio, which holds owner until it's sent.
+void UDPClient::send_all(const std::shared_ptr<const void>& owner, boost::asio::const_buffer data, uint16_t port,
+    uint16_t offset, const std::vector<nfp::Sink>& sinks, bool wait) {
+
+    this->each_channel(port, offset, sinks, [&](udp::socket& socket, const std::vector<udp::endpoint>& dests) {
+        for (size_t i = this->send_now(socket, dests, data); i < dests.size(); ++i) {
+            if (wait) {
+                boost::system::error_code ignored_ec;
+                socket.send_to(data, dests[i], 0, ignored_ec);
+            } else
+                socket.async_send_to(data, dests[i], [owner](boost::system::error_code, std::size_t) {});
+        }
+    });
+}
+
+#ifdef NFP_COROUTINES
+
+// The caller's buffer stays in its coroutine frame until this returns, so nothing is copied.
+boost::asio::awaitable<void> UDPClient::co_send(boost::asio::const_buffer data, uint16_t port, uint16_t offset, const std::vector<nfp::Sink>& sinks) {
+    std::vector<std::pair<udp::socket *, udp::endpoint>> blocked;
+
+    this->each_channel(port, offset, sinks, [&](udp::socket& socket, const std::vector<udp::endpoint>& dests) {
+        for (size_t i = this->send_now(socket, dests, data); i < dests.size(); ++i)
+            blocked.emplace_back(&socket, dests[i]);
+    });
+
+    for (auto & [socket, dest] : blocked) {
+        boost::system::error_code ignored_ec;
+        co_await socket->async_send_to(data, dest, boost::asio::redirect_error(boost::asio::use_awaitable, ignored_ec));
+    }
+}
+
+#endif
+
+void UDPClient::async_send(std::shared_ptr<const void> owner, boost::asio::const_buffer data, uint16_t port, uint16_t offset, const std::vector<nfp::Sink>& sinks) {
+    this->send_all(owner, data, port, offset, sinks, false);
+}
+
+void UDPClient::send(boost::asio::const_buffer data, uint16_t port, uint16_t offset, const std::vector<nfp::Sink>& sinks) {
+    this->send_all(nullptr, data, port, offset, sinks, true);
 }
 
 void UDPWorker::schedule_reap() {
-    this->reap_timer.expires_after(this->reap_period);
+    this->reap_timer.expires_at(this->epoch + (this->now_tick.load() + 1) * this->reap_period);
 
     this->reap_timer.async_wait([this](const boost::system::error_code& ec) {
         if (ec == boost::asio::error::operation_aborted)
             return;
         
-        if (ec)
+        if (ec || this->manual_clock.load())
             return;
 
-        this->reap_dead_conns();
+        this->reap_dead_conns(steady_clock::now());
         this->schedule_reap();
     });
 }
 
-void UDPWorker::reap_dead_conns() {
-    const auto now = steady_clock::now();
-    std::vector<uint64_t> addrs_to_remove;
-    addrs_to_remove.reserve(this->conns.size());
+void UDPWorker::set_manual_clock(steady_clock::time_point start) {
+    this->manual_clock.store(true);
+    this->reap_timer.cancel();
+    this->graph_runner = nullptr;
+    this->epoch = start;
+    this->now_tick.store(0);
+
+    for (auto & shard : this->shards)
+        shard->window_start = start;
+}
+
+void UDPWorker::reap_dead_conns(steady_clock::time_point at) {
+    const uint64_t now = static_cast<uint64_t>((at - this->epoch) / this->reap_period);
+    this->now_tick.store(now, std::memory_order_relaxed);
 
-    std::lock_guard<std::mutex> lock(this->conns_mtx);
+    for (auto & shard : this->shards) {
+        std::lock_guard<std::mutex> lock(shard->mtx);
+        this->accept_handoffs(*shard);
 
-    for (auto it = this->conns.begin(); it != this->conns.end(); ) {
-        if (it->second.deadline <= now)
-            it = this->conns.erase(it);
-        else
-            ++it;
+        if (this->max_tier > 0)
+            this->adapt_tier(*shard, at);
+
+        shard->expiry_wheel.advance(now, [&](uint64_t key) -> uint64_t {
+            ConnState * conn = shard->conns.find(key);
+
+            if (!conn)
+                return 0;
+
+            if (conn->deadline > now)
+                return conn->deadline;
+
+            shard->conns.erase(key);
+            return 0;
+        });
     }
 }
 
+// Every connection of a shard delivers a block per block period (128 / samp-freq), so the share
+// of the window the shard spent filtering is the share of its real-time budget it uses. Called
+// with shard.mtx held.
+void UDPWorker::adapt_tier(Shard& shard, steady_clock::time_point at) {
+    const auto window = std::chrono::duration_cast<std::chrono::nanoseconds>(at - shard.window_start).count();
+
+    if (window <= 0)
+        return;
+
+    const double load = static_cast<double>(shard.busy_ns.exchange(0, std::memory_order_relaxed)) / static_cast<double>(window);
+    shard.window_start = at;
+
+    if (load > this->tier_high && shard.tier < this->max_tier) {
+        ++shard.tier;
+        shard.calm_windows = 0;
+    } else if (load < this->tier_low && shard.tier > 0) {
+        if (++shard.calm_windows >= TIER_HOLD) {
+            --shard.tier;
+            shard.calm_windows = 0;
+        }
+    } else {
+        shard.calm_windows = 0;
+    }
+}
+
+nfp::TierStats UDPWorker::tier_stats() {
+    TierStats stats;
+    stats.connections.assign(this->max_tier + 1, 0);
+
+    for (auto & shard : this->shards) {
+        std::lock_guard<std::mutex> lock(shard->mtx);
+        stats.downgrades += shard->downgrades;
+        stats.upgrades += shard->upgrades;
+        shard->conns.for_each([&](const ConnState& conn) { stats.connections[conn.tier]++; });
+    }
+
+    return stats;
+}
+
+void nfp::UDPServer::close() {
+    boost::system::error_code ec;
+    this->socket.cancel(ec);
+    this->socket.close(ec);
+}
+
 void nfp::UDPServer::finish() {
     if (this->worker)
         worker->stop();
 
-    boost::system::error_code ec;
-    this->socket.cancel(ec);
-    this->socket.close(ec);    
+    this->close();
 }
 
 void nfp::UDPClient::close() {
-    boost::system::error_code ec;
-    this->socket.cancel(ec);
-    this->socket.close(ec);
+    for (auto & channel : this->channels) {
+        boost::system::error_code ec;
+        channel.socket.cancel(ec);
+        channel.socket.close(ec);
+    }
 }
 
 void nfp::UDPWorker::stop() {
-    if (this->client) 
-        this->client->close();
+    for (auto & client : this->clients) 
+        client->close();
     
     this->reap_timer.cancel(); 
 }
@@ -3,16 +3,33 @@
 #include <thread>
 #include <iostream>
 #include <nfp/UDPInterface.hpp>
+#include <nfp/Dispatcher.hpp>
 #include <nfp/ConfigsParse.hpp>
+#include <nfp/Plan.hpp>
+#include <nfp/Threading.hpp>
+#include <nfp/FilterAnalysis.hpp>
 #include <boost/asio.hpp>
 #include <memory>
 #include <fstream>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
 
 #ifdef _WIN32
     #include <windows.h>
+#else
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+#ifdef __linux__
+    #include <sys/prctl.h>
 #endif
 
 static volatile std::sig_atomic_t running = 1;
+static std::atomic<bool> handoff_requested {false};
 
 #ifdef _WIN32
 
@@ -40,22 +57,149 @@ void setup_signals() {
         SetConsoleCtrlHandler(console_ctrl_handle, TRUE);
     #else
         std::signal(SIGINT, on_sigint);
+        std::signal(SIGTERM, on_sigint);
     #endif
 }
 
-static const char* get_coeffs_save_path(int argc, char ** argv) {
+static const char* get_option(int argc, char ** argv, const std::string& name) {
     for (int i = 2; i < argc; ++i) {
-        if (std::string(argv[i]) == "--dump-coeffs" && i + 1 < argc)
+        if (std::string(argv[i]) == name && i + 1 < argc)
             return argv[i+1];
     }
     return nullptr;
 }
 
-int run_app(const std::string& json_path, const char * coeffs_save_path) {
-    json j = nfp::load_config_file(json_path.c_str());
+static void write_analysis(const char * path, const nfp::RouteTable& routes, float fs, unsigned points) {
+    auto file = std::ofstream(path);
+
+    if (!file) {
+        std::cerr << path << " is not a proper path!" << std::endl;
+        return;
+    }
+
+    const std::string p {path};
+    const bool as_json = p.size() >= 5 && p.compare(p.size() - 5, 5, ".json") == 0;
+
+    json out = json::object();
+
+    if (!as_json)
+        file << "route,freq,magnitude_db,phase,group_delay\n";
+
+    // Graph routes are reported chain by chain, as route/node.
+    std::vector<std::pair<std::string, std::vector<float>>> chains;
+
+    for (uint16_t r = 0; r < routes.size(); ++r) {
+        const auto& route = routes.at(r);
+
+        if (!route.graph) {
+            chains.emplace_back(route.name, route.pipeline.coeffs());
+            continue;
+        }
 
-    nfp::Conn_info conn_info = nfp::parse_conn_from(j);
-    nfp::SignalPipeline pipeline = nfp::build_pipeline(nfp::parse_pipeline_from(j), conn_info.samp_freq);
+        for (size_t c = 0; c < route.graph->n_chains(); ++c)
+            chains.emplace_back(route.name + "/" + route.graph->chain_name(c), route.graph->chain(c).coeffs());
+    }
+
+    for (const auto& [name, coeffs] : chains) {
+        nfp::FilterAnalysis analysis {coeffs, fs};
+        auto resp = analysis.response(points);
+
+        if (!as_json) {
+            for (size_t k = 0; k < resp.freqs.size(); ++k)
+                file << name << ',' << resp.freqs[k] << ',' << resp.magnitude_db[k] << ','
+                     << resp.phase[k] << ',' << resp.group_delay[k] << '\n';
+            continue;
+        }
+
+        auto report = analysis.stability(points);
+        json sections = json::array();
+
+        for (const auto& sec : report.sections) {
+            auto roots = [](const std::array<std::complex<float>, 2>& z) {
+                return json::array({json::array({z[0].real(), z[0].imag()}), json::array({z[1].real(), z[1].imag()})});
+            };
+
+            sections.push_back({
+                {"poles", roots(sec.poles)},
+                {"zeros", roots(sec.zeros)},
+                {"pole-radius", sec.pole_radius},
+                {"peak-gain-db", sec.peak_gain_db},
+                {"state-peak-gain-db", sec.state_peak_gain_db}
+            });
+        }
+
+        out[name] = {
+            {"stable", report.stable},
+            {"stability-margin", report.stability_margin},
+            {"peak-gain-db", report.peak_gain_db},
+            {"peak-freq", report.peak_freq},
+            {"sections", sections},
+            {"freq", resp.freqs},
+            {"magnitude-db", resp.magnitude_db},
+            {"phase", resp.phase},
+            {"group-delay", resp.group_delay}
+        };
+    }
+
+    if (as_json)
+        file << out.dump(2) << '\n';
+}
+
+static void tune_thread(const std::vector<int>& cpus, unsigned i, int fifo_priority) {
+    if (!cpus.empty() && !nfp::pin_current_thread(cpus[i % cpus.size()]))
+        std::cerr << "WARNING: couldn't pin thread to CPU " << cpus[i % cpus.size()] << "!" << std::endl;
+
+    if (fifo_priority > 0 && !nfp::set_current_thread_fifo(fifo_priority))
+        std::cerr << "WARNING: couldn't set SCHED_FIFO priority " << fifo_priority << "!" << std::endl;
+}
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS) && defined(SO_REUSEPORT)
+    #define NFP_HANDOFF 1
+    using local_stream = boost::asio::local::stream_protocol;
+
+    // Takes the connection table of the instance serving on path, if there is one. It stops
+    // reading, filters what it had queued and writes one snapshot before it exits; meanwhile our
+    // sockets, already bound with SO_REUSEPORT, hold the traffic.
+    static size_t take_over(const std::string& path, nfp::UDPWorker& worker, boost::asio::io_context& io) {
+        local_stream::socket peer {io};
+        boost::system::error_code ec;
+        peer.connect(local_stream::endpoint(path), ec);
+
+        if (ec)
+            return 0;
+
+        std::vector<unsigned char> snapshot;
+        boost::asio::read(peer, boost::asio::dynamic_buffer(snapshot), ec);
+
+        if (ec != boost::asio::error::eof)
+            throw std::runtime_error("Handoff from the running instance failed: " + ec.message() + "!");
+
+        return worker.restore_connections(snapshot.data(), snapshot.size());
+    }
+
+    // The next instance connecting to path ends this one.
+    static void listen_for_successor(const std::string& path, local_stream::acceptor& acceptor, local_stream::socket& successor) {
+        std::remove(path.c_str());
+        acceptor.open();
+        acceptor.bind(local_stream::endpoint(path));
+        acceptor.listen(1);
+
+        acceptor.async_accept(successor, [](boost::system::error_code ec) {
+            if (!ec)
+                handoff_requested = true;
+        });
+    }
+#endif
+
+// Plans from nfp-compile were validated when they were written.
+static void inspect_routes(const nfp::Plan& plan, bool validate, const char * coeffs_save_path, const char * analyze_path) {
+    const nfp::SignalPipeline& pipeline = plan.routes.at(0).pipeline;
+
+    if (analyze_path)
+        write_analysis(analyze_path, plan.routes, plan.conn.samp_freq, plan.analysis.points);
+
+    if (validate)
+        nfp::validate_route_table(plan.routes, plan.analysis, plan.conn.samp_freq);
 
     if (coeffs_save_path) {
         auto file = std::ofstream(coeffs_save_path) ;
@@ -66,6 +210,46 @@ int run_app(const std::string& json_path, const char * coeffs_save_path) {
             for (const auto& coeff : pipeline.coeffs())
                 file << coeff << '\n';
     }
+}
+
+// Receive sockets per instance: one per receiver where the port can be shared.
+static unsigned socket_count(const nfp::Thread_info& t_info) {
+    #ifdef SO_REUSEPORT
+        return t_info.receivers;
+    #else
+        return 1;
+    #endif
+}
+
+// A backend (backend >= 0) takes its datagrams from the dispatcher's rings instead of the port.
+int run_app(nfp::Plan plan, bool validate, const char * coeffs_save_path, const char * analyze_path, const char * handoff_path, int backend) {
+    inspect_routes(plan, validate, coeffs_save_path, analyze_path);
+
+    // Each backend writes its own shared-memory outputs, suffixed with its index.
+    for (uint16_t r = 0; backend >= 0 && r < plan.routes.size(); ++r) {
+        auto shm = plan.routes.at(r).shm;
+
+        if (!shm.name.empty()) {
+            shm.name += "-" + std::to_string(backend);
+            plan.routes.set_shm_output(r, std::move(shm));
+        }
+    }
+
+    const nfp::Conn_info& conn_info = plan.conn;
+    const nfp::Thread_info& t_info = plan.threads;
+    auto routes = std::make_shared<const nfp::RouteTable>(std::move(plan.routes));
+
+    if (t_info.lock_memory && !nfp::lock_process_memory())
+        std::cerr << "WARNING: mlockall failed, memory may be paged out!" << std::endl;
+
+    // NFP_ISA wins over the config, so one host can be pinned without touching the plan.
+    if (t_info.has_isa)
+        nfp::select_isa(t_info.isa);
+
+    if (const char * isa = std::getenv("NFP_ISA"); isa && *isa)
+        nfp::select_isa(nfp::isa_from_name(isa));
+
+    std::cout << "DSP kernels: " << nfp::isa_name(nfp::kernels().isa) << std::endl;
 
     boost::asio::io_context server_io, client_io;
 
@@ -74,43 +258,341 @@ int run_app(const std::string& json_path, const char * coeffs_save_path) {
 
     std::cout << "Initializing Server and Client... [Press CTRL + C to exit]" << std::endl;
 
-    auto server = std::make_shared<nfp::UDPServer>(server_io, conn_info.server_port);
-    auto client = std::make_unique<UDPClient>(client_io, boost::asio::ip::make_address_v4(conn_info.client_addrv4));
+    auto client_addr = boost::asio::ip::make_address_v4(conn_info.client_addrv4);
+
+    const bool inline_filter = t_info.run_to_completion || t_info.coroutines;
+
+    boost::asio::thread_pool workers {inline_filter ? 1u : 0u};
+
+    // In coroutine mode there is one shard per receiver, so shard locks are rarely contended.
+    const unsigned n_shards = std::max(t_info.coroutines ? t_info.receivers : t_info.workers, 1u);
+    auto worker = std::make_shared<nfp::UDPWorker>(workers, n_shards, conn_info.jitter_depth);
+
+    for (unsigned i = 0; i < std::max(t_info.senders, 1u); ++i) {
+        auto client = std::make_unique<UDPClient>(client_io, client_addr);
+
+        for (uint16_t r = 0; r < routes->size(); ++r)
+            client->add_sinks(routes->at(r).sinks);
+
+        worker->add_client(std::move(client));
+    }
+
+    worker->set_routes(routes);
 
-    boost::asio::thread_pool workers {2};
+    for (uint16_t r = 0; r < routes->size(); ++r) {
+        const auto& route = routes->at(r);
+        std::cout << "Route " << route.name << ": " << worker->connection_bytes(route) << " bytes per connection";
 
-    auto worker = std::make_unique<nfp::UDPWorker>(workers);
-    worker->set_client(std::move(client));
-    worker->set_pipeline_factory([j, conn_info]() mutable {
-        return nfp::build_pipeline(nfp::parse_pipeline_from(j), conn_info.samp_freq);
-    });
+        if (route.graph)
+            std::cout << ", " << route.graph->n_chains() << " chains in " << route.graph->n_buffers() << " blocks, "
+                      << route.graph->n_outputs() << " outputs";
+
+        if (!route.fixed.empty())
+            std::cout << ", Q31 SNR " << nfp::quantization_snr(route.pipeline.coeffs(), route.fixed) << " dB";
+
+        if (!route.sinks.empty())
+            std::cout << ", " << route.sinks.size() << " sinks";
+
+        if (!route.shm.name.empty())
+            std::cout << ", shared memory " << route.shm.name << (route.shm.udp ? "" : " only");
+
+        if (!route.tiers.empty())
+            std::cout << ", " << route.tiers.size() << " fallback tiers";
+
+        std::cout << std::endl;
+    }
     worker->set_concealment_policy(conn_info.policy);
-    server->set_worker(std::move(worker));
-    server->start();
+    worker->set_warm_up(conn_info.warm_up);
+    // A backend has no receive coroutines to send from, so coroutine mode sends inline too.
+    worker->set_inline_send(t_info.run_to_completion || (backend >= 0 && inline_filter));
+    worker->set_timeout(std::chrono::milliseconds(conn_info.conn_timeout_ms));
+    worker->set_silence(conn_info.silence_threshold, conn_info.suppress_silence);
+    worker->set_ingress(t_info.queue_capacity, t_info.overload_policy, t_info.pause_reads);
+    worker->set_tier_load(t_info.tier_high, t_info.tier_low);
+
+    const unsigned n_sockets = socket_count(t_info);
+
+    #ifndef NFP_HANDOFF
+        if (handoff_path) {
+            std::cerr << "WARNING: handoff needs UNIX sockets and SO_REUSEPORT, starting without it!" << std::endl;
+            handoff_path = nullptr;
+        }
+    #endif
+
+    std::vector<std::shared_ptr<nfp::UDPServer>> servers;
+    std::unique_ptr<nfp::RingServer> ring_server;
+
+    if (backend >= 0) {
+        std::vector<nfp::ShmRing> rings;
+
+        for (unsigned r = 0; r < n_sockets; ++r)
+            rings.push_back(nfp::ShmRing::attach(nfp::Dispatcher::ring_name(conn_info.server_port, backend, r)));
+
+        ring_server = std::make_unique<nfp::RingServer>(std::move(rings));
+        ring_server->set_worker(worker);
+        ring_server->set_inline_dispatch(inline_filter);
+    } else {
+        // Every socket is bound before the handoff, so the port never goes unserved.
+        for (unsigned i = 0; i < n_sockets; ++i)
+            servers.push_back(std::make_shared<nfp::UDPServer>(server_io, conn_info.server_port, n_sockets > 1 || handoff_path));
+    }
+
+    #ifdef NFP_HANDOFF
+        local_stream::acceptor handoff_acceptor {server_io};
+        local_stream::socket successor {server_io};
+
+        if (handoff_path) {
+            const size_t taken = take_over(handoff_path, *worker, server_io);
+
+            if (taken)
+                std::cout << "Took over " << taken << " connections" << std::endl;
+
+            listen_for_successor(handoff_path, handoff_acceptor, successor);
+        }
+    #endif
 
-    std::thread server_thread ([&]() { server_io.run(); });
-    std::thread client_thread ([&]() { client_io.run(); });
+    for (auto & server : servers) {
+        server->set_worker(worker);
+        server->set_inline_dispatch(t_info.run_to_completion);
 
-    while (running) 
+        #ifdef NFP_COROUTINES
+            if (t_info.coroutines) {
+                auto client = std::make_shared<UDPClient>(server_io, client_addr);
+
+                for (uint16_t r = 0; r < routes->size(); ++r)
+                    client->add_sinks(routes->at(r).sinks);
+
+                server->start_coroutine(std::move(client));
+            } else
+                server->start();
+        #else
+            server->start();
+        #endif
+    }
+
+    std::vector<std::thread> threads;
+
+    if (ring_server)
+        threads.emplace_back([&]() {
+            tune_thread(t_info.receiver_cpus, backend, t_info.fifo_priority);
+
+            if (inline_filter)
+                nfp::flush_denormals_on_current_thread();
+
+            ring_server->run();
+        });
+
+    for (unsigned i = 0; i < (ring_server ? 0 : t_info.receivers); ++i)
+        threads.emplace_back([&, i]() {
+            tune_thread(t_info.receiver_cpus, i, t_info.fifo_priority);
+
+            if (inline_filter)
+                nfp::flush_denormals_on_current_thread();
+
+            server_io.run();
+        });
+
+    for (unsigned i = 0; i < t_info.workers; ++i)
+        threads.emplace_back([&, i]() {
+            tune_thread(t_info.worker_cpus, i, t_info.fifo_priority);
+            nfp::flush_denormals_on_current_thread();
+            workers.attach();
+        });
+
+    for (unsigned i = 0; i < t_info.senders; ++i)
+        threads.emplace_back([&, i]() {
+            tune_thread(t_info.sender_cpus, i, t_info.fifo_priority);
+            client_io.run();
+        });
+
+    while (running && !handoff_requested) 
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
 
-    server->finish();
+    #ifdef NFP_HANDOFF
+        if (handoff_requested) {
+            for (auto & server : servers)
+                server->close();
+
+            worker->wait_idle();
+            auto snapshot = worker->save_connections();
+
+            boost::system::error_code ec;
+            boost::asio::write(successor, boost::asio::buffer(snapshot), ec);
+            successor.close(ec);
+            handoff_acceptor.close(ec);
+
+            if (ec)
+                std::cerr << "WARNING: handoff failed: " << ec.message() << "!" << std::endl;
+            else
+                std::cout << "Handed over " << worker->size() << " connections" << std::endl;
+        }
+    #endif
+
+    if (ring_server) {
+        ring_server->close();
+        worker->stop();
+    }
+
+    for (auto & server : servers)
+        server->finish();
 
     server_guard.reset();
     client_guard.reset();
 
     server_io.stop();
     client_io.stop();
+    workers.stop();
     
-    server_thread.join();
-    client_thread.join();
+    for (auto & t : threads)
+        t.join();
 
-    workers.stop();
     workers.join();
 
+    auto stats = worker->ingress_stats();
+    std::cout << "Ingress: " << stats.dropped << " dropped, " << stats.replaced << " replaced, "
+              << stats.read_pauses << " read pauses" << std::endl;
+
+    auto tiers = worker->tier_stats();
+
+    if (tiers.connections.size() > 1) {
+        std::cout << "Tiers:";
+        for (size_t t = 0; t < tiers.connections.size(); ++t)
+            std::cout << " " << tiers.connections[t] << (t == 0 ? " connections at tier 0," : " at " + std::to_string(t) + ",");
+        std::cout << " " << tiers.downgrades << " downgrades, " << tiers.upgrades << " upgrades" << std::endl;
+    }
+
     return 0 ; 
 }
 
+#ifndef _WIN32
+
+// Starts this program again as backend i, on the same config or plan. The child gets SIGTERM if
+// the dispatcher dies, so no backend outlives its rings' producer.
+static pid_t spawn_backend(int argc, char ** argv, unsigned i) {
+    std::vector<std::string> args {argv[0], argv[1]};
+
+    if (args[1] == "--plan" && argc > 2)
+        args.push_back(argv[2]);
+
+    args.push_back("--backend");
+    args.push_back(std::to_string(i));
+
+    std::vector<char *> c_args;
+    for (auto & arg : args)
+        c_args.push_back(arg.data());
+    c_args.push_back(nullptr);
+
+    const pid_t parent = ::getpid();
+    const pid_t pid = ::fork();
+
+    if (pid != 0)
+        return pid;
+
+    #ifdef __linux__
+        ::prctl(PR_SET_PDEATHSIG, SIGTERM);
+        if (::getppid() != parent)
+            ::_exit(1);
+
+        ::execv("/proc/self/exe", c_args.data());
+    #endif
+
+    ::execvp(c_args[0], c_args.data());
+    ::_exit(127);
+}
+
+// Receives on the public port and keeps one backend process per ring set running; a backend that
+// exits is started again a second later, with the datagrams queued for it meanwhile.
+static int run_dispatcher(const nfp::Plan& plan, int argc, char ** argv, const char * handoff_path) {
+    const nfp::Thread_info& t_info = plan.threads;
+    const uint16_t port = plan.conn.server_port;
+    const unsigned n_sockets = socket_count(t_info);
+
+    if (handoff_path)
+        std::cerr << "WARNING: handoff isn't supported with backends, starting without it!" << std::endl;
+
+    boost::asio::io_context io;
+    auto guard = boost::asio::make_work_guard(io);
+    std::vector<std::shared_ptr<nfp::Dispatcher>> dispatchers;
+
+    for (unsigned r = 0; r < n_sockets; ++r) {
+        std::vector<nfp::ShmRing> rings;
+
+        for (unsigned b = 0; b < t_info.backends; ++b)
+            rings.push_back(nfp::ShmRing::create(nfp::Dispatcher::ring_name(port, b, r), t_info.ring_capacity));
+
+        dispatchers.push_back(std::make_shared<nfp::Dispatcher>(io, port, n_sockets > 1, std::move(rings)));
+    }
+
+    std::cout << "Dispatching to " << t_info.backends << " backends... [Press CTRL + C to exit]" << std::endl;
+
+    for (auto & dispatcher : dispatchers)
+        dispatcher->start();
+
+    std::vector<std::thread> threads;
+
+    for (unsigned i = 0; i < n_sockets; ++i)
+        threads.emplace_back([&, i]() {
+            tune_thread(t_info.receiver_cpus, i, t_info.fifo_priority);
+            io.run();
+        });
+
+    std::vector<pid_t> backends(t_info.backends, -1);
+    std::vector<std::chrono::steady_clock::time_point> restart_at(t_info.backends);
+
+    while (running) {
+        const auto now = std::chrono::steady_clock::now();
+
+        for (unsigned i = 0; i < t_info.backends; ++i) {
+            int status;
+
+            if (backends[i] > 0 && ::waitpid(backends[i], &status, WNOHANG) == backends[i]) {
+                std::cerr << "WARNING: backend " << i << " exited, restarting it!" << std::endl;
+                backends[i] = -1;
+                restart_at[i] = now + std::chrono::seconds(1);
+            }
+
+            if (backends[i] < 0 && now >= restart_at[i] && running) {
+                backends[i] = spawn_backend(argc, argv, i);
+
+                if (backends[i] < 0)
+                    restart_at[i] = now + std::chrono::seconds(1);
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    for (auto & dispatcher : dispatchers)
+        dispatcher->close();
+
+    for (pid_t pid : backends)
+        if (pid > 0)
+            ::kill(pid, SIGINT);
+
+    for (pid_t pid : backends)
+        if (pid > 0)
+            ::waitpid(pid, nullptr, 0);
+
+    guard.reset();
+    io.stop();
+
+    for (auto & t : threads)
+        t.join();
+
+    for (unsigned b = 0; b < t_info.backends; ++b) {
+        uint64_t dropped = 0;
+
+        for (auto & dispatcher : dispatchers)
+            dropped += dispatcher->dropped(b);
+
+        std::cout << "Backend " << b << ": " << dropped << " dropped on full rings" << std::endl;
+    }
+
+    return 0;
+}
+
+#endif
+
 int main(int argc, char ** argv) {
 
     if (argc < 2) {
@@ -118,10 +600,33 @@ int main(int argc, char ** argv) {
         return -1;
     }
 
+    const bool from_plan = std::string(argv[1]) == "--plan";
+
+    if (from_plan && argc < 3) {
+        std::cerr << "ERROR: plan file is missing!";
+        return -1;
+    }
+
     setup_signals();
 
     try {
-        return run_app(argv[1], get_coeffs_save_path(argc, argv));
+        nfp::Plan plan = from_plan ? nfp::load_plan(argv[2]) : nfp::plan_from_config(nfp::load_config_file(argv[1]));
+        const char * backend = get_option(argc, argv, "--backend");
+
+        // The dispatcher checked the routes before starting its backends.
+        if (backend)
+            return run_app(std::move(plan), false, nullptr, nullptr, nullptr, std::stoi(backend));
+
+        if (plan.threads.backends == 0)
+            return run_app(std::move(plan), !from_plan, get_option(argc, argv, "--dump-coeffs"), get_option(argc, argv, "--analyze"),
+                get_option(argc, argv, "--handoff"), -1);
+
+        #ifdef _WIN32
+            throw std::runtime_error("backends need shared memory and fork, which this host lacks!");
+        #else
+            inspect_routes(plan, !from_plan, get_option(argc, argv, "--dump-coeffs"), get_option(argc, argv, "--analyze"));
+            return run_dispatcher(plan, argc, argv, get_option(argc, argv, "--handoff"));
+        #endif
     } catch (std::exception& err) {
         std::cerr << "ERROR: " << err.what() << std::endl; 
         return -1;
@@ -0,0 +1,33 @@
+#include <nfp/Plan.hpp>
+#include <iostream>
+
+int main(int argc, char ** argv) {
+
+    if (argc < 3) {
+        std::cerr << "Usage: nfp-compile config.json output.nfpplan" << std::endl;
+        return -1;
+    }
+
+    try {
+        nfp::Plan plan = nfp::plan_from_config(nfp::load_config_file(argv[1]));
+        nfp::validate_route_table(plan.routes, plan.analysis, plan.conn.samp_freq);
+        nfp::save_plan(plan, argv[2]);
+
+        for (uint16_t r = 0; r < plan.routes.size(); ++r) {
+            const auto& route = plan.routes.at(r);
+            std::cout << "Route " << route.name << ": ";
+
+            if (route.graph)
+                std::cout << route.graph->n_chains() << " chains, " << route.graph->n_outputs() << " outputs" << std::endl;
+            else
+                std::cout << route.pipeline.coeffs().size() / 6 << " sections" << std::endl;
+        }
+
+        std::cout << "Plan written to " << argv[2] << std::endl;
+    } catch (std::exception& err) {
+        std::cerr << "ERROR: " << err.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <nfp/ConfigsParse.hpp>
+#include <nfp/FilterAnalysis.hpp>
+#include <pybind11/pybind11.h>
+#include <pybind11/complex.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace py = pybind11;
+
+namespace {
+
+    // One connection's pipeline, as the server builds it from the config, with its filter state.
+    struct Pipeline {
+        nfp::SignalPipeline pipeline;
+        float fs;
+    };
+
+    json config_from(const py::object& config) {
+        if (py::isinstance<py::dict>(config))
+            return json::parse(py::module_::import("json").attr("dumps")(config).cast<std::string>());
+
+        return nfp::load_config_file(py::module_::import("os").attr("fspath")(config).cast<std::string>());
+    }
+
+    Pipeline build_pipeline(const py::object& config, const std::string& name) {
+        const json j = config_from(config);
+        const float fs = nfp::parse_conn_from(j).samp_freq;
+
+        if (name == "default")
+            return Pipeline {nfp::build_pipeline(nfp::parse_pipeline_from(j), fs), fs};
+
+        const auto named = nfp::parse_named_pipelines_from(j);
+        auto it = named.find(name);
+
+        if (it == named.end())
+            throw std::runtime_error("There is no pipeline named " + name + "!");
+
+        return Pipeline {nfp::build_pipeline(it->second, fs), fs};
+    }
+
+    template <class T>
+    py::array_t<T> to_array(const std::vector<T>& v) {
+        return py::array_t<T>(static_cast<py::ssize_t>(v.size()), v.data());
+    }
+
+}
+
+PYBIND11_MODULE(nfp, m) {
+    m.doc() = "The net-filter-pipeline DSP engine: pipelines built from the server's config, run in place on numpy arrays.";
+
+    py::class_<Pipeline>(m, "Pipeline")
+        .def_readonly("samp_freq", &Pipeline::fs)
+        .def("process", [](Pipeline& self, py::array_t<float, py::array::c_style> x) {
+            float * data = x.mutable_data();
+            const size_t n = static_cast<size_t>(x.size());
+            {
+                py::gil_scoped_release release;
+                self.pipeline.processBlock(data, data, n);
+            }
+            return x;
+        }, py::arg("x").noconvert(),
+        "Filters a C-contiguous float32 array in place, carrying the filter state over from the previous call.\n"
+        "The GIL is released meanwhile; one Pipeline must not be processed from two threads at once.")
+        .def("reset", [](Pipeline& self) { self.pipeline.reset(); }, "Clears the filter state.")
+        .def("coeffs", [](const Pipeline& self) {
+            const auto cs = self.pipeline.coeffs();
+            py::array_t<float> out({static_cast<py::ssize_t>(cs.size() / 6), static_cast<py::ssize_t>(6)});
+            std::copy(cs.begin(), cs.end(), out.mutable_data());
+            return out;
+        }, "Biquad sections as rows of (a0, a1, a2, b0, b1, b2), as written by --dump-coeffs.")
+        .def("response", [](const Pipeline& self, size_t n_points) {
+            const auto r = nfp::FilterAnalysis {self.pipeline.coeffs(), self.fs}.response(n_points);
+            py::dict out;
+            out["freqs"] = to_array(r.freqs);
+            out["magnitude_db"] = to_array(r.magnitude_db);
+            out["phase"] = to_array(r.phase);
+            out["group_delay"] = to_array(r.group_delay);
+            return out;
+        }, py::arg("n_points") = 1024, "Frequency response from 0 to samp_freq / 2, as in --analyze.")
+        .def("stability", [](const Pipeline& self, size_t n_points) {
+            const auto r = nfp::FilterAnalysis {self.pipeline.coeffs(), self.fs}.stability(n_points);
+            py::list sections;
+
+            for (const auto& s : r.sections) {
+                py::dict section;
+                section["poles"] = s.poles;
+                section["zeros"] = s.zeros;
+                section["pole_radius"] = s.pole_radius;
+                section["peak_gain_db"] = s.peak_gain_db;
+                section["state_peak_gain_db"] = s.state_peak_gain_db;
+                sections.append(section);
+            }
+
+            py::dict out;
+            out["stable"] = r.stable;
+            out["max_pole_radius"] = r.max_pole_radius;
+            out["stability_margin"] = r.stability_margin;
+            out["peak_gain_db"] = r.peak_gain_db;
+            out["peak_freq"] = r.peak_freq;
+            out["sections"] = sections;
+            return out;
+        }, py::arg("n_points") = 4096, "Poles, zeros and peak gains of each section, as checked by the analysis block.");
+
+    m.def("build_pipeline", &build_pipeline, py::arg("config"), py::arg("pipeline") = "default",
+        "Builds a pipeline from a config file path or a dict with the same JSON: the top-level pipeline, or one of pipelines by name.");
+}
@@ -0,0 +1,73 @@
+#include <nfp/Spectrum.hpp>
+#include <complex>
+#include <cstring>
+#include <iostream>
+#include <math.h>
+#include <vector>
+
+using namespace std;
+using namespace nfp;
+
+const float PI = 3.14159265f;
+
+int main(int argc, char ** argv) {
+    float fs = 8000.0f;
+    size_t n = 256;
+    int failures = 0;
+
+    vector<float> x(n);
+    for (size_t i = 0; i < n; i++)
+        x[i] = sin(2 * PI * 1000 * i / fs) + 0.25f * cos(2 * PI * 2500 * i / fs) + 0.1f * ((i * 7919) % 13 - 6.0f) / 6.0f;
+
+    RealFFT fft {n};
+    vector<complex<float>> bins(n / 2 + 1), work(n / 2);
+    fft.forward(x.data(), bins.data(), work.data());
+
+    double max_err = 0;
+    for (size_t k = 0; k <= n / 2; k++) {
+        complex<double> ref = 0;
+        for (size_t i = 0; i < n; i++)
+            ref += double(x[i]) * exp(complex<double>(0, -2 * M_PI * k * i / n));
+        max_err = max(max_err, abs(ref - complex<double>(bins[k])));
+    }
+
+    failures += max_err > 1e-3;
+
+    SpectrumConfig cfg;
+    cfg.fft_size = n;
+    cfg.hop = 64;
+    cfg.output = SpectrumOutput::BANDS;
+    cfg.bands = {{0, 500}, {750, 1250}, {2250, 2750}, {3000, 4000}};
+    cfg.fs = fs;
+
+    SpectrumAnalyzer analyzer {cfg};
+    vector<uint8_t> frames;
+    vector<float> block(128);
+
+    for (int b = 0; b < 8; b++) {
+        for (size_t i = 0; i < block.size(); i++) {
+            size_t t = b * block.size() + i;
+            block[i] = sin(2 * PI * 1000 * t / fs) + 0.5f * sin(2 * PI * 2500 * t / fs);
+        }
+        analyzer.push(block.data(), block.size(), frames);
+    }
+
+    size_t n_frames = frames.size() / analyzer.frame_bytes();
+    FeatureFrameHeader header;
+    memcpy(&header, frames.data() + (n_frames - 1) * analyzer.frame_bytes(), sizeof(header));
+
+    vector<float> energy(header.n_features);
+    memcpy(energy.data(), frames.data() + (n_frames - 1) * analyzer.frame_bytes() + sizeof(header), energy.size() * sizeof(float));
+
+    cout << "FFT max error vs DFT: " << max_err << endl;
+    cout << "frames: " << n_frames << ", last frame " << header.frame << ", " << analyzer.frame_bytes() << " bytes each" << endl;
+    for (size_t b = 0; b < energy.size(); b++)
+        cout << "band " << b << ": " << energy[b] << endl;
+
+    // (1024 - 256) / 64 + 1 frames; a sine of amplitude A carries A^2 / 2 of mean-square power.
+    failures += n_frames != 13 || header.frame != 12;
+    failures += fabs(energy[1] - 0.5f) > 0.02f || fabs(energy[2] - 0.125f) > 0.01f;
+    failures += energy[0] > 1e-3f || energy[3] > 1e-3f;
+
+    return failures;
+}
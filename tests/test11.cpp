@@ -0,0 +1,107 @@
+#include <nfp/PipelineGraph.hpp>
+#include <nfp/SignalPipeline.hpp>
+#include <nfp/DigitalFilter.hpp>
+#include <iostream>
+#include <math.h>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace nfp;
+
+const float PI = 3.14159265f;
+
+SignalPipeline low_pass(float wc) {
+    SignalPipeline p;
+    p.add_digital_filter(DigitalFilter::low_pass_filter(wc, 4));
+    return p;
+}
+
+SignalPipeline high_pass(float wc) {
+    SignalPipeline p;
+    p.add_digital_filter(DigitalFilter::high_pass_filter(wc, 4));
+    return p;
+}
+
+SignalPipeline gain(float g) {
+    SignalPipeline p;
+    p.add_gain(g);
+    return p;
+}
+
+int main(int argc, char ** argv) {
+    float fs = 8000.0f, wc = 2 * PI * 1000 / fs;
+    int failures = 0;
+
+    // in -> low -> half -> sum, in -> high -> sum; half is undone by the mix weight.
+    PipelineGraph graph;
+    graph.add_chain("low", "in", low_pass(wc));
+    graph.add_chain("high", "in", high_pass(wc));
+    graph.add_chain("half", "low", gain(0.5f));
+    graph.add_chain("unused", "in", gain(3.0f));
+    graph.add_mix("sum", {"half", "high"}, {2.0f, 1.0f});
+    graph.add_output("sum");
+    graph.add_output("high");
+    graph.compile(true);
+
+    // Runs branches in reverse to show that the order inside a level doesn't matter.
+    PipelineGraph::ParallelFor reverse = [](size_t n, const function<void(size_t)>& fn) {
+        for (size_t i = n; i-- > 0; )
+            fn(i);
+    };
+
+    SignalPipeline low_ref = low_pass(wc), high_ref = high_pass(wc);
+    PipelineGraph copy = graph.clone();
+
+    vector<float> x(128), y_low, y_high;
+    double err_sum = 0, err_high = 0, err_copy = 0;
+
+    for (int b = 0; b < 16; b++) {
+        for (size_t i = 0; i < x.size(); i++) {
+            size_t t = b * x.size() + i;
+            x[i] = sin(2 * PI * 300 * t / fs) + 0.5f * sin(2 * PI * 2500 * t / fs);
+        }
+
+        graph.processBlock(x.data(), x.size(), &reverse);
+        low_ref.processBlock(x, y_low);
+        high_ref.processBlock(x, y_high);
+
+        for (size_t i = 0; i < x.size(); i++) {
+            err_sum = max(err_sum, (double) fabs(graph.output(0)[i] - (y_low[i] + y_high[i])));
+            err_high = max(err_high, (double) fabs(graph.output(1)[i] - y_high[i]));
+        }
+    }
+
+    // The clone shares the plan, not the state: it starts from rest.
+    vector<float> impulse(128, 0.0f);
+    impulse[0] = 1.0f;
+    copy.processBlock(impulse.data(), impulse.size());
+
+    SignalPipeline high_rest = high_pass(wc);
+    vector<float> y_rest;
+    high_rest.processBlock(impulse, y_rest);
+
+    for (size_t i = 0; i < impulse.size(); i++)
+        err_copy = max(err_copy, (double) fabs(copy.output(1)[i] - y_rest[i]));
+
+    bool cycle_caught = false;
+    try {
+        PipelineGraph cyclic;
+        cyclic.add_chain("a", "b", gain(1.0f));
+        cyclic.add_chain("b", "a", gain(1.0f));
+        cyclic.add_output("b");
+        cyclic.compile();
+    } catch (const std::runtime_error&) {
+        cycle_caught = true;
+    }
+
+    cout << "chains: " << graph.n_chains() << ", blocks: " << graph.n_buffers() << ", footprint: " << graph.footprint() << " bytes" << endl;
+    cout << "sum error: " << err_sum << ", high error: " << err_high << ", clone error: " << err_copy << endl;
+
+    // unused is pruned; in, low, high, half and sum fit in three blocks.
+    failures += graph.n_chains() != 3 || graph.n_buffers() != 3;
+    failures += err_sum > 1e-5 || err_high > 1e-6 || err_copy > 1e-6;
+    failures += !cycle_caught;
+
+    return failures;
+}
@@ -0,0 +1,94 @@
+#include <nfp/ConnTable.hpp>
+#include <nfp/RouteTable.hpp>
+#include <nfp/SignalPipeline.hpp>
+#include <nfp/DigitalFilter.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <math.h>
+#include <new>
+#include <vector>
+
+using namespace std;
+using namespace nfp;
+
+const float PI = 3.14159265f;
+
+static atomic<size_t> heap_allocs {0};
+
+void * operator new(size_t n) {
+    ++heap_allocs;
+    if (void * p = malloc(n ? n : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void * operator new(size_t n, align_val_t a) {
+    ++heap_allocs;
+    size_t align = static_cast<size_t>(a);
+    if (void * p = aligned_alloc(align, (n + align - 1) / align * align))
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void * p) noexcept { free(p); }
+void operator delete(void * p, size_t) noexcept { free(p); }
+void operator delete(void * p, align_val_t) noexcept { free(p); }
+void operator delete(void * p, size_t, align_val_t) noexcept { free(p); }
+
+int main(int argc, char ** argv) {
+    float fs = 8000.0f;
+    int failures = 0;
+
+    SignalPipeline pipeline;
+    pipeline.add_digital_filter(DigitalFilter::low_pass_filter(2 * PI * 1000 / fs, 8));
+    pipeline.add_digital_filter(DigitalFilter::notch_filter(2 * PI * 50 / fs, 1));
+    pipeline.add_gain(0.5f);
+
+    RouteTable routes;
+    routes.add_route("default", pipeline.clone(), CONCEALMENT::ALL_ZERO);
+    const Route & route = routes.at(0);
+
+    ConnTable table {8};
+    table.set_arena_bytes(route.arena_bytes());
+
+    // Warm up: the slab chunk and the hash table reach their steady size.
+    vector<float> x(128), y(128), ref;
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = sin(2 * PI * 440 * i / fs);
+
+    auto churn = [&](uint64_t first, size_t n) {
+        for (uint64_t k = first; k < first + n; k++) {
+            bool inserted;
+            ConnState & conn = table.find_or_insert(k, inserted);
+            conn.cold->pipeline.emplace(route.pipeline.clone(&conn.cold->arena));
+            conn.cold->pipeline->processBlock(x.data(), y.data(), y.size());
+        }
+
+        for (uint64_t k = first; k < first + n; k++)
+            table.erase(k);
+    };
+
+    churn(0, 32);
+
+    const size_t before = heap_allocs.load();
+    churn(1000, 32);
+    churn(5000, 32);
+    const size_t during = heap_allocs.load() - before;
+
+    SignalPipeline plain = pipeline.clone();
+    plain.processBlock(x, ref);
+
+    double err = 0;
+    for (size_t i = 0; i < y.size(); i++)
+        err = max(err, (double) fabs(y[i] - ref[i]));
+
+    cout << "arena bytes: " << route.arena_bytes() << ", cold slot: " << table.cold_bytes_per_connection() << endl;
+    cout << "heap allocations over 64 connections: " << during << endl;
+    cout << "max error vs heap clone: " << err << endl;
+
+    failures += during != 0;
+    failures += err > 0;
+
+    return failures;
+}
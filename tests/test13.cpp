@@ -0,0 +1,147 @@
+#include <nfp/Plan.hpp>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <math.h>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace nfp;
+
+const float PI = 3.14159265f;
+
+double max_error(const vector<float>& a, const vector<float>& b) {
+    double err = a.size() == b.size() ? 0 : 1;
+    for (size_t i = 0; i < min(a.size(), b.size()); i++)
+        err = max(err, (double) fabs(a[i] - b[i]));
+    return err;
+}
+
+uint64_t fnv1a(const string& s, size_t from) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = from; i < s.size(); i++)
+        h = (h ^ static_cast<unsigned char>(s[i])) * 1099511628211ull;
+    return h;
+}
+
+bool rejected(const string& path) {
+    try {
+        load_plan(path);
+    } catch (const std::runtime_error& err) {
+        cout << "rejected: " << err.what() << endl;
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char ** argv) {
+    float fs = 8000.0f;
+    int failures = 0;
+
+    json j = json::parse(R"({
+        "udp-parms": {"server-port": 55555, "samp-freq": 8000, "client-addrv4": "127.0.0.1", "concealment-policy": "FADE_LAST_GOOD"},
+        "pipeline": [{"type": "low-pass", "cut-freq": 1000, "order": 4}, {"type": "gain", "gain": 0.5}, {"type": "notch", "cut-freq": 50, "BW": 1}],
+        "pipelines": {"hp": [{"type": "high-pass", "cut-freq": 200, "order": 4}]},
+        "graphs": {
+            "split": {
+                "nodes": [
+                    {"name": "low", "input": "in", "pipeline": [{"type": "low-pass", "cut-freq": 200, "order": 4}]},
+                    {"name": "high", "input": "in", "pipeline": "hp"},
+                    {"name": "sum", "mix": ["low", "high"], "weights": [1, 0.5]}
+                ],
+                "outputs": ["sum", "low"],
+                "parallel": true
+            }
+        },
+        "routes": [
+            {"src-addrv4": "10.0.1.0/24", "pipeline": "hp", "concealment-policy": "ALL_ZERO"},
+            {"out-ports": [60000, 60100], "pipeline": "split"}
+        ],
+        "threads": {"workers": 3, "worker-cpus": [1, 2], "backends": 4, "ring-capacity": 1024}
+    })");
+
+    Plan plan = plan_from_config(j);
+    const string path = "test13.nfpplan";
+    save_plan(plan, path);
+    Plan loaded = load_plan(path);
+
+    failures += loaded.routes.size() != plan.routes.size();
+    failures += loaded.conn.server_port != 55555 || loaded.conn.client_addrv4 != "127.0.0.1";
+    failures += loaded.threads.workers != 3 || loaded.threads.worker_cpus != vector<int>{1, 2};
+    failures += loaded.threads.backends != 4 || loaded.threads.ring_capacity != 1024;
+
+    for (uint32_t src : {0x0A000105u, 0x0B000001u})
+        for (uint16_t port : {5000, 60050})
+            failures += loaded.routes.lookup(src, 1234, port) != plan.routes.lookup(src, 1234, port);
+
+    vector<float> x(128), y, y_ref;
+    double err = 0;
+
+    for (uint16_t r = 0; r < plan.routes.size(); ++r) {
+        const Route & a = plan.routes.at(r);
+        const Route & b = loaded.routes.at(r);
+        failures += a.name != b.name || a.policy != b.policy || !a.graph != !b.graph;
+
+        if (!a.graph) {
+            SignalPipeline pa = a.pipeline.clone(), pb = b.pipeline.clone();
+            for (int blk = 0; blk < 8; blk++) {
+                for (size_t i = 0; i < x.size(); i++)
+                    x[i] = sin(2 * PI * 440 * (blk * x.size() + i) / fs);
+                pa.processBlock(x, y_ref);
+                pb.processBlock(x, y);
+                err = max(err, max_error(y, y_ref));
+            }
+            continue;
+        }
+
+        PipelineGraph ga = a.graph->clone(), gb = b.graph->clone();
+        failures += ga.n_buffers() != gb.n_buffers() || ga.n_outputs() != gb.n_outputs();
+
+        for (int blk = 0; blk < 8; blk++) {
+            for (size_t i = 0; i < x.size(); i++)
+                x[i] = sin(2 * PI * 150 * (blk * x.size() + i) / fs) + sin(2 * PI * 900 * (blk * x.size() + i) / fs);
+            ga.processBlock(x.data(), x.size());
+            gb.processBlock(x.data(), x.size());
+            for (size_t o = 0; o < ga.n_outputs(); o++)
+                for (size_t i = 0; i < x.size(); i++)
+                    err = max(err, (double) fabs(ga.output(o)[i] - gb.output(o)[i]));
+        }
+    }
+
+    cout << "routes: " << loaded.routes.size() << ", max error vs JSON build: " << err << endl;
+    failures += err > 0;
+
+    // One flipped payload byte, then a cut file.
+    string bytes;
+    {
+        ifstream in {path, ios::binary};
+        bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+
+    {
+        string bad = bytes;
+        bad[bad.size() / 2] ^= 0x40;
+        ofstream {path, ios::binary | ios::trunc}.write(bad.data(), bad.size());
+    }
+    failures += !rejected(path);
+
+    ofstream {path, ios::binary | ios::trunc}.write(bytes.data(), bytes.size() - 7);
+    failures += !rejected(path);
+
+    // A concealment policy this build doesn't have, under a valid checksum: the payload opens
+    // with the sample rate, the port and the client address.
+    {
+        string bad = bytes;
+        bad[sizeof(PlanHeader) + 4 + 2 + 4 + loaded.conn.client_addrv4.size()] = 9;
+        const uint64_t checksum = fnv1a(bad, sizeof(PlanHeader));
+        bad.replace(offsetof(PlanHeader, checksum), sizeof(checksum), reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+        ofstream {path, ios::binary | ios::trunc}.write(bad.data(), bad.size());
+    }
+    failures += !rejected(path);
+
+    remove(path.c_str());
+
+    return failures;
+}
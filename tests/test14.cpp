@@ -0,0 +1,159 @@
+#include <nfp/IngressQueue.hpp>
+#include <nfp/UDPInterface.hpp>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+using nfp::IngressQueue;
+using nfp::OVERLOAD;
+using nfp::SignalPipeline;
+using nfp::DigitalFilter;
+
+const float PI = 3.14159265f;
+
+using Packet = pair<uint64_t, int>;
+using Queue = IngressQueue<Packet>;
+
+vector<Packet> drain(Queue & q) {
+    vector<Packet> out;
+    Packet p;
+    while (q.pop(p))
+        out.push_back(p);
+    return out;
+}
+
+// Every connection's sequence numbers must leave in increasing order.
+bool in_order(const vector<Packet> & out) {
+    for (size_t i = 0; i < out.size(); i++)
+        for (size_t k = i + 1; k < out.size(); k++)
+            if (out[i].first == out[k].first && out[i].second > out[k].second)
+                return false;
+    return true;
+}
+
+// The worker filters a pipeline slow enough to hold its shard for most of the run while one
+// connection keeps sending; returns the longest enqueue over the time one block takes to filter.
+double receiver_stall() {
+    size_t n_filters = 64;
+    double filter_ms = 0;
+    auto slow = [&n_filters]() {
+        SignalPipeline p;
+        for (size_t i = 0; i < n_filters; i++)
+            p.add_digital_filter(DigitalFilter::low_pass_filter(2 * PI * 0.1f, 8));
+        return p;
+    };
+
+    for (vector<float> x(128, 0.5f); filter_ms < 10; n_filters *= 2) {
+        SignalPipeline p = slow();
+        auto start = steady_clock::now();
+        p.processBlock(x.data(), x.data(), x.size());
+        filter_ms = duration<double, milli>(steady_clock::now() - start).count();
+    }
+    n_filters /= 2;
+
+    boost::asio::thread_pool pool {1};
+    nfp::UDPWorker worker {pool, 1};
+    worker.set_manual_clock(steady_clock::now());
+    worker.set_pipeline_factory(slow);
+    worker.set_warm_up(1);
+    worker.set_ingress(4, OVERLOAD::ESTABLISHED_FIRST, false);
+
+    udp::endpoint src {boost::asio::ip::make_address_v4("10.0.0.1"), 4000};
+    nfp::Datagram pkg {};
+    double longest = 0;
+
+    for (uint64_t seq = 0; seq < 40; seq++) {
+        pkg.seq = seq;
+        auto start = steady_clock::now();
+        worker.enqueue(pkg, src, false, [] {});
+        longest = max(longest, duration<double, milli>(steady_clock::now() - start).count());
+        this_thread::sleep_for(duration<double, milli>(filter_ms / 4));
+    }
+
+    worker.stop();
+    pool.join();
+    return longest / filter_ms;
+}
+
+int main(int argc, char ** argv) {
+    int failures = 0;
+    auto none = [](uint64_t) { return false; };
+
+    // Connections 1 and 2 fill the queue, then connection 1 keeps sending.
+    auto fill = [](Queue & q, OVERLOAD policy, auto && established) {
+        int seq[3] = {0, 0, 0};
+        for (int i = 0; i < 8; i++) {
+            uint64_t c = 1 + i % 2;
+            q.push(c, {c, seq[c]++}, policy, established(c));
+        }
+
+        vector<Queue::Admit> admits;
+        for (int i = 0; i < 3; i++)
+            admits.push_back(q.push(1, {1, seq[1]++}, policy, established(1)));
+        return admits;
+    };
+
+    Queue newest {8};
+    auto admits = fill(newest, OVERLOAD::DROP_NEWEST, none);
+    auto out = drain(newest);
+    failures += admits != vector<Queue::Admit>(3, Queue::Admit::DROPPED);
+    failures += out.size() != 8 || out.back() != Packet{2, 3};
+
+    Queue oldest {8};
+    admits = fill(oldest, OVERLOAD::DROP_OLDEST, none);
+    out = drain(oldest);
+    failures += admits != vector<Queue::Admit>(3, Queue::Admit::REPLACED);
+    failures += out.size() != 8 || !in_order(out);
+    // Connection 1 keeps its newest four packets, connection 2 loses nothing.
+    set<int> c1, c2;
+    for (auto & p : out)
+        (p.first == 1 ? c1 : c2).insert(p.second);
+    failures += c1 != set<int>{3, 4, 5, 6} || c2 != set<int>{0, 1, 2, 3};
+
+    // Connection 1 is established, 2 is new: 2's newest packets make room for 1.
+    Queue established {8};
+    admits = fill(established, OVERLOAD::ESTABLISHED_FIRST, [](uint64_t c) { return c == 1; });
+    out = drain(established);
+    failures += admits != vector<Queue::Admit>(3, Queue::Admit::REPLACED);
+    failures += out.size() != 8 || !in_order(out);
+    c1.clear(); c2.clear();
+    for (auto & p : out)
+        (p.first == 1 ? c1 : c2).insert(p.second);
+    failures += c1 != set<int>{0, 1, 2, 3, 4, 5, 6} || c2 != set<int>{0};
+
+    // A new connection never evicts anything.
+    Queue closed {2};
+    closed.push(1, {1, 0}, OVERLOAD::ESTABLISHED_FIRST);
+    closed.push(1, {1, 1}, OVERLOAD::ESTABLISHED_FIRST);
+    failures += closed.push(2, {2, 0}, OVERLOAD::ESTABLISHED_FIRST) != Queue::Admit::DROPPED;
+
+    // Packets queued while their connection was new stay evictable after it is established.
+    Queue opening {2};
+    opening.push(1, {1, 0}, OVERLOAD::ESTABLISHED_FIRST, false);
+    opening.push(1, {1, 1}, OVERLOAD::ESTABLISHED_FIRST, true);
+    failures += opening.push(2, {2, 0}, OVERLOAD::ESTABLISHED_FIRST, true) != Queue::Admit::REPLACED;
+    out = drain(opening);
+    failures += out != vector<Packet>{{2, 0}, {1, 1}};
+
+    // The receiver reads the table's hint of live keys without its lock.
+    nfp::ConnTable table {4};
+    bool inserted;
+    failures += table.may_contain(7);
+    table.find_or_insert(7, inserted);
+    failures += !table.may_contain(7);
+    table.erase(7);
+    failures += table.may_contain(7);
+
+    const double stall = receiver_stall();
+    failures += stall > 0.25;
+    cout << "longest enqueue behind a busy worker: " << stall << " blocks" << endl;
+
+    cout << "failures: " << failures << endl;
+
+    return failures;
+}
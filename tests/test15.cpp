@@ -0,0 +1,74 @@
+#include <nfp/UDPInterface.hpp>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using boost::asio::ip::udp;
+using nfp::Sink;
+using nfp::UDPClient;
+
+int main(int argc, char ** argv) {
+    boost::asio::io_context io;
+    auto localhost = boost::asio::ip::make_address_v4("127.0.0.1");
+    int failures = 0;
+
+    vector<unique_ptr<udp::socket>> consumers;
+    for (int i = 0; i < 3; i++)
+        consumers.push_back(make_unique<udp::socket>(io, udp::endpoint(localhost, 0)));
+
+    // Two fixed ports and one that follows the datagram's out-port.
+    vector<Sink> sinks = {
+        Sink{localhost.to_uint(), consumers[0]->local_endpoint().port()},
+        Sink{localhost.to_uint(), consumers[1]->local_endpoint().port()},
+        Sink{localhost.to_uint(), 0}
+    };
+    const uint16_t follow_port = consumers[2]->local_endpoint().port();
+
+    UDPClient client {io, localhost};
+    client.add_sinks(sinks);
+
+    vector<float> block(128);
+    for (size_t i = 0; i < block.size(); i++)
+        block[i] = static_cast<float>(i);
+
+    client.send(boost::asio::buffer(block), follow_port, 0, sinks);
+
+    // The caller drops its reference at once; pending sends keep the buffer.
+    for (int k = 0; k < 50; k++) {
+        auto data = make_shared<const vector<float>>(block);
+        client.async_send(data, boost::asio::buffer(*data), follow_port, 0, sinks);
+    }
+    io.poll();
+
+    vector<float> rx(256);
+    for (size_t c = 0; c < consumers.size(); c++) {
+        size_t got = 0;
+        double err = 0;
+        auto deadline = chrono::steady_clock::now() + chrono::seconds(2);
+
+        while (got < 51 && chrono::steady_clock::now() < deadline) {
+            if (consumers[c]->available() == 0) {
+                this_thread::sleep_for(chrono::milliseconds(1));
+                io.poll();
+                continue;
+            }
+
+            size_t n = consumers[c]->receive(boost::asio::buffer(rx));
+            err += n != block.size() * sizeof(float);
+            for (size_t i = 0; i < block.size(); i++)
+                err += rx[i] != block[i];
+            got++;
+        }
+
+        cout << "sink " << c << ": " << got << " blocks, " << err << " mismatches" << endl;
+        failures += got != 51 || err != 0;
+    }
+
+    client.close();
+
+    return failures;
+}
@@ -0,0 +1,161 @@
+#include <boost/asio.hpp>
+#include <nfp/SignalPipeline.hpp>
+#include <nfp/UDPInterface.hpp>
+#include <nfp/DigitalFilter.hpp>
+#include <nfp/Kernels.hpp>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using boost::asio::ip::udp;
+using nfp::Datagram;
+using nfp::DigitalFilter;
+using nfp::SignalPipeline;
+using nfp::UDPClient;
+using nfp::UDPServer;
+using nfp::UDPWorker;
+
+const float PI = 3.14159265f;
+const size_t PACKETS = 20000;
+const size_t WINDOW = 8;
+
+struct Result {
+    size_t received = 0;
+    double cpu_us = 0;
+    double p50_us = 0;
+    double p99_us = 0;
+};
+
+// Streams PACKETS datagrams through the server on one connection with WINDOW in flight and times
+// each one from send to the matching output.
+Result run(bool coroutine, uint16_t port) {
+    boost::asio::io_context server_io;
+    auto guard = boost::asio::make_work_guard(server_io);
+    auto localhost = boost::asio::ip::make_address_v4("127.0.0.1");
+
+    udp::socket sink {server_io, udp::endpoint(localhost, 0)};
+    udp::socket source {server_io, udp::endpoint(localhost, 0)};
+    const uint16_t sink_port = sink.local_endpoint().port();
+
+    boost::asio::thread_pool workers {coroutine ? 1u : 2u};
+    boost::asio::io_context client_io;
+    auto client_guard = boost::asio::make_work_guard(client_io);
+
+    auto worker = make_shared<UDPWorker>(workers, 1);
+    worker->set_pipeline_factory([]() {
+        SignalPipeline p;
+        p.add_digital_filter(DigitalFilter::low_pass_filter(2 * PI * 1000 / 8000, 8));
+        return p;
+    });
+
+    auto server = make_shared<UDPServer>(server_io, port);
+    server->set_worker(worker);
+
+    if (coroutine) {
+        #ifdef NFP_COROUTINES
+            server->start_coroutine(make_shared<UDPClient>(server_io, localhost));
+        #endif
+    } else {
+        worker->add_client(make_unique<UDPClient>(client_io, localhost));
+        server->start();
+    }
+
+    thread server_thread([&]() { server_io.run(); });
+    thread client_thread([&]() { client_io.run(); });
+
+    Datagram pkg {};
+    pkg.out_port = sink_port;
+    for (size_t i = 0; i < 128; i++)
+        pkg.data[i] = sin(2 * PI * 440 * i / 8000);
+
+    const udp::endpoint server_ep {localhost, port};
+    vector<float> rx(128);
+    sink.non_blocking(false);
+
+    // The first blocks of a connection fill its jitter buffer and leave before out_port is known.
+    for (uint64_t seq = 0; seq < 8; seq++) {
+        pkg.seq = seq;
+        source.send_to(boost::asio::buffer(&pkg, sizeof(pkg)), server_ep);
+    }
+    this_thread::sleep_for(chrono::milliseconds(100));
+    while (sink.available())
+        sink.receive(boost::asio::buffer(rx));
+
+    vector<chrono::steady_clock::time_point> sent(PACKETS);
+    vector<double> latency;
+    latency.reserve(PACKETS);
+
+    timeval tv {1, 0};
+    setsockopt(sink.native_handle(), SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    const clock_t cpu0 = clock();
+    size_t next = 0, received = 0;
+
+    while (received < PACKETS) {
+        while (next < PACKETS && next < received + WINDOW) {
+            pkg.seq = 8 + next;
+            sent[next] = chrono::steady_clock::now();
+            source.send_to(boost::asio::buffer(&pkg, sizeof(pkg)), server_ep);
+            next++;
+        }
+
+        boost::system::error_code ec;
+        sink.receive(boost::asio::buffer(rx), 0, ec);
+        if (ec)
+            break;
+
+        latency.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - sent[received]).count());
+        received++;
+    }
+
+    const clock_t cpu1 = clock();
+
+    server->finish();
+    guard.reset();
+    client_guard.reset();
+    server_io.stop();
+    client_io.stop();
+    server_thread.join();
+    client_thread.join();
+    workers.join();
+
+    Result r;
+    r.received = received;
+    r.cpu_us = 1e6 * (cpu1 - cpu0) / CLOCKS_PER_SEC / max<size_t>(received, 1);
+
+    if (!latency.empty()) {
+        sort(latency.begin(), latency.end());
+        r.p50_us = latency[latency.size() / 2];
+        r.p99_us = latency[latency.size() * 99 / 100];
+    }
+
+    return r;
+}
+
+int main(int argc, char ** argv) {
+    int failures = 0;
+    cout << "DSP kernels: " << nfp::isa_name(nfp::kernels().isa) << endl;
+
+    vector<pair<string, bool>> modes = {{"callback", false}};
+    #ifdef NFP_COROUTINES
+        modes.push_back({"coroutine", true});
+    #else
+        cout << "coroutine path not built (configure with -DNFP_COROUTINES=ON)" << endl;
+    #endif
+
+    uint16_t port = 56100;
+    for (const auto & [name, coroutine] : modes) {
+        Result r = run(coroutine, port++);
+        cout << name << ": " << r.received << " packets, " << r.cpu_us << " us CPU per packet, latency p50 "
+             << r.p50_us << " us, p99 " << r.p99_us << " us" << endl;
+        failures += r.received != PACKETS;
+    }
+
+    return failures;
+}
@@ -0,0 +1,140 @@
+#include <nfp/Simulator.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+using nfp::Datagram;
+using nfp::SignalPipeline;
+using nfp::Simulator;
+using nfp::UDPWorker;
+
+namespace sim = nfp::sim;
+
+// Each block carries its seq in every sample; the pipeline passes it through, so an output block
+// names the packet it came from (-1 for the zeros sent while the jitter buffer fills; seq 0 never
+// leaves it).
+struct Trace {
+    vector<float> blocks;
+    vector<Simulator::Duration> at;
+    uint64_t hash = 1469598103934665603ull;
+};
+
+Trace run_scenario(vector<uint64_t> seqs, unsigned jitter_depth = 32) {
+    boost::asio::thread_pool pool {1};
+    UDPWorker worker {pool, 1, jitter_depth};
+    worker.set_pipeline_factory([]() { return SignalPipeline(); });
+
+    Simulator simulator {worker};
+    simulator.set_payload([](const udp::endpoint&, uint64_t seq, Datagram& pkg) {
+        fill(pkg.data, pkg.data + 128, static_cast<float>(seq));
+    });
+
+    Trace trace;
+    simulator.on_output([&](const Simulator::Output& out) {
+        const float * x = static_cast<const float *>(out.data.data());
+        trace.blocks.push_back(x[0] == 0.0f ? -1.0f : x[0]);
+        trace.at.push_back(out.at);
+
+        for (size_t i = 0; i < out.data.size(); i++)
+            trace.hash = (trace.hash ^ static_cast<const unsigned char *>(out.data.data())[i]) * 1099511628211ull;
+    });
+
+    udp::endpoint src {boost::asio::ip::make_address_v4("10.0.0.1"), 4000};
+    simulator.stream(src, 7000, std::move(seqs), milliseconds(0), milliseconds(16));
+    simulator.run();
+
+    worker.stop();
+    pool.join();
+    return trace;
+}
+
+size_t count(const vector<float>& v, float x) {
+    size_t n = 0;
+    for (float y : v)
+        n += y == x;
+    return n;
+}
+
+bool nondecreasing(const vector<float>& v) {
+    for (size_t i = 1; i < v.size(); i++)
+        if (v[i] >= 0 && v[i - 1] > v[i])
+            return false;
+    return true;
+}
+
+int main(int argc, char ** argv) {
+    int failures = 0;
+
+    // In order: four zero blocks while the buffer fills, then seq 4 onward.
+    auto clean = run_scenario(sim::sequence(0, 100));
+    failures += clean.blocks.size() != 100 || count(clean.blocks, -1) != 4 || clean.blocks[4] != 4 || clean.blocks.back() != 99;
+    cout << "in order: " << clean.blocks.size() << " blocks" << endl;
+
+    // A burst of three losses is concealed by repeating the last good block; the packets that
+    // waited behind the gap go out with the third concealed block, so the stream doesn't lag.
+    auto burst_seqs = sim::sequence(0, 100);
+    sim::drop(burst_seqs, 50, 3);
+    auto burst = run_scenario(burst_seqs);
+    const size_t caught_up = burst.at.size() == 100 ? std::count(burst.at.begin(), burst.at.end(), burst.at[52]) : 0;
+    failures += burst.blocks.size() != 100 || count(burst.blocks, 49) != 4 || count(burst.blocks, 50) != 0 || !nondecreasing(burst.blocks) || caught_up != 4;
+    cout << "burst loss: " << count(burst.blocks, 49) - 1 << " concealed, " << caught_up << " blocks in the catch-up pass" << endl;
+
+    // A late packet is concealed once and never sent out of order, nor sent at all afterwards.
+    auto reorder_seqs = sim::sequence(0, 100);
+    sim::delay(reorder_seqs, 60, 2);
+    auto reorder = run_scenario(reorder_seqs);
+    failures += reorder.blocks.size() != 100 || count(reorder.blocks, 59) != 2 || !nondecreasing(reorder.blocks);
+    cout << "reorder: " << reorder.blocks.size() << " blocks, in order " << nondecreasing(reorder.blocks) << endl;
+
+    // A jump past 2 * W restarts the buffer: four more zero blocks, then the new seqs.
+    auto jump_seqs = sim::sequence(0, 100);
+    sim::jump(jump_seqs, 70, 1000);
+    auto jump = run_scenario(jump_seqs);
+    failures += count(jump.blocks, -1) != 8 || count(jump.blocks, 1073) != 0 || count(jump.blocks, 1074) != 1 || !nondecreasing(jump.blocks);
+    cout << "seq jump: " << count(jump.blocks, -1) << " zero blocks" << endl;
+
+    // Seeded random loss replays exactly, one block per seq.
+    auto lossy = sim::sequence(0, 2000);
+    sim::drop_random(lossy, 0.05, 7);
+    auto first = run_scenario(lossy), second = run_scenario(lossy);
+    failures += first.hash != second.hash || first.blocks.size() != lossy.back() + 1;
+    cout << "random loss: " << 2000 - lossy.size() << " lost, repeatable " << (first.hash == second.hash) << endl;
+
+    // 100k connections, expired by the reaper once they go quiet.
+    {
+        const size_t CONNS = 100000;
+        boost::asio::thread_pool pool {1};
+        UDPWorker worker {pool, 4, 8};
+        worker.set_pipeline_factory([]() { return SignalPipeline(); });
+
+        Simulator simulator {worker};
+        for (size_t c = 0; c < CONNS; c++) {
+            udp::endpoint src {boost::asio::ip::address_v4(static_cast<uint32_t>(0x0A000000 + c)), 5000};
+            simulator.stream(src, 7000, sim::sequence(0, 6), microseconds(c * 10), milliseconds(20));
+        }
+
+        const auto t0 = steady_clock::now();
+        simulator.run();
+        const double wall = duration<double>(steady_clock::now() - t0).count();
+
+        const size_t alive = worker.size();
+        simulator.run_until(simulator.now() + seconds(11));
+        const size_t after = worker.size();
+
+        const auto & st = simulator.stats();
+        failures += alive != CONNS || after != 0 || st.outputs != st.delivered || st.delivered != CONNS * 6;
+        cout << CONNS << " connections: " << st.delivered << " packets in " << wall << " s ("
+             << duration<double, micro>(st.busy).count() / st.delivered << " us each), "
+             << alive << " alive, " << after << " after timeout" << endl;
+
+        worker.stop();
+        pool.join();
+    }
+
+    cout << "failures: " << failures << endl;
+
+    return failures;
+}
@@ -0,0 +1,215 @@
+#include <nfp/Concealment.hpp>
+#include <nfp/DigitalFilter.hpp>
+#include <nfp/Simulator.hpp>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+using nfp::Concealer;
+using nfp::Datagram;
+using nfp::DigitalFilter;
+using nfp::SignalPipeline;
+using nfp::Simulator;
+using nfp::UDPWorker;
+
+namespace sim = nfp::sim;
+
+const float PI = 3.14159265f;
+const size_t B = Concealer::BLOCK;
+
+// Fundamental and third harmonic with a 37-sample period, so blocks never line up with it.
+float signal(size_t n) {
+    const float phase = 2 * PI * static_cast<float>(n % 37) / 37;
+    return 0.5f * sin(phase) + 0.2f * sin(3 * phase + 0.3f);
+}
+
+float snr_db(const vector<float>& ref, const vector<float>& x) {
+    double s = 0, e = 0;
+    for (size_t i = 0; i < ref.size(); i++) {
+        s += ref[i] * ref[i];
+        e += (ref[i] - x[i]) * (ref[i] - x[i]);
+    }
+    return static_cast<float>(10 * log10(s / max(e, 1e-20)));
+}
+
+// Feeds blocks 0..4, conceals block 5, then receives block 6; returns block 5's SNR and the
+// largest sample step across the 5/6 boundary.
+pair<float, float> lose_one(Concealer::MODEL model) {
+    Concealer c {model};
+    vector<float> block(B);
+
+    for (size_t b = 0; b < 5; b++) {
+        for (size_t i = 0; i < B; i++)
+            block[i] = signal(b * B + i);
+        c.receive(block.data());
+    }
+
+    vector<float> concealed(B), truth(B);
+    c.conceal(concealed.data());
+    for (size_t i = 0; i < B; i++)
+        truth[i] = signal(5 * B + i);
+
+    for (size_t i = 0; i < B; i++)
+        block[i] = signal(6 * B + i);
+    c.receive(block.data());
+
+    float step = fabs(block[0] - concealed[B - 1]);
+    for (size_t i = 1; i < B; i++)
+        step = max(step, fabs(block[i] - block[i - 1]));
+
+    return {snr_db(truth, concealed), step};
+}
+
+int main(int argc, char ** argv) {
+    int failures = 0;
+
+    // Repeating the last good block, the old default, as the baseline.
+    vector<float> repeat(B), truth(B);
+    for (size_t i = 0; i < B; i++) {
+        repeat[i] = signal(4 * B + i);
+        truth[i] = signal(5 * B + i);
+    }
+    const float baseline = snr_db(truth, repeat);
+
+    auto [lpc_snr, lpc_step] = lose_one(Concealer::MODEL::LPC);
+    auto [pitch_snr, pitch_step] = lose_one(Concealer::MODEL::PITCH);
+
+    // A clean signal never steps by more than this.
+    float max_step = 0;
+    for (size_t n = 1; n < 8 * B; n++)
+        max_step = max(max_step, fabs(signal(n) - signal(n - 1)));
+
+    cout << "SNR of one lost block: repeat " << baseline << " dB, LPC " << lpc_snr << " dB, pitch " << pitch_snr << " dB" << endl;
+    cout << "largest step after recovery: LPC " << lpc_step << ", pitch " << pitch_step << " (signal " << max_step << ")" << endl;
+    failures += lpc_snr < 20 || pitch_snr < 20 || lpc_snr < baseline + 10 || pitch_snr < baseline + 10;
+    failures += lpc_step > 1.5f * max_step || pitch_step > 1.5f * max_step;
+
+    // Pitch finds the period, or a multiple of it.
+    {
+        Concealer c {Concealer::MODEL::PITCH};
+        vector<float> block(B), out(B);
+        for (size_t b = 0; b < 5; b++) {
+            for (size_t i = 0; i < B; i++)
+                block[i] = signal(b * B + i);
+            c.receive(block.data());
+        }
+        c.conceal(out.data());
+        failures += c.get_period() == 0 || c.get_period() % 37 != 0;
+        cout << "pitch period: " << c.get_period() << endl;
+    }
+
+    // Long bursts fade out; silence and noise stay finite.
+    for (auto model : {Concealer::MODEL::LPC, Concealer::MODEL::PITCH}) {
+        Concealer c {model};
+        mt19937 rng {3};
+        normal_distribution<float> noise {0.0f, 0.3f};
+        vector<float> block(B);
+
+        for (size_t b = 0; b < 5; b++) {
+            for (auto & x : block)
+                x = noise(rng);
+            c.receive(block.data());
+        }
+
+        float last_peak = 0;
+        bool finite = true;
+        for (int k = 0; k < 6; k++) {
+            c.conceal(block.data());
+            last_peak = 0;
+            for (float x : block) {
+                finite = finite && isfinite(x);
+                last_peak = max(last_peak, fabs(x));
+            }
+        }
+
+        Concealer silent {model};
+        silent.conceal(block.data());
+        for (float x : block)
+            finite = finite && x == 0.0f;
+
+        failures += !finite || last_peak != 0.0f;
+    }
+
+    // A concealed block should cost about what filtering one does.
+    {
+        SignalPipeline pipeline;
+        pipeline.add_digital_filter(DigitalFilter::low_pass_filter(2 * PI * 1000 / 8000, 4));
+        pipeline.add_digital_filter(DigitalFilter::high_pass_filter(2 * PI * 50 / 8000, 2));
+
+        vector<float> block(B);
+        for (size_t i = 0; i < B; i++)
+            block[i] = signal(i);
+
+        const int N = 20000;
+        auto t0 = steady_clock::now();
+        for (int k = 0; k < N; k++)
+            pipeline.processBlock(block.data(), block.data(), B);
+        const double filter_ns = duration<double, nano>(steady_clock::now() - t0).count() / N;
+
+        vector<float> input(64 * B);
+        for (size_t n = 0; n < input.size(); n++)
+            input[n] = signal(n);
+
+        for (auto model : {Concealer::MODEL::LPC, Concealer::MODEL::PITCH}) {
+            Concealer c {model};
+            vector<float> x(B);
+            t0 = steady_clock::now();
+            for (int k = 0; k < N; k++) {
+                copy(input.begin() + (k % 64) * B, input.begin() + (k % 64 + 1) * B, x.begin());
+                c.receive(x.data());
+                c.conceal(x.data());
+            }
+            const double ns = duration<double, nano>(steady_clock::now() - t0).count() / N;
+            cout << (model == Concealer::MODEL::LPC ? "LPC" : "pitch") << ": " << ns
+                 << " ns per lost block incl. refit, filtering " << filter_ns << " ns per block" << endl;
+        }
+    }
+
+    // Through the worker: one packet of warm-up, a lost packet concealed close to the original.
+    for (auto policy : {nfp::CONCEALMENT::LPC_EXTRAPOLATION, nfp::CONCEALMENT::PITCH_REPETITION}) {
+        boost::asio::thread_pool pool {1};
+        UDPWorker worker {pool, 1, 2};
+        worker.set_pipeline_factory([]() { return SignalPipeline(); });
+        worker.set_concealment_policy(policy);
+        worker.set_warm_up(1);
+
+        Simulator simulator {worker};
+        simulator.set_payload([](const udp::endpoint&, uint64_t seq, Datagram& pkg) {
+            for (size_t i = 0; i < B; i++)
+                pkg.data[i] = signal(seq * B + i);
+        });
+
+        vector<vector<float>> out;
+        simulator.on_output([&](const Simulator::Output& o) {
+            const float * x = static_cast<const float *>(o.data.data());
+            out.emplace_back(x, x + B);
+        });
+
+        auto seqs = sim::sequence(100, 20);
+        sim::drop(seqs, 110, 1);
+        simulator.stream(udp::endpoint(boost::asio::ip::make_address_v4("10.0.0.2"), 4000), 7000, seqs, milliseconds(0), milliseconds(16));
+        simulator.run();
+
+        vector<float> expected(B);
+        for (size_t i = 0; i < B; i++)
+            expected[i] = signal(110 * B + i);
+
+        // One block per seq from the first packet on; the loss shows up as the 11th block.
+        const bool immediate = out.size() == 20 && out[0][1] == signal(100 * B + 1);
+        const float snr = out.size() > 10 ? snr_db(expected, out[10]) : 0;
+        failures += !immediate || snr < 20;
+        cout << (policy == nfp::CONCEALMENT::LPC_EXTRAPOLATION ? "worker LPC" : "worker pitch") << ": "
+             << out.size() << " blocks, concealed SNR " << snr << " dB" << endl;
+
+        worker.stop();
+        pool.join();
+    }
+
+    cout << "failures: " << failures << endl;
+
+    return failures;
+}
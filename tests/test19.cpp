@@ -0,0 +1,282 @@
+#include <nfp/Simulator.hpp>
+#include <nfp/Mailbox.hpp>
+#include <nfp/Snapshot.hpp>
+#include <nfp/PipelineGraph.hpp>
+#include <nfp/FixedPoint.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+using nfp::Datagram;
+using nfp::DigitalFilter;
+using nfp::SignalPipeline;
+using nfp::Simulator;
+using nfp::UDPWorker;
+
+namespace sim = nfp::sim;
+
+const float PI = 3.14159265f;
+const auto INTERVAL = milliseconds(16);
+
+SignalPipeline filters() {
+    SignalPipeline p;
+    p.add_digital_filter(DigitalFilter::low_pass_filter(2 * PI * 1000 / 8000, 4));
+    p.add_digital_filter(DigitalFilter::high_pass_filter(2 * PI * 50 / 8000, 2));
+    return p;
+}
+
+float tone(uint64_t n, float f) {
+    return 0.4f * sin(2 * PI * f * static_cast<float>(n % 8000) / 8000) + 0.2f * sin(2 * PI * 3 * f * static_cast<float>(n % 8000) / 8000);
+}
+
+// A worker driven by the simulator, collecting its output blocks.
+struct Run {
+    boost::asio::thread_pool pool {1};
+    UDPWorker worker;
+    Simulator simulator;
+    vector<vector<unsigned char>> out;
+
+    Run(unsigned shards, unsigned depth, function<SignalPipeline()> factory = filters) : worker(pool, shards, depth), simulator(worker) {
+        worker.set_pipeline_factory(factory);
+        worker.set_concealment_policy(nfp::CONCEALMENT::LPC_EXTRAPOLATION);
+        simulator.set_payload([](const udp::endpoint& src, uint64_t seq, Datagram& pkg) {
+            const float f = 100.0f + 37.0f * (src.address().to_v4().to_uint() & 255);
+            for (size_t i = 0; i < 128; i++)
+                pkg.data[i] = tone(seq * 128 + i, f);
+        });
+        simulator.on_output([this](const Simulator::Output& o) {
+            const auto * p = static_cast<const unsigned char *>(o.data.data());
+            out.emplace_back(p, p + o.data.size());
+        });
+    }
+
+    ~Run() {
+        worker.stop();
+        pool.join();
+    }
+};
+
+udp::endpoint source(uint32_t i) {
+    return udp::endpoint(boost::asio::ip::address_v4(0x0A000000 + i), 4000);
+}
+
+// Seqs of connection i with a few losses on both sides of the cut; the k-th is sent at k * INTERVAL.
+vector<uint64_t> seqs_of(uint32_t i) {
+    auto seqs = sim::sequence(100, 80);
+    sim::drop(seqs, 120 + i % 3, 2);
+    sim::drop(seqs, 150 + i % 5, 1);
+    sim::delay(seqs, 60, 2);
+    return seqs;
+}
+
+void stream_range(Run& run, uint32_t conn, size_t from, size_t to) {
+    auto seqs = seqs_of(conn);
+    to = min(to, seqs.size());
+
+    if (from < to)
+        run.simulator.stream(source(conn), 7000, vector<uint64_t>(seqs.begin() + from, seqs.begin() + to),
+            microseconds(conn * 300) + static_cast<int>(from) * INTERVAL, INTERVAL, conn % 2 == 1);
+}
+
+// Saves a filter's state, loads it into a fresh clone and checks both continue identically.
+template<typename F, typename Clone, typename Step>
+bool resumes(F& f, Clone clone, Step step) {
+    vector<unsigned char> state;
+    f.save_state(state);
+
+    auto copy = clone(f);
+    copy.load_state(state.data());
+
+    return state.size() == f.state_bytes() && step(f) == step(copy);
+}
+
+int main(int argc, char ** argv) {
+    int failures = 0;
+
+    // Every stateful block picks up where the original left off.
+    {
+        vector<float> x(128);
+        auto fill_block = [&](uint64_t b) {
+            for (size_t i = 0; i < x.size(); i++)
+                x[i] = tone(b * 128 + i, 440.0f);
+        };
+
+        SignalPipeline pipeline = filters();
+        nfp::SpectrumConfig spectrum;
+        spectrum.fs = 8000.0f;
+        pipeline.set_spectrum(nfp::SpectrumAnalyzer(spectrum));
+        nfp::FixedPointFilter fixed {filters().coeffs()};
+        nfp::PipelineGraph graph;
+        graph.add_chain("low", "in", filters());
+        graph.add_chain("high", "in", [] { SignalPipeline p; p.add_digital_filter(DigitalFilter::high_pass_filter(2 * PI * 0.1f, 4)); return p; }());
+        graph.add_mix("sum", {"low", "high"}, {1.0f, 0.5f});
+        graph.add_output("sum");
+        graph.compile();
+        nfp::Concealer concealer {nfp::Concealer::MODEL::LPC};
+
+        vector<int16_t> q(128), qy(128);
+        vector<float> y(128);
+        vector<uint8_t> frames;
+
+        for (uint64_t b = 0; b < 7; b++) {
+            fill_block(b);
+            pipeline.processBlock(x.data(), y.data(), 128);
+            pipeline.get_spectrum()->push(y.data(), 128, frames);
+            nfp::q15_from_float(x.data(), q.data(), 128);
+            fixed.processBlock(q.data(), qy.data(), 128);
+            graph.processBlock(x.data(), 128);
+            concealer.receive(x.data());
+        }
+        concealer.conceal(y.data());
+        fill_block(7);
+
+        bool ok = resumes(pipeline, [](const SignalPipeline& p) { return p.clone(); }, [&](SignalPipeline& p) {
+            vector<float> out(128);
+            vector<uint8_t> f;
+            p.processBlock(x.data(), out.data(), 128);
+            p.get_spectrum()->push(out.data(), 128, f);
+            return make_pair(out, f);
+        });
+        ok = ok && resumes(fixed, [](const nfp::FixedPointFilter& f) { return f.clone(); }, [&](nfp::FixedPointFilter& f) {
+            vector<int16_t> out(128);
+            nfp::q15_from_float(x.data(), q.data(), 128);
+            f.processBlock(q.data(), out.data(), 128);
+            return out;
+        });
+        ok = ok && resumes(graph, [](const nfp::PipelineGraph& g) { return g.clone(); }, [&](nfp::PipelineGraph& g) {
+            g.processBlock(x.data(), 128);
+            return vector<float>(g.output(0), g.output(0) + 128);
+        });
+        ok = ok && resumes(concealer, [](const nfp::Concealer&) { return nfp::Concealer{nfp::Concealer::MODEL::LPC}; }, [&](nfp::Concealer& c) {
+            vector<float> out(128);
+            c.conceal(out.data());
+            return out;
+        });
+
+        failures += !ok;
+        cout << "filter state round trip: " << (ok ? "identical" : "DIFFERENT") << endl;
+    }
+
+    const uint32_t CONNS = 6;
+    const size_t CUT = 30;
+
+    // A second worker restores the table mid-stream and sends exactly what the first would have.
+    {
+        Run reference {2, 4};
+        for (uint32_t c = 0; c < CONNS; c++)
+            stream_range(reference, c, 0, SIZE_MAX);
+        reference.simulator.run();
+
+        Run before {2, 4};
+        for (uint32_t c = 0; c < CONNS; c++)
+            stream_range(before, c, 0, CUT);
+        before.simulator.run();
+
+        const auto snapshot = before.worker.save_connections();
+
+        Run after {2, 4};
+        const size_t restored = after.worker.restore_connections(snapshot.data(), snapshot.size());
+        for (uint32_t c = 0; c < CONNS; c++)
+            stream_range(after, c, CUT, SIZE_MAX);
+        after.simulator.run();
+
+        auto joined = before.out;
+        joined.insert(joined.end(), after.out.begin(), after.out.end());
+
+        const bool same = joined == reference.out;
+        failures += restored != CONNS || !same;
+        cout << "handoff: " << restored << " connections, " << (snapshot.size() - sizeof(nfp::SnapshotHeader)) / CONNS
+             << " bytes each, output " << (same ? "identical" : "DIFFERENT") << endl;
+
+        // Damaged or mismatched snapshots are refused, and leave no half-restored connection.
+        auto damaged = snapshot;
+        damaged[damaged.size() / 2] ^= 1;
+
+        auto refused = [&](unsigned depth, function<SignalPipeline()> factory, const vector<unsigned char>& bytes) {
+            Run r {1, depth, factory};
+            try {
+                r.worker.restore_connections(bytes.data(), bytes.size());
+            } catch (const runtime_error& err) {
+                cout << "  refused: " << err.what() << endl;
+                return r.worker.size() == 0;
+            }
+            return false;
+        };
+
+        failures += !refused(4, filters, damaged);
+        failures += !refused(8, filters, snapshot);
+        failures += !refused(4, [] { SignalPipeline p; p.add_gain(2.0f); return p; }, snapshot);
+        failures += !refused(4, filters, vector<unsigned char>(snapshot.begin(), snapshot.begin() + 20));
+    }
+
+    // Buckets move between shards mid-stream without changing a single output sample.
+    {
+        const uint32_t MANY = 64;
+
+        Run reference {4, 4};
+        Run moved {4, 4};
+
+        for (uint32_t c = 0; c < MANY; c++) {
+            stream_range(reference, c, 0, SIZE_MAX);
+            stream_range(moved, c, 0, SIZE_MAX);
+        }
+
+        reference.simulator.run();
+
+        moved.simulator.run_until(INTERVAL * 20);
+        for (size_t b = 0; b < UDPWorker::BUCKETS; b++)
+            moved.worker.move_bucket(b, 0);
+        const auto piled = moved.worker.shard_sizes();
+
+        moved.simulator.run_until(INTERVAL * 40);
+        const size_t moves = moved.worker.rebalance();
+        const auto balanced = moved.worker.shard_sizes();
+        moved.simulator.run();
+
+        const auto [lo, hi] = minmax_element(balanced.begin(), balanced.end());
+        const bool same = moved.out == reference.out;
+        failures += piled[0] != MANY || *hi - *lo > 1 || !same;
+        cout << "rebalance: " << piled[0] << " on shard 0, " << moves << " buckets moved, now "
+             << balanced[0] << "/" << balanced[1] << "/" << balanced[2] << "/" << balanced[3]
+             << ", output " << (same ? "identical" : "DIFFERENT") << endl;
+    }
+
+    // Concurrent producers; the consumer sees each producer's messages in order.
+    {
+        const uint64_t PRODUCERS = 4, PER = 50000;
+        nfp::Mailbox<uint64_t> mailbox;
+        vector<thread> producers;
+
+        for (uint64_t p = 0; p < PRODUCERS; p++)
+            producers.emplace_back([&, p]() {
+                for (uint64_t i = 0; i < PER; i++)
+                    mailbox.push(p << 32 | i);
+            });
+
+        vector<uint64_t> next(PRODUCERS, 0);
+        uint64_t received = 0;
+        bool ordered = true;
+
+        while (received < PRODUCERS * PER)
+            received += mailbox.drain([&](uint64_t m) {
+                ordered = ordered && (m & 0xFFFFFFFF) == next[m >> 32]++;
+            });
+
+        for (auto & t : producers)
+            t.join();
+
+        failures += !ordered || !mailbox.empty();
+        cout << "mailbox: " << received << " messages, in order " << ordered << endl;
+    }
+
+    cout << "failures: " << failures << endl;
+
+    return failures;
+}
@@ -0,0 +1,243 @@
+#include <nfp/Dispatcher.hpp>
+#include <nfp/ShmRing.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace std::chrono;
+using nfp::Datagram;
+using nfp::Dispatcher;
+using nfp::RingSlot;
+using nfp::ShmRing;
+using nfp::UDPWorker;
+
+string ring(const string& name) {
+    return "/nfp-test20-" + to_string(getpid()) + "-" + name;
+}
+
+Datagram numbered(uint64_t seq) {
+    Datagram pkg {};
+    pkg.seq = seq;
+    pkg.out_port = 9000;
+    return pkg;
+}
+
+// Claims the ring in a child process; exit status 0 means the claim was refused.
+int claim_in_child(const string& name, bool release) {
+    const pid_t pid = fork();
+
+    if (pid == 0) {
+        try {
+            ShmRing r = ShmRing::attach(name);
+            r.claim();
+            if (release)
+                r.release();
+        } catch (const runtime_error&) {
+            _exit(0);
+        }
+        _exit(1);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WEXITSTATUS(status);
+}
+
+int main(int argc, char ** argv) {
+    int failures = 0;
+
+    // A producer thread races a consumer; nothing arrives twice or out of order.
+    {
+        const uint64_t TOTAL = 200000;
+        ShmRing producer = ShmRing::create(ring("order"), 256);
+        ShmRing consumer = ShmRing::attach(ring("order"));
+        consumer.claim();
+
+        thread t([&]() {
+            for (uint64_t i = 0; i < TOTAL; i++)
+                while (!producer.push(numbered(i), sizeof(Datagram), 1, 2))
+                    this_thread::yield();
+        });
+
+        uint64_t received = 0, next = 0;
+        bool ordered = true;
+
+        while (next < TOTAL)
+            received += consumer.consume(64, [&](const RingSlot& slot) {
+                ordered = ordered && slot.pkg.seq == next && slot.addr == 1 && slot.port == 2;
+                next = slot.pkg.seq + 1;
+                return true;
+            });
+
+        t.join();
+
+        failures += received != TOTAL || !ordered || consumer.size() != 0;
+        cout << "order: " << received << " datagrams, in order " << ordered << ", " << producer.dropped()
+             << " full pushes retried" << endl;
+    }
+
+    // A full ring drops at the producer and a consumer can stop mid-batch.
+    {
+        ShmRing producer = ShmRing::create(ring("full"), 64);
+        size_t accepted = 0;
+
+        for (uint64_t i = 0; i < 100; i++)
+            accepted += producer.push(numbered(i), sizeof(nfp::Datagram16), 0, 0);
+
+        ShmRing consumer = ShmRing::attach(ring("full"));
+        const size_t first = consumer.consume(64, [](const RingSlot& slot) { return slot.pkg.seq < 9; });
+        uint64_t next = 0;
+        const size_t rest = consumer.consume(64, [&](const RingSlot& slot) { next = max(next, slot.pkg.seq + 1); return true; });
+
+        failures += accepted != 64 || producer.dropped() != 36 || first != 10 || rest != 54 || next != 64;
+        cout << "full: " << accepted << " accepted, " << producer.dropped() << " dropped, consumed " << first << " + " << rest << endl;
+    }
+
+    // One live consumer at a time; a dead one's claim is taken over.
+    {
+        ShmRing producer = ShmRing::create(ring("claim"), 64);
+        ShmRing consumer = ShmRing::attach(ring("claim"));
+        consumer.claim();
+
+        const bool refused = claim_in_child(ring("claim"), true) == 0;
+        consumer.release();
+        const bool after_release = claim_in_child(ring("claim"), false) == 1;
+
+        // That child died holding the claim.
+        bool after_death = true;
+        try {
+            consumer.claim();
+        } catch (const runtime_error& err) {
+            cout << "  " << err.what() << endl;
+            after_death = false;
+        }
+
+        bool missing = false;
+        try {
+            ShmRing::attach(ring("none"));
+        } catch (const runtime_error& err) {
+            cout << "  " << err.what() << endl;
+            missing = true;
+        }
+
+        failures += !refused || !after_release || !after_death || !missing;
+        cout << "claims: refused while live " << refused << ", after release " << after_release
+             << ", after death " << after_death << endl;
+    }
+
+    // Backends split the sources evenly, and each backend's share still spreads over its shards.
+    {
+        const size_t BACKENDS = 4, SOURCES = 4096;
+        boost::asio::thread_pool pool {1};
+        UDPWorker worker {pool, 4};
+        worker.set_pipeline_factory([] { return nfp::SignalPipeline(); });
+
+        vector<size_t> per_backend(BACKENDS, 0);
+
+        for (uint32_t i = 0; i < SOURCES; i++) {
+            const udp::endpoint src {boost::asio::ip::address_v4(0x0A000000 + i / 16), static_cast<uint16_t>(5000 + i % 16)};
+            const size_t b = Dispatcher::backend_of(UDPWorker::conn_key(src), BACKENDS);
+            per_backend[b]++;
+
+            if (b == 0)
+                worker.handle_pkg(numbered(0), src);
+        }
+
+        const auto shards = worker.shard_sizes();
+        const auto [lo, hi] = minmax_element(per_backend.begin(), per_backend.end());
+        const auto [slo, shi] = minmax_element(shards.begin(), shards.end());
+
+        failures += *lo < SOURCES / BACKENDS * 8 / 10 || *hi > SOURCES / BACKENDS * 12 / 10;
+        failures += *slo < per_backend[0] / 4 * 7 / 10 || *shi > per_backend[0] / 4 * 13 / 10;
+        cout << "spread: backends " << per_backend[0] << "/" << per_backend[1] << "/" << per_backend[2] << "/" << per_backend[3]
+             << ", backend 0 shards " << shards[0] << "/" << shards[1] << "/" << shards[2] << "/" << shards[3] << endl;
+
+        worker.stop();
+        pool.join();
+    }
+
+    // Real datagrams through a dispatcher into two backends' worker tables.
+    {
+        const unsigned BACKENDS = 2, SOURCES = 8, PER = 50;
+        boost::asio::io_context io;
+
+        vector<ShmRing> rings;
+        for (unsigned b = 0; b < BACKENDS; b++)
+            rings.push_back(ShmRing::create(ring("dispatch-" + to_string(b)), 1024));
+
+        auto dispatcher = make_shared<Dispatcher>(io, 0, false, std::move(rings));
+        dispatcher->start();
+        thread io_thread([&]() { io.run(); });
+
+        boost::asio::thread_pool pool {1};
+        vector<shared_ptr<UDPWorker>> workers;
+        vector<unique_ptr<nfp::RingServer>> servers;
+        vector<thread> threads;
+
+        for (unsigned b = 0; b < BACKENDS; b++) {
+            workers.push_back(make_shared<UDPWorker>(pool, 2));
+            workers[b]->set_pipeline_factory([] { return nfp::SignalPipeline(); });
+
+            vector<ShmRing> mine;
+            mine.push_back(ShmRing::attach(ring("dispatch-" + to_string(b))));
+            servers.push_back(make_unique<nfp::RingServer>(std::move(mine)));
+            servers[b]->set_worker(workers[b]);
+            servers[b]->set_inline_dispatch(true);
+            threads.emplace_back([&, b]() { servers[b]->run(); });
+        }
+
+        const udp::endpoint target {boost::asio::ip::address_v4::loopback(), dispatcher->port()};
+        vector<size_t> expected(BACKENDS, 0);
+        vector<unique_ptr<udp::socket>> sources;
+
+        for (unsigned s = 0; s < SOURCES; s++) {
+            sources.push_back(make_unique<udp::socket>(io, udp::endpoint(boost::asio::ip::address_v4::loopback(), 0)));
+            expected[Dispatcher::backend_of(UDPWorker::conn_key(sources[s]->local_endpoint()), BACKENDS)]++;
+        }
+
+        for (uint64_t k = 0; k < PER; k++) {
+            for (auto & socket : sources) {
+                const Datagram pkg = numbered(k);
+                socket->send_to(boost::asio::buffer(&pkg, sizeof(pkg)), target);
+            }
+            this_thread::sleep_for(microseconds(200));
+        }
+
+        const auto deadline = steady_clock::now() + seconds(2);
+        auto delivered = [&]() { return workers[0]->size() == expected[0] && workers[1]->size() == expected[1]; };
+
+        while (!delivered() && steady_clock::now() < deadline)
+            this_thread::sleep_for(milliseconds(5));
+
+        const bool ok = delivered();
+
+        for (auto & server : servers)
+            server->close();
+        for (auto & t : threads)
+            t.join();
+
+        dispatcher->close();
+        io.stop();
+        io_thread.join();
+
+        for (auto & worker : workers)
+            worker->stop();
+        pool.join();
+
+        failures += !ok || dispatcher->dropped(0) + dispatcher->dropped(1) != 0;
+        cout << "dispatch: " << workers[0]->size() << "/" << expected[0] << " and " << workers[1]->size() << "/" << expected[1]
+             << " connections on backends 0 and 1" << endl;
+    }
+
+    cout << "failures: " << failures << endl;
+
+    return failures;
+}
@@ -0,0 +1,188 @@
+#include <nfp/UDPInterface.hpp>
+#include <nfp/OutputRing.hpp>
+#include <nfp/nfp_shm.h>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace std::chrono;
+using nfp::Datagram;
+using nfp::OutputRing;
+using nfp::UDPWorker;
+
+namespace layout = nfp::shm_layout;
+
+string ring(const string& name) {
+    return "test21-" + to_string(getpid()) + "-" + name;
+}
+
+// Counts what would have gone out over UDP.
+struct Counter : nfp::Outbox {
+    size_t blocks = 0;
+    void emit(boost::asio::const_buffer, uint16_t, uint16_t, const vector<nfp::Sink>&) override { blocks++; }
+};
+
+int main(int argc, char ** argv) {
+    int failures = 0;
+
+    // Several writer threads, one reader through the C API: every block arrives whole, each
+    // writer's in order, or is counted as lost.
+    {
+        const uint32_t WRITERS = 4, PER = 20000;
+        OutputRing out {ring("threads"), 1024, 512};
+        nfp_shm_reader * reader = nfp_shm_open(ring("threads").c_str());
+
+        vector<thread> writers;
+        for (uint32_t w = 0; w < WRITERS; w++)
+            writers.emplace_back([&, w]() {
+                vector<float> block(128);
+                for (uint32_t i = 0; i < PER; i++) {
+                    block.assign(128, static_cast<float>(i));
+                    block[0] = static_cast<float>(w);
+                    out.write(block.data(), 512, static_cast<uint16_t>(9000 + w), layout::FLOAT32);
+                }
+            });
+
+        vector<int64_t> last(WRITERS, -1);
+        uint64_t received = 0, torn = 0;
+        bool whole = true, ordered = true;
+        nfp_shm_block b;
+
+        while (received + torn + nfp_shm_lost(reader) < WRITERS * PER && nfp_shm_next(reader, &b, 1000) == 1) {
+            const float * x = static_cast<const float *>(b.data);
+            const uint32_t w = static_cast<uint32_t>(x[0]);
+            const float i = x[1];
+            bool same = b.bytes == 512 && b.format == NFP_SHM_FLOAT32 && w < WRITERS && b.port == 9000 + w;
+
+            for (size_t k = 2; k < 128 && same; k++)
+                same = x[k] == i;
+
+            // A torn read is only acceptable if the slot was overwritten meanwhile.
+            if (!nfp_shm_valid(reader, &b)) {
+                torn++;
+                continue;
+            }
+
+            whole = whole && same;
+            if (same) {
+                ordered = ordered && static_cast<int64_t>(i) > last[w];
+                last[w] = static_cast<int64_t>(i);
+            }
+            received++;
+        }
+
+        for (auto & t : writers)
+            t.join();
+
+        const uint64_t lost = nfp_shm_lost(reader);
+        failures += !whole || !ordered || received + torn + lost != WRITERS * PER;
+        cout << "threads: " << received << " blocks read, " << lost << " lost, " << torn << " overwritten while read, whole " << whole << ", in order " << ordered << endl;
+        nfp_shm_close(reader);
+    }
+
+    // A reader a whole ring behind loses the oldest blocks; oversized blocks are refused.
+    {
+        OutputRing out {ring("lap"), 4, 16};
+        nfp::OutputRingReader::Block b;
+        nfp::OutputRingReader reader {ring("lap")};
+
+        for (uint32_t i = 0; i < 10; i++)
+            out.write(&i, sizeof(i), 1, layout::FRAMES);
+
+        const bool refused = !out.write(vector<char>(17).data(), 17, 1, layout::FRAMES);
+
+        vector<uint32_t> got;
+        while (reader.next_block(b, 0) == 1)
+            got.push_back(*static_cast<const uint32_t *>(b.data));
+
+        failures += got != vector<uint32_t>{6, 7, 8, 9} || reader.lost() != 6 || !refused;
+        cout << "lap: " << got.size() << " read, " << reader.lost() << " lost" << endl;
+    }
+
+    // A reader in another process sleeps until the block is written, and sees the ring close.
+    {
+        const string name = ring("wake");
+        auto out = make_unique<OutputRing>(name, 16, 512);
+        const pid_t pid = fork();
+
+        if (pid == 0) {
+            nfp_shm_reader * reader = nfp_shm_open(name.c_str());
+            nfp_shm_block b;
+            const bool got = reader && nfp_shm_next(reader, &b, 5000) == 1 && *static_cast<const float *>(b.data) == 42.0f;
+            const bool closed = reader && nfp_shm_next(reader, &b, 5000) == -1;
+            _exit(got && closed ? 0 : 1);
+        }
+
+        this_thread::sleep_for(milliseconds(100));
+        const float x = 42.0f;
+        out->write(&x, sizeof(x), 0, layout::FLOAT32);
+        this_thread::sleep_for(milliseconds(50));
+        out.reset();
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        const bool missing = nfp_shm_open(name.c_str()) == nullptr;
+
+        failures += WEXITSTATUS(status) != 0 || !missing;
+        cout << "wake: child " << (WEXITSTATUS(status) == 0 ? "woke and saw the close" : "FAILED") << ", ring removed " << missing << endl;
+    }
+
+    // A route with a shared-memory output and no UDP: its filtered blocks only reach the ring.
+    {
+        nfp::SignalPipeline pipeline;
+        pipeline.add_gain(2.0f);
+
+        auto routes = make_shared<nfp::RouteTable>();
+        const uint16_t route = routes->add_route("default", std::move(pipeline), nfp::CONCEALMENT::ALL_ZERO);
+        routes->set_default_route(route);
+        routes->set_shm_output(route, nfp::ShmOutput{ring("route"), 64, false});
+
+        boost::asio::thread_pool pool {1};
+        UDPWorker worker {pool, 1};
+        worker.set_routes(routes);
+        worker.set_pipeline_factory([] { return nfp::SignalPipeline(); });
+        worker.set_warm_up(1);
+
+        nfp::OutputRingReader reader {ring("route")};
+        Counter udp;
+        const udp::endpoint src {boost::asio::ip::address_v4(0x0A000001), 4000};
+
+        for (uint64_t k = 0; k < 20; k++) {
+            Datagram pkg {};
+            pkg.seq = k;
+            pkg.out_port = 7000;
+            for (size_t i = 0; i < 128; i++)
+                pkg.data[i] = 0.25f * sinf(static_cast<float>(k * 128 + i) * 0.05f);
+            worker.handle_pkg(pkg, src, false, udp);
+        }
+
+        size_t blocks = 0;
+        double err = 0;
+        nfp::OutputRingReader::Block b;
+
+        while (reader.next_block(b, 0) == 1) {
+            const float * y = static_cast<const float *>(b.data);
+            for (size_t i = 0; i < 128; i++)
+                err = max(err, static_cast<double>(fabs(y[i] - 0.5f * sinf(static_cast<float>(b.seq * 128 + i) * 0.05f))));
+            err += b.port != 7000 || b.format != layout::FLOAT32;
+            blocks++;
+        }
+
+        worker.stop();
+        pool.join();
+
+        failures += blocks != 20 || err > 1e-6 || udp.blocks != 0;
+        cout << "route: " << blocks << " blocks in shared memory, " << udp.blocks << " over UDP, max error " << err << endl;
+    }
+
+    cout << "failures: " << failures << endl;
+
+    return failures;
+}
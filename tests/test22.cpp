@@ -0,0 +1,156 @@
+#include <nfp/Simulator.hpp>
+#include <nfp/ConfigsParse.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+using nfp::Datagram;
+using nfp::DigitalFilter;
+using nfp::SignalPipeline;
+using nfp::Simulator;
+using nfp::UDPWorker;
+
+namespace sim = nfp::sim;
+
+const float PI = 3.14159265f;
+
+SignalPipeline low_pass(int sections, uint8_t order) {
+    SignalPipeline p;
+    for (int i = 0; i < sections; i++)
+        p.add_digital_filter(DigitalFilter::low_pass_filter(2 * PI * 1000 / 8000, order));
+    return p;
+}
+
+float tone(uint64_t n) {
+    return 0.5f * sin(2 * PI * 200 * static_cast<float>(n % 8000) / 8000);
+}
+
+bool rejected(const string& text) {
+    try {
+        auto j = json::parse(text);
+        nfp::build_route_table(j, nfp::parse_conn_from(j));
+        return false;
+    } catch (const exception&) {
+        return true;
+    }
+}
+
+// Error the analysis gate gives for a configuration, empty if it passes.
+string analysis_error(const string& text) {
+    try {
+        auto j = json::parse(text);
+        auto conn = nfp::parse_conn_from(j);
+        nfp::validate_route_table(nfp::build_route_table(j, conn), nfp::parse_analysis_from(j), conn.samp_freq);
+        return "";
+    } catch (const exception& err) {
+        return err.what();
+    }
+}
+
+int main(int argc, char ** argv) {
+    int failures = 0;
+
+    // A route with two cheaper tiers: packets come in faster than the shard filters them, then at
+    // the real-time pace again.
+    {
+        auto routes = make_shared<nfp::RouteTable>();
+        const uint16_t route = routes->add_route("default", low_pass(6, 8), nfp::CONCEALMENT::REPEAT_LAST_GOOD);
+        routes->set_default_route(route);
+
+        vector<SignalPipeline> tiers;
+        tiers.push_back(low_pass(2, 4));
+        tiers.push_back(low_pass(1, 2));
+        routes->set_tiers(route, std::move(tiers));
+
+        boost::asio::thread_pool pool {1};
+        UDPWorker worker {pool, 1};
+        worker.set_routes(routes);
+        worker.set_tier_load(0.2f, 0.05f);
+
+        Simulator simulator {worker};
+        simulator.set_payload([](const udp::endpoint&, uint64_t seq, Datagram& pkg) {
+            for (size_t i = 0; i < 128; i++)
+                pkg.data[i] = tone(seq * 128 + i);
+        });
+
+        vector<float> y;
+        simulator.on_output([&](const Simulator::Output& o) {
+            const float * x = static_cast<const float *>(o.data.data());
+            y.insert(y.end(), x, x + o.data.size() / sizeof(float));
+        });
+
+        const udp::endpoint src {boost::asio::ip::make_address_v4("10.0.0.1"), 4000};
+        const size_t BURST = 30000;
+        simulator.stream(src, 7000, sim::sequence(0, BURST), microseconds(0), microseconds(10));
+        simulator.run();
+
+        const auto overloaded = worker.tier_stats();
+
+        simulator.stream(src, 7000, sim::sequence(BURST, 200), simulator.now() + milliseconds(16), milliseconds(16));
+        simulator.run();
+
+        const auto recovered = worker.tier_stats();
+
+        // Tier switches crossfade, so no step is much larger than the signal's own.
+        float max_step = 0, signal_step = 0;
+        for (size_t n = 5 * 128 + 1; n < y.size(); n++)
+            max_step = max(max_step, fabs(y[n] - y[n - 1]));
+        for (size_t n = 1; n < 8000; n++)
+            signal_step = max(signal_step, fabs(tone(n) - tone(n - 1)));
+
+        failures += overloaded.connections != vector<size_t>{0, 0, 1} || overloaded.downgrades != 2;
+        failures += recovered.connections != vector<size_t>{1, 0, 0} || recovered.upgrades != 2;
+        failures += max_step > 1.5f * signal_step;
+        cout << "overloaded: tier 2 " << overloaded.connections[2] << ", " << overloaded.downgrades << " downgrades; recovered: tier 0 "
+             << recovered.connections[0] << ", " << recovered.upgrades << " upgrades; largest step " << max_step
+             << " (signal " << signal_step << ")" << endl;
+
+        worker.stop();
+        pool.join();
+    }
+
+    // Tiers in the configuration: element lists or named pipelines, for float pipelines only.
+    {
+        const string base = R"({"udp-parms": {"server-port": 5000, "samp-freq": 8000, "client-addrv4": "127.0.0.1",
+                          "concealment-policy": "FADE_LAST_GOOD"},
+            "pipeline": [{"type": "low-pass", "cut-freq": 1000, "order": 8}],
+            "pipelines": {"lite": [{"type": "low-pass", "cut-freq": 1000, "order": 2}]},
+            "routes": [{"src-ports": [4000, 4999], "pipeline": "lite"}],)";
+
+        auto j = json::parse(base + R"("tiers": {"default": [[{"type": "low-pass", "cut-freq": 1000, "order": 4}], "lite"]}})");
+        auto table = nfp::build_route_table(j, nfp::parse_conn_from(j));
+        const bool built = table.at(0).tiers.size() == 2 && table.at(1).tiers.empty();
+
+        const bool unknown = rejected(base + R"("tiers": {"default": ["nothing"]}})");
+        const bool missing = rejected(base + R"("tiers": {"other": ["lite"]}})");
+        const bool too_many = rejected(base + R"("tiers": {"default": ["lite", "lite", "lite", "lite", "lite"]}})");
+        const bool spectrum = rejected(base + R"("tiers": {"default": [[{"type": "spectrum", "fft-size": 256}]]}})");
+        const bool valid = analysis_error(base + R"("tiers": {"default": ["lite"]}})").empty();
+        const bool unstable = analysis_error(base + R"("analysis": {"min-stability-margin": 0.05},
+            "tiers": {"default": [[{"type": "low-pass", "cut-freq": 1000, "order": 2, "Q": 200}]]}})").find("tier 1 is unstable") != string::npos;
+        const bool loud = analysis_error(base + R"("tiers": {"default": ["lite", [{"type": "gain", "gain": 1000}]]}})").find("tier 2 clips") != string::npos;
+
+        auto fixed = json::parse(base + R"("tiers": {"default": ["lite"]}})");
+        fixed["udp-parms"]["arithmetic"] = "fixed";
+        bool fixed_rejected = false;
+        try {
+            nfp::build_route_table(fixed, nfp::parse_conn_from(fixed));
+        } catch (const exception&) {
+            fixed_rejected = true;
+        }
+
+        failures += !built || !unknown || !missing || !too_many || !spectrum || !fixed_rejected || !valid || !unstable || !loud;
+        cout << "config: built " << built << ", rejected unknown " << unknown << ", missing " << missing
+             << ", too many " << too_many << ", spectrum " << spectrum << ", fixed point " << fixed_rejected
+             << ", analysis passes " << valid << ", rejected unstable tier " << unstable << ", loud tier " << loud << endl;
+    }
+
+    cout << "failures: " << failures << endl;
+
+    return failures;
+}
@@ -0,0 +1,174 @@
+#include <nfp/Kernels.hpp>
+#include <nfp/DigitalFilter.hpp>
+#include <nfp/ConfigsParse.hpp>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <math.h>
+#include <vector>
+
+using namespace std;
+using nfp::ISA;
+
+const float PI = 3.14159265f;
+
+static uint32_t seed = 0x2545F491u;
+
+static float noise() {
+    seed = seed * 1664525u + 1013904223u;
+    return static_cast<float>(static_cast<int32_t>(seed >> 8) - (1 << 23)) / (1 << 23);
+}
+
+// Random stable sections with poles up to radius 0.98.
+static nfp::DigitalFilter random_cascade(size_t sections) {
+    vector<nfp::BiquadFilter> fs;
+
+    for (size_t s = 0; s < sections; s++) {
+        const float r = 0.5f + 0.48f * fabs(noise()), theta = PI * fabs(noise());
+        fs.emplace_back(1.0f, -2 * r * cos(theta), r * r, 0.3f + noise() * 0.2f, noise(), noise() * 0.5f);
+    }
+
+    return nfp::DigitalFilter::from_sections(0.1f, fs);
+}
+
+template<typename T>
+static bool same(const vector<T> & a, const vector<T> & b) {
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+template<typename F>
+static double time_blocks(F f, int rounds) {
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        f();
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / rounds;
+}
+
+bool rejected(const string & text) {
+    try {
+        nfp::parse_threads_from(json::parse(text));
+        return false;
+    } catch (const exception &) {
+        return true;
+    }
+}
+
+int main(int argc, char ** argv) {
+    int failures = 0;
+    const ISA initial = nfp::kernels().isa;
+    const vector<size_t> blocks = {1, 7, 128, 1000, 5000};
+    const vector<size_t> lengths = {0, 1, 7, 33, 128, 1000};
+
+    cout << "active: " << nfp::isa_name(initial) << ", best: " << nfp::isa_name(nfp::best_isa()) << endl;
+
+    for (ISA isa : {ISA::SCALAR, ISA::SSE2, ISA::AVX2, ISA::AVX512, ISA::NEON}) {
+        if (!nfp::isa_supported(isa))
+            continue;
+
+        nfp::select_isa(isa);
+        const auto & k = nfp::kernels();
+        int mismatches = 0;
+
+        // Block cascades against the per-sample path, carrying state across uneven blocks.
+        for (size_t sections = 1; sections <= 20; sections++) {
+            auto reference = random_cascade(sections);
+            auto blockwise = reference, in_place = reference;
+
+            for (size_t n : blocks) {
+                vector<float> x(n), want(n), got(n), inplace(n);
+                for (auto & v : x)
+                    v = noise();
+
+                for (size_t i = 0; i < n; i++)
+                    want[i] = reference.eval(x[i]);
+
+                blockwise.processBlock(x.data(), got.data(), n);
+                inplace = x;
+                in_place.processBlock(inplace.data(), inplace.data(), n);
+
+                mismatches += !same(want, got) + !same(want, inplace);
+            }
+        }
+
+        for (size_t n : lengths) {
+            vector<float> x(n), y(n), from(n), want(n), got(n);
+            vector<int16_t> q(n), qwant(n), qgot(n);
+
+            for (size_t i = 0; i < n; i++) {
+                x[i] = 1.5f * noise();
+                from[i] = noise();
+                y[i] = noise();
+                q[i] = static_cast<int16_t>(i % 5 == 0 ? -32768 : 32767 * noise());
+            }
+
+            nfp::scalar_kernels.scale(x.data(), want.data(), n, 0.7f);
+            k.scale(x.data(), got.data(), n, 0.7f);
+            mismatches += !same(want, got);
+
+            nfp::scalar_kernels.fade(x.data(), want.data(), n, 0.75f, 0.25f / 128);
+            k.fade(x.data(), got.data(), n, 0.75f, 0.25f / 128);
+            mismatches += !same(want, got);
+
+            want = y;
+            got = y;
+            nfp::scalar_kernels.crossfade(from.data(), want.data(), n, 33, 0.6f);
+            k.crossfade(from.data(), got.data(), n, 33, 0.6f);
+            mismatches += !same(want, got);
+
+            nfp::scalar_kernels.q15_from_float(x.data(), qwant.data(), n);
+            k.q15_from_float(x.data(), qgot.data(), n);
+            mismatches += !same(qwant, qgot);
+
+            nfp::scalar_kernels.float_from_q15(q.data(), want.data(), n);
+            k.float_from_q15(q.data(), got.data(), n);
+            mismatches += !same(want, got);
+
+            qwant = q;
+            qgot = q;
+            nfp::scalar_kernels.scale_q15(qwant.data(), n, -32768);
+            k.scale_q15(qgot.data(), n, -32768);
+            mismatches += !same(qwant, qgot);
+        }
+
+        vector<float> block(128), out(128);
+        for (auto & v : block)
+            v = noise();
+
+        auto eight = random_cascade(8), sixteen = random_cascade(16);
+        double t8 = time_blocks([&] { eight.processBlock(block.data(), out.data(), block.size()); }, 20000);
+        double t16 = time_blocks([&] { sixteen.processBlock(block.data(), out.data(), block.size()); }, 20000);
+
+        cout << nfp::isa_name(isa) << ": " << mismatches << " mismatches, 8 sections " << t8 << " us/block, 16 sections "
+             << t16 << " us/block" << endl;
+        failures += mismatches;
+    }
+
+    nfp::select_isa(initial);
+
+    for (ISA isa : {ISA::SCALAR, ISA::SSE2, ISA::AVX2, ISA::AVX512, ISA::NEON}) {
+        failures += nfp::isa_from_name(nfp::isa_name(isa)) != isa;
+
+        if (!nfp::isa_supported(isa)) {
+            try {
+                nfp::select_isa(isa);
+                failures++;
+            } catch (const exception &) {}
+        }
+    }
+
+    failures += nfp::kernels().isa != initial;
+
+    try {
+        nfp::isa_from_name("mmx");
+        failures++;
+    } catch (const exception &) {}
+
+    failures += nfp::parse_threads_from(json::parse(R"({"threads": {"isa": "auto"}})")).has_isa;
+    failures += nfp::parse_threads_from(json::parse(R"({"threads": {"isa": "SSE2"}})")).isa != ISA::SSE2;
+    failures += !rejected(R"({"threads": {"isa": "mmx"}})");
+    failures += !rejected(R"({"threads": {"isa": 2}})");
+
+    cout << "failures: " << failures << endl;
+
+    return failures;
+}
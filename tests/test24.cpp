@@ -0,0 +1,34 @@
+#include <nfp/ConfigsParse.hpp>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// C++ reference for tools/test_nfp_py.py: the config's default pipeline over a raw float32 file,
+// in one block, as the server builds and runs it.
+int main(int argc, char ** argv) {
+    if (argc < 4) {
+        cerr << "Usage: test24_pyref config.json input.f32 output.f32" << endl;
+        return -1;
+    }
+
+    json j = nfp::load_config_file(argv[1]);
+    auto pipeline = nfp::build_pipeline(nfp::parse_pipeline_from(j), nfp::parse_conn_from(j).samp_freq);
+
+    ifstream in(argv[2], ios::binary);
+    vector<float> x;
+    float v;
+    while (in.read(reinterpret_cast<char *>(&v), sizeof(v)))
+        x.push_back(v);
+
+    vector<float> y(x.size());
+    pipeline.processBlock(x.data(), y.data(), x.size());
+
+    ofstream out(argv[3], ios::binary);
+    out.write(reinterpret_cast<const char *>(y.data()), static_cast<streamsize>(y.size() * sizeof(float)));
+
+    cout << x.size() << " samples" << endl;
+
+    return out ? 0 : 1;
+}
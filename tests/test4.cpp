@@ -31,7 +31,9 @@ int main(int argc, char ** argv) {
     unordered_map<CONCEALMENT, string> _t = {
         {CONCEALMENT::REPEAT_LAST_GOOD, "REPEAT_LAST_GOOD"},
         {CONCEALMENT::ALL_ZERO, "ALL_ZERO"},
-        {CONCEALMENT::FADE_LAST_GOOD, "FADE_LAST_GOOD"}
+        {CONCEALMENT::FADE_LAST_GOOD, "FADE_LAST_GOOD"},
+        {CONCEALMENT::LPC_EXTRAPOLATION, "LPC_EXTRAPOLATION"},
+        {CONCEALMENT::PITCH_REPETITION, "PITCH_REPETITION"}
     }; 
 
     cout << "Server Port: " << conn_info.server_port << endl;
@@ -39,5 +41,17 @@ int main(int argc, char ** argv) {
     cout << "Client Address (IPV4): " << conn_info.client_addrv4 << endl;
     cout << "Concealment Policy: " << _t[conn_info.policy] << endl;
 
+    for (const auto & r : parse_routes_from(j)) {
+        cout << endl << "route -> " << r.pipeline << endl;
+        cout << "source: " << boost::asio::ip::address_v4(r.src_net).to_string() << "/" << static_cast<int>(r.src_prefix) << endl;
+        cout << "source ports: " << r.src_port_min << "-" << r.src_port_max << endl;
+        cout << "output ports: " << r.out_port_min << "-" << r.out_port_max << endl;
+        if (r.has_policy)
+            cout << "Concealment Policy: " << _t[r.policy] << endl;
+    }
+
+    RouteTable table = build_route_table(j, conn_info);
+    cout << endl << "Compiled routes: " << table.size() << endl;
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include <nfp/ConnTable.hpp>
+#include <nfp/TimingWheel.hpp>
+#include <iostream>
+#include <vector>
+#include <random>
+
+using namespace std;
+using nfp::ConnTable;
+using nfp::ConnState;
+using nfp::TimingWheel;
+
+int main(int argc, char ** argv) {
+    ConnTable table {8};
+    mt19937_64 rng {42};
+
+    vector<uint64_t> keys;
+    for (int i = 0; i < 100000; i++)
+        keys.push_back((rng() & 0xFFFFFFFFull) << 16 | (rng() & 0xFFFF));
+
+    for (auto k : keys) {
+        bool inserted;
+        auto & conn = table.find_or_insert(k, inserted);
+        conn.expected_seq = k;
+    }
+
+    for (size_t i = 0; i < keys.size(); i += 2)
+        table.erase(keys[i]);
+
+    int errors = 0;
+
+    for (size_t i = 0; i < keys.size(); i++) {
+        ConnState * conn = table.find(keys[i]);
+
+        if ((i % 2 == 0) == (conn != nullptr) || (conn && conn->expected_seq != keys[i]))
+            errors++;
+    }
+
+    cout << "connections: " << table.size() << endl;
+    cout << "hot bytes per connection: " << table.hot_bytes_per_connection() << endl;
+    cout << "cold bytes per connection: " << table.cold_bytes_per_connection() << endl;
+    cout << "errors: " << errors << endl;
+
+    TimingWheel wheel;
+    vector<uint64_t> expiries;
+    int late = 0;
+
+    for (uint64_t id = 0; id < 10000; id++) {
+        expiries.push_back(1 + rng() % 300000);
+        wheel.schedule(id, expiries.back());
+    }
+
+    for (uint64_t tick = 1; tick <= 300000; tick += 1 + rng() % 50)
+        wheel.advance(tick, [&](uint64_t id) -> uint64_t {
+            if (expiries[id] > tick || expiries[id] + 50 < tick)
+                late++;
+            return 0;
+        });
+
+    wheel.advance(300000, [&](uint64_t) -> uint64_t { return 0; });
+
+    cout << "timers left: " << wheel.size() << endl;
+    cout << "misfired timers: " << late << endl;
+    errors += late + static_cast<int>(wheel.size());
+
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+#include <nfp/FilterAnalysis.hpp>
+#include <nfp/DigitalFilter.hpp>
+#include <nfp/SignalPipeline.hpp>
+#include <iostream>
+#include <complex>
+#include <math.h>
+#include <vector>
+
+using namespace std;
+
+const float PI = 3.14159;
+
+int main(int argc, char ** argv) {
+    float fs = 10000.0f;
+
+    nfp::SignalPipeline pipeline;
+    pipeline.add_gain(2);
+    pipeline.add_digital_filter(nfp::DigitalFilter::low_pass_filter(2 * PI * (1000 / fs), 8));
+    pipeline.add_digital_filter(nfp::DigitalFilter::notch_filter(2 * PI * (60 / fs), 1));
+
+    vector<float> cs = pipeline.coeffs();
+    nfp::FilterAnalysis analysis {cs, fs};
+
+    auto resp = analysis.response(512);
+    auto report = analysis.stability();
+
+    double max_err = 0;
+
+    for (size_t k = 1; k < resp.freqs.size(); k++) {
+        complex<double> z = exp(complex<double>(0, -2 * M_PI * resp.freqs[k] / fs));
+        complex<double> H = 1;
+
+        for (size_t i = 0; i < cs.size(); i += 6) {
+            complex<double> B = double(cs[i+3]) + double(cs[i+4]) * z + double(cs[i+5]) * z * z;
+            complex<double> A = double(cs[i]) + double(cs[i+1]) * z + double(cs[i+2]) * z * z;
+            H *= B / A;
+        }
+
+        double db = 20 * log10(abs(H));
+        if (db > -80)
+            max_err = max(max_err, fabs(db - resp.magnitude_db[k]));
+    }
+
+    cout << "stable: " << report.stable << endl;
+    cout << "stability margin: " << report.stability_margin << endl;
+    cout << "peak gain (dB): " << report.peak_gain_db << " at " << report.peak_freq << " Hz" << endl;
+
+    for (size_t i = 0; i < report.sections.size(); i++)
+        cout << "section " << i << ": pole radius " << report.sections[i].pole_radius
+             << ", peak " << report.sections[i].peak_gain_db << " dB"
+             << ", state peak " << report.sections[i].state_peak_gain_db << " dB" << endl;
+
+    cout << "max magnitude error (dB): " << max_err << endl;
+
+    return (report.stable && max_err < 0.05) ? 0 : 1;
+}
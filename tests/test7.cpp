@@ -0,0 +1,44 @@
+#include <nfp/FilterDesign.hpp>
+#include <nfp/FilterAnalysis.hpp>
+#include <iostream>
+#include <math.h>
+#include <vector>
+
+using namespace std;
+using namespace nfp;
+
+const float PI = 3.14159;
+
+int main(int argc, char ** argv) {
+    float fs = 10000.0f;
+    float f_pass = 1000.0f, f_stop = 1200.0f;
+    float ripple = 1.0f, attenuation = 60.0f;
+
+    FilterSpec spec {2 * PI * (f_pass / fs), 2 * PI * (f_stop / fs), ripple, attenuation};
+
+    int failures = 0;
+
+    for (auto family : {FilterFamily::BUTTERWORTH, FilterFamily::CHEBYSHEV1, FilterFamily::CHEBYSHEV2, FilterFamily::ELLIPTIC}) {
+        DigitalFilter filter = design_filter(spec, family);
+        auto resp = FilterAnalysis(filter.coeffs(), fs).response(8192);
+
+        float pass_min = 0, stop_max = -1000;
+
+        for (size_t k = 0; k < resp.freqs.size(); k++) {
+            if (resp.freqs[k] <= f_pass) pass_min = min(pass_min, resp.magnitude_db[k]);
+            if (resp.freqs[k] >= f_stop) stop_max = max(stop_max, resp.magnitude_db[k]);
+        }
+
+        bool ok = pass_min >= -ripple - 0.05f && stop_max <= -attenuation + 0.05f;
+        failures += !ok;
+
+        cout << family_name(family) << ": order " << minimum_order(family, spec)
+             << ", sections " << filter.coeffs().size() / 6
+             << ", passband min " << pass_min << " dB, stopband max " << stop_max << " dB"
+             << (ok ? "" : " [FAIL]") << endl;
+    }
+
+    cout << "cheapest: " << family_name(cheapest_family(spec)) << endl;
+
+    return failures;
+}
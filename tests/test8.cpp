@@ -0,0 +1,75 @@
+#include <nfp/StaticPipeline.hpp>
+#include <nfp/SignalPipeline.hpp>
+#include <nfp/DigitalFilter.hpp>
+#include <nfp/Kernels.hpp>
+#include <chrono>
+#include <iostream>
+#include <math.h>
+#include <vector>
+
+using namespace std;
+using namespace nfp;
+
+const float PI = 3.14159265f;
+
+using Static = static_pipeline<lpf<1000, 10000, 4>, gain<2>, notch<50, 10000, 1>>;
+
+static_assert(Static::n_sections == 4, "lpf<4> + gain + notch is four sections");
+static_assert(Static::coefficients()[0] > 1.0f, "coefficients are designed at compile time");
+
+template<typename F>
+static double time_blocks(F f, int rounds) {
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        f();
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / rounds;
+}
+
+int main(int argc, char ** argv) {
+    float fs = 10000.0f;
+
+    SignalPipeline dynamic;
+    dynamic.add_digital_filter(DigitalFilter::low_pass_filter(2 * PI * (1000 / fs), 4));
+    dynamic.add_gain(2);
+    dynamic.add_digital_filter(DigitalFilter::notch_filter(2 * PI * (50 / fs), 1));
+
+    Static fixed;
+
+    int failures = 0;
+    auto dcs = dynamic.coeffs(), scs = fixed.coeffs();
+
+    if (dcs.size() != scs.size()) {
+        cout << "coefficient count mismatch: " << dcs.size() << " vs " << scs.size() << endl;
+        return 1;
+    }
+
+    float max_coeff_err = 0;
+    for (size_t i = 0; i < dcs.size(); i++)
+        max_coeff_err = max(max_coeff_err, fabs(dcs[i] - scs[i]) / max(1.0f, fabs(dcs[i])));
+
+    vector<float> input(128), dyn_out, fix_out;
+    for (size_t i = 0; i < input.size(); i++)
+        input[i] = sin(2 * PI * 300 * i / fs) + 0.5f * sin(2 * PI * 50 * i / fs);
+
+    float max_out_err = 0;
+    for (int r = 0; r < 50; r++) {
+        dynamic.processBlock(input, dyn_out);
+        fixed.processBlock(input, fix_out);
+        for (size_t i = 0; i < input.size(); i++)
+            max_out_err = max(max_out_err, fabs(dyn_out[i] - fix_out[i]));
+    }
+
+    failures += max_coeff_err > 1e-5f;
+    failures += max_out_err > 1e-3f;
+
+    int rounds = 20000;
+    double t_dyn = time_blocks([&] { dynamic.processBlock(input, dyn_out); }, rounds);
+    double t_fix = time_blocks([&] { fixed.processBlock(input, fix_out); }, rounds);
+
+    cout << "max coefficient error: " << max_coeff_err << endl;
+    cout << "max output error: " << max_out_err << endl;
+    cout << "dynamic (" << isa_name(kernels().isa) << "): " << t_dyn << " us/block, static: " << t_fix << " us/block, speedup " << t_dyn / t_fix << "x" << endl;
+    cout << "footprint: dynamic " << dynamic.footprint() << " B, static " << fixed.footprint() << " B" << endl;
+
+    return failures;
+}
@@ -0,0 +1,55 @@
+#include <nfp/FixedPoint.hpp>
+#include <nfp/SignalPipeline.hpp>
+#include <nfp/DigitalFilter.hpp>
+#include <iostream>
+#include <math.h>
+#include <vector>
+
+using namespace std;
+
+const float PI = 3.14159265f;
+
+int main(int argc, char ** argv) {
+    float fs = 10000.0f;
+    int failures = 0;
+
+    vector<float> ramp(131);
+    for (size_t i = 0; i < ramp.size(); i++)
+        ramp[i] = -1.5f + 3.0f * i / (ramp.size() - 1);
+
+    vector<int16_t> q(ramp.size());
+    vector<float> back(ramp.size());
+    nfp::q15_from_float(ramp.data(), q.data(), ramp.size());
+    nfp::float_from_q15(q.data(), back.data(), q.size());
+
+    for (size_t i = 0; i < ramp.size(); i++) {
+        failures += q[i] != nfp::to_q15(ramp[i]);
+        failures += fabs(back[i] - max(-1.0f, min(32767 / 32768.0f, ramp[i]))) > 1.0f / 32768;
+    }
+
+    vector<int16_t> scaled = q;
+    nfp::scale_q15(scaled.data(), scaled.size(), 26214);
+    for (size_t i = 0; i < q.size(); i++)
+        failures += scaled[i] != static_cast<int16_t>((q[i] * 26214 + 0x4000) >> 15);
+
+    nfp::SignalPipeline pipeline;
+    pipeline.add_gain(0.5f);
+    pipeline.add_digital_filter(nfp::DigitalFilter::low_pass_filter(2 * PI * (1000 / fs), 8));
+    pipeline.add_digital_filter(nfp::DigitalFilter::notch_filter(2 * PI * (60 / fs), 1));
+
+    nfp::FixedPointFilter fixed {pipeline.coeffs()};
+    float snr = nfp::quantization_snr(pipeline.coeffs(), fixed);
+
+    vector<int16_t> loud(512, 32767), out(512);
+    fixed.clone().processBlock(loud.data(), out.data(), loud.size());
+
+    cout << "conversion failures: " << failures << endl;
+    cout << "sections: " << pipeline.coeffs().size() / 6 << " float, " << fixed.n_sections() << " fixed" << endl;
+    cout << "Q31 SNR: " << snr << " dB" << endl;
+    cout << "full-scale DC step settles at " << out.back() << endl;
+
+    failures += snr < 70.0f;
+    failures += abs(out.back() - 16384) > 64;
+
+    return failures;
+}
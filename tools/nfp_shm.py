@@ -0,0 +1,157 @@
+"""Reader for the shared-memory outputs of app ("shm-output" in the config), on the same host.
+
+Blocks come as numpy views into the ring, without copies; a view stays valid until the writer
+comes round again, which ShmReader.valid tells. The layout is the one in include/nfp/OutputRing.hpp.
+"""
+import ctypes
+import mmap
+import os
+import platform
+import time
+
+import numpy as np
+
+MAGIC = b"NFPOUT01"
+VERSION = 1
+HEADER_BYTES = 192
+SLOT_HEADER_BYTES = 16
+WRITING = 1 << 63
+FORMATS = {0: np.dtype("<f4"), 1: np.dtype("<i2"), 2: np.dtype("u1")}
+
+_FUTEX_WAIT = 0
+_FUTEX_WAKE_OP = 5
+_FUTEX_OP_ADD = 1
+_SYS_FUTEX = {"x86_64": 202, "aarch64": 98, "armv7l": 240, "i686": 240}.get(platform.machine())
+
+try:
+    _libc = ctypes.CDLL(None, use_errno=True) if _SYS_FUTEX and platform.system() == "Linux" else None
+except OSError:
+    _libc = None
+
+
+class _Timespec(ctypes.Structure):
+    _fields_ = [("tv_sec", ctypes.c_long), ("tv_nsec", ctypes.c_long)]
+
+
+class ShmReader:
+    def __init__(self, name):
+        fd = os.open(f"/dev/shm/nfp-out-{name}", os.O_RDWR)
+        try:
+            self._mm = mmap.mmap(fd, 0)
+        finally:
+            os.close(fd)
+
+        if self._mm[:8] != MAGIC:
+            raise ValueError(f"{name} is not an output ring")
+
+        version, self.slot_bytes, self.capacity, self._stride, _, self._writer = \
+            np.frombuffer(self._mm, dtype="<u4,<u4,<u8,<u4,<u4,<i8", count=1, offset=8)[0]
+
+        if version != VERSION:
+            raise ValueError(f"{name} is an output ring of version {version}")
+
+        self._write_seq = np.frombuffer(self._mm, dtype="<u8", count=1, offset=64)
+        self._closed = np.frombuffer(self._mm, dtype="<u4", count=1, offset=28)
+        self._wake = ctypes.c_uint32.from_buffer(self._mm, 128)
+        self._waiters = ctypes.c_uint32.from_buffer(self._mm, 132)
+        self._seqs = np.ndarray((self.capacity,), dtype="<u8", buffer=self._mm, offset=HEADER_BYTES, strides=(self._stride,))
+        self._meta = np.ndarray((self.capacity,), dtype="<u2,<u2,<u4", buffer=self._mm, offset=HEADER_BYTES + 8, strides=(self._stride,))
+
+        self.next = int(self._write_seq[0])
+        self.lost = 0
+
+    def close(self):
+        if self._mm is None:
+            return
+
+        self._seqs = self._meta = self._write_seq = self._closed = self._wake = self._waiters = None
+        try:
+            self._mm.close()
+        except BufferError:
+            # Blocks still held by the caller keep the mapping; it goes with the last of them.
+            pass
+        self._mm = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def _count_waiter(self, delta):
+        # The writer only wakes when it sees a waiter, and C++ readers count themselves with
+        # fetch_add, so the count must be atomic too. FUTEX_WAKE_OP adds to the second word
+        # atomically in the kernel; with no one to wake it does nothing else.
+        op = (_FUTEX_OP_ADD << 28) | ((delta & 0xFFF) << 12)
+        _libc.syscall(_SYS_FUTEX, ctypes.byref(self._wake), _FUTEX_WAKE_OP, 0, None, ctypes.byref(self._waiters), op)
+
+    def _wait(self, seen, timeout):
+        if _libc is None:
+            time.sleep(min(timeout, 0.001))
+            return
+
+        ts = _Timespec(int(timeout), int((timeout % 1) * 1e9))
+        self._count_waiter(1)
+        _libc.syscall(_SYS_FUTEX, ctypes.byref(self._wake), _FUTEX_WAIT, seen, ctypes.byref(ts), None, 0)
+        self._count_waiter(-1)
+
+    def read(self, timeout=None):
+        """Next block as (seq, port, array), None on timeout. Raises EOFError once the writer is gone."""
+        deadline = None if timeout is None else time.monotonic() + timeout
+
+        while True:
+            seen = self._wake.value
+            written = int(self._write_seq[0])
+
+            if written - self.next > self.capacity:
+                self.lost += written - self.capacity - self.next
+                self.next = written - self.capacity
+
+            if self.next < written:
+                i = self.next % self.capacity
+                seq = int(self._seqs[i])
+
+                if seq == self.next + 1:
+                    port, fmt, nbytes = self._meta[i]
+                    dtype = FORMATS[int(fmt)]
+                    data = np.frombuffer(self._mm, dtype=dtype, count=int(nbytes) // dtype.itemsize,
+                                         offset=HEADER_BYTES + i * self._stride + SLOT_HEADER_BYTES)
+                    self.next += 1
+                    return self.next - 1, int(port), data
+
+                if seq & ~WRITING > self.next + 1:
+                    self.lost += 1
+                    self.next += 1
+                    continue
+
+            if self._closed[0]:
+                raise EOFError("the writer closed the ring")
+
+            remaining = 0.1 if deadline is None else min(0.1, deadline - time.monotonic())
+
+            if remaining <= 0:
+                return None
+
+            try:
+                os.kill(int(self._writer), 0)
+            except ProcessLookupError:
+                raise EOFError("the writer is gone")
+            except PermissionError:
+                pass
+
+            self._wait(seen, remaining)
+
+    def valid(self, seq):
+        """Whether the block read as seq was not overwritten since."""
+        return int(self._seqs[seq % self.capacity]) == seq + 1
+
+
+if __name__ == "__main__":
+    import sys
+
+    with ShmReader(sys.argv[1]) as reader:
+        while True:
+            block = reader.read()
+            if block:
+                seq, port, data = block
+                print(seq, port, data.dtype, data.shape, float(np.sqrt(np.mean(np.square(data, dtype=np.float64)))))
@@ -6,6 +6,7 @@ from matplotlib.backends.backend_tkagg import FigureCanvasTkAgg
 import asyncio
 import numpy as np
 import struct
+from nfp_shm import ShmReader
 
 N_FLOATS = 128
 FLOAT_SIZE = 4
@@ -65,13 +66,21 @@ class SignalVizualizatorComponent(ttk.Frame):
 
     def update_data(self, configs):
         self._port = configs["port"]
-        self._figure.suptitle(f"Signal from port {self._port}", fontsize=6, y=0.90, fontweight="bold")
+        self._figure.suptitle(self._title(), fontsize=6, y=0.90, fontweight="bold")
 
         self._update_graphs_limits()
 
         loop = asyncio.get_event_loop()
         asyncio.run_coroutine_threadsafe(self._restart(loop), loop)
 
+    # "shm:<name>" reads a route's shared-memory output instead of a UDP port.
+    def _shm_name(self):
+        return self._port[4:] if isinstance(self._port, str) and self._port.startswith("shm:") else None
+
+    def _title(self):
+        name = self._shm_name()
+        return f"Signal from shared memory {name}" if name else f"Signal from port {self._port}"
+
     def _update_graphs_limits(self):
         self._ax1.set_ylim(self._ymin.get(), self._ymax.get())
         self._ax2.set_ylim(self._Ymin.get(), self._Ymax.get())
@@ -202,7 +211,7 @@ class SignalVizualizatorComponent(ttk.Frame):
 
         self._mpl_widget.pack(side="top", fill="x", expand=True)
 
-        self._figure.suptitle(f"Signal from port {self._port}", fontsize=6, y=0.90, fontweight="bold")
+        self._figure.suptitle(self._title(), fontsize=6, y=0.90, fontweight="bold")
         self._figure.tight_layout()
 
         self._line1 = self._ax1.plot([], [])[0]
@@ -245,7 +254,34 @@ class SignalVizualizatorComponent(ttk.Frame):
                 pass
         self.start(loop)
 
+    async def _run_shm(self, name):
+        with ShmReader(name) as reader:
+            input = []
+            while True:
+                block = reader.read(timeout=0)
+
+                if block is None:
+                    await asyncio.sleep(0.005)
+                    continue
+
+                seq, _, data = block
+
+                if data.dtype != np.float32 or data.size != N_FLOATS:
+                    continue
+
+                # Views into the ring; concatenate copies them, then checks none was overwritten.
+                input.append((seq, data))
+                if len(input) >= max(1, self._nsamples_var.get() // 128):
+                    y = np.concatenate([d for _, d in input])
+                    if all(reader.valid(s) for s, _ in input):
+                        self._update_plots(y)
+                    input.clear()
+
     async def _run(self):
+        if self._shm_name():
+            await self._run_shm(self._shm_name())
+            return
+
         self.queue = asyncio.Queue(10)
 
         self._transport, _ = await asyncio.get_event_loop().create_datagram_endpoint(
@@ -294,38 +330,21 @@ class TransferFuncComponent(ttk.Frame):
 
     def _build_transfer_func(self, coeffs_path):
 
-        self._func = []
-
-        coeffs = []
-
-        with open(coeffs_path) as f:
-            for l in f.readlines():
-                coeffs.append(float(l.rstrip()))
+        # A config is built by the server's own code (the nfp module); a --dump-coeffs file is read as is.
+        if coeffs_path.endswith(".json"):
+            import nfp
+            self._coeffs = nfp.build_pipeline(coeffs_path).coeffs().astype(np.float64)
+        else:
+            self._coeffs = np.loadtxt(coeffs_path, dtype=np.float64, ndmin=1).reshape(-1, 6)
 
-        qt_funcs = len(coeffs) // 6
-
-        c_exp = lambda e: lambda w: np.exp(1j*e*w)
+    def eval_func(self, w):
+        z = np.exp(-1j * w)
+        output = np.ones_like(z)
 
         eps = 1e-8
-        
-        for i in range(qt_funcs):
-            b0i = coeffs[6 * i + 3]
-            b1i = coeffs[6 * i + 4]
-            b2i = coeffs[6 * i + 5]
-            a0i = coeffs[6 * i + 0]
-            a1i = coeffs[6 * i + 1]
-            a2i = coeffs[6 * i + 2]
-
-            func_nom = lambda w : b0i + b1i * c_exp(-1)(w) + b2i * c_exp(-2)(w) + eps
-            func_den = lambda w : a0i + a1i * c_exp(-1)(w) + a2i * c_exp(-2)(w) + eps
-
-            self._func.append(lambda w: func_nom(w) / func_den(w))
-
-    def eval_func(self, w):
-        output = w
 
-        for f in self._func:
-            output = f(output)
+        for a0, a1, a2, b0, b1, b2 in self._coeffs:
+            output *= (b0 + b1 * z + b2 * z * z + eps) / (a0 + a1 * z + a2 * z * z + eps)
 
         return output 
 
@@ -500,7 +519,7 @@ class App(tk.Tk):
     def _coeff_dialog(self):
         coeffs_path = filedialog.askopenfilename(
             title="Load Coeffs file",
-            filetypes=[("Text File", "*.txt")]
+            filetypes=[("Text File", "*.txt"), ("Config (needs the nfp module)", "*.json")]
         )
 
         func_vizualizator = TransferFuncComponent(self._vizualizator_list.body, coeffs_path)
@@ -518,14 +537,14 @@ class App(tk.Tk):
         dialog.transient(self)
         dialog.grab_set()
 
-        input_port_var = tk.IntVar(
-            value=12345 if not cell else cell._port
+        input_port_var = tk.StringVar(
+            value="12345" if not cell else str(cell._port)
         )
 
         dialog_body = ttk.Frame(dialog, padding = (5, 5))
         dialog_body.pack(side="top", fill="both", anchor="center")
 
-        label_port = ttk.Label(dialog_body, text="Port:", style="Title.TLabel")
+        label_port = ttk.Label(dialog_body, text="Port (or shm:<name>):", style="Title.TLabel")
         label_port.pack(side="top", fill="x")
 
         inputnumber = ttk.Entry(dialog_body, textvariable=input_port_var, style="Input.TEntry")
@@ -534,8 +553,9 @@ class App(tk.Tk):
         hframe = ttk.Frame(dialog_body)
         hframe.pack(side="bottom", fill="both", expand=True , anchor="s", ipady = 5)
 
-        add_cmd = lambda : self._add_signal_visualization(dialog, {"port": input_port_var.get()})
-        edit_cmd = lambda : self._update_vizualizator(dialog, cell, {"port": input_port_var.get()})
+        source = lambda : int(input_port_var.get()) if input_port_var.get().strip().isdigit() else input_port_var.get().strip()
+        add_cmd = lambda : self._add_signal_visualization(dialog, {"port": source()})
+        edit_cmd = lambda : self._update_vizualizator(dialog, cell, {"port": source()})
 
         btn_add = ttk.Button(hframe, 
             text="ADD" if not cell else "UPDATE",